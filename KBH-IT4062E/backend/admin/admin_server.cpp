@@ -0,0 +1,378 @@
+#include "admin_server.h"
+#include "handoff.h"
+#include "log.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+bool AdminServer::start(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("admin", "Socket path too long").field("path", path);
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("admin", "socket failed").field("error", strerror(errno));
+        return false;
+    }
+
+    // Left behind by a previous run that did not shut down cleanly
+    unlink(path.c_str());
+
+    // Operators only: the socket is created 0600
+    mode_t old_mask = umask(0177);
+    int rc = bind(listen_fd_, (sockaddr*)&addr, sizeof(addr));
+    umask(old_mask);
+    if (rc < 0 || listen(listen_fd_, kMaxConnections) < 0) {
+        LOG_ERROR("admin", "bind failed").field("path", path).field("error", strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    path_ = path;
+    LOG_INFO("admin", "Admin socket ready").field("path", path);
+    thread_ = std::thread(&AdminServer::serve_loop, this);
+    return true;
+}
+
+void AdminServer::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (const auto& conn : connections_) {
+        close(conn.fd);
+    }
+    connections_.clear();
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(path_.c_str());
+    }
+}
+
+void AdminServer::serve_loop() {
+    std::vector<pollfd> fds;
+    while (!stop_) {
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& conn : connections_) {
+            fds.push_back({conn.fd, POLLIN, 0});
+        }
+
+        // Wake up now and then to notice stop()
+        if (poll(fds.data(), fds.size(), 200) <= 0) continue;
+
+        // Connections first: accepting may grow connections_
+        for (size_t i = fds.size() - 1; i >= 1; i--) {
+            if (fds[i].revents == 0) continue;
+            Connection& conn = connections_[i - 1];
+            if (!read_commands(conn)) {
+                close(conn.fd);
+                connections_.erase(connections_.begin() + (i - 1));
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) continue;
+            if ((int)connections_.size() >= kMaxConnections) {
+                close(fd);
+                continue;
+            }
+            // A reader that stops reading must not hold the thread
+            timeval timeout{2, 0};
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            connections_.push_back({fd, ""});
+        }
+    }
+}
+
+bool AdminServer::read_commands(Connection& conn) {
+    char buffer[512];
+    ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    conn.buffer.append(buffer, n);
+
+    size_t pos;
+    while ((pos = conn.buffer.find('\n')) != std::string::npos) {
+        std::string line = conn.buffer.substr(0, pos);
+        conn.buffer.erase(0, pos + 1);
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.pop_back();
+        }
+        if (line.empty()) continue;
+        if (line == "handoff" && listeners_) {
+            if (!hand_off(conn)) return false;
+            continue;
+        }
+
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        std::string reply = Json::writeString(builder, run(line)) + "\n";
+
+        size_t sent = 0;
+        while (sent < reply.size()) {
+            ssize_t w = send(conn.fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+            if (w <= 0) return false;
+            sent += w;
+        }
+    }
+    return conn.buffer.size() <= kMaxLineBytes;
+}
+
+bool AdminServer::hand_off(Connection& conn) {
+    std::vector<int> fds;
+    Json::Value reply;
+    reply["type"] = "handoff";
+    reply["listeners"] = Json::arrayValue;
+    std::vector<int> listeners = listeners_();
+    for (size_t i = 0; i < listeners.size(); i++) {
+        if (listeners[i] < 0) continue;
+        fds.push_back(listeners[i]);
+        reply["listeners"].append(i == 0 ? "game" : "metrics");
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    bool sent = false;
+    if (!listeners.empty() && listeners[0] >= 0) {
+        sent = send_with_fds(conn.fd, Json::writeString(builder, reply) + "\n", fds);
+    } else {
+        std::string line = "{\"type\":\"error\",\"code\":\"NOT_LISTENING\","
+                           "\"message\":\"No listening socket (already handed off or draining)\"}\n";
+        send(conn.fd, line.data(), line.size(), MSG_NOSIGNAL);
+    }
+    for (int fd : fds) {
+        close(fd);
+    }
+    if (!sent) return false;
+
+    // The socket path belongs to the new process from now on
+    LOG_INFO("admin", "Listening sockets handed off").field("count", (uint64_t)fds.size());
+    close(listen_fd_);
+    listen_fd_ = -1;
+    path_.clear();
+    listeners_ = nullptr;
+    released_();
+    return true;
+}
+
+static Json::Value error_reply(const std::string& code, const std::string& message) {
+    Json::Value err;
+    err["type"] = "error";
+    err["code"] = code;
+    err["message"] = message;
+    return err;
+}
+
+Json::Value AdminServer::run(const std::string& line) {
+    std::istringstream in(line);
+    std::string cmd, arg;
+    in >> cmd >> arg;
+
+    Json::Value reply;
+    if (cmd == "help") {
+        reply["type"] = "help";
+        for (const char* c : {"stats", "rooms", "room <code>", "clients", "db", "latency",
+                              "handoff", "help"}) {
+            reply["commands"].append(c);
+        }
+        return reply;
+    }
+    if (cmd == "db") {
+        reply = db();
+    } else if (cmd == "latency") {
+        reply = latency();
+    } else if (cmd == "stats" || cmd == "rooms" || cmd == "room" || cmd == "clients") {
+        std::shared_ptr<const AdminSnapshot> snap = snapshot_();
+        if (!snap) {
+            return error_reply("SNAPSHOT_TIMEOUT", "Server tick did not answer");
+        }
+        if (cmd == "stats") {
+            reply = stats(*snap);
+        } else if (cmd == "rooms") {
+            reply = rooms(*snap);
+        } else if (cmd == "clients") {
+            reply = clients(*snap);
+        } else {
+            if (arg.empty()) return error_reply("BAD_ARGUMENT", "Usage: room <code>");
+            reply = room(*snap, arg);
+            if (reply.isNull()) return error_reply("ROOM_NOT_FOUND", "No room " + arg);
+        }
+        reply["snapshot_ms"] = (Json::Int64)snap->taken_ms;
+    } else {
+        return error_reply("UNKNOWN_COMMAND", "Unknown command: " + cmd + " (try help)");
+    }
+    reply["type"] = cmd;
+    return reply;
+}
+
+Json::Value AdminServer::stats(const AdminSnapshot& snap) const {
+    Json::Value out;
+    int live = 0, parked = 0, seated = 0, spectators = 0, playing = 0;
+    for (const auto& client : snap.clients) {
+        (client.parked ? parked : live)++;
+    }
+    for (const auto& room : snap.rooms) {
+        seated += (int)room.players.size();
+        spectators += room.spectators;
+        if (room.game_started) playing++;
+    }
+    out["uptime_ms"] = (Json::Int64)snap.taken_ms;
+    out["clients"] = live;
+    out["parked_sessions"] = parked;
+    out["rooms"] = (Json::UInt64)snap.rooms.size();
+    out["rooms_playing"] = playing;
+    out["seated_players"] = seated;
+    out["spectators"] = spectators;
+    out["room_games"] = (Json::UInt64)snap.room_games;
+    out["training_games"] = (Json::UInt64)snap.training_games;
+    out["matchmaking_queued"] = (Json::UInt64)snap.matchmaking_queued;
+    out["tournament"]["phase"] = snap.tournament_phase;
+    out["tournament"]["round"] = snap.tournament_round;
+    out["tournament"]["entrants"] = (Json::UInt64)snap.tournament_entrants;
+    return out;
+}
+
+Json::Value AdminServer::rooms(const AdminSnapshot& snap) const {
+    std::vector<const AdminSnapshot::RoomInfo*> sorted;
+    for (const auto& room : snap.rooms) {
+        sorted.push_back(&room);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto* a, const auto* b) { return a->id < b->id; });
+
+    Json::Value out;
+    out["rooms"] = Json::arrayValue;
+    for (const auto* room : sorted) {
+        Json::Value r;
+        r["id"] = room->id;
+        r["mode"] = room->mode;
+        r["private"] = room->is_private;
+        r["started"] = room->game_started;
+        r["players"] = (Json::UInt64)room->players.size();
+        r["spectators"] = room->spectators;
+        out["rooms"].append(r);
+    }
+    return out;
+}
+
+Json::Value AdminServer::room(const AdminSnapshot& snap, const std::string& code) const {
+    std::string id = code;
+    std::transform(id.begin(), id.end(), id.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    for (const auto& room : snap.rooms) {
+        if (room.id != id) continue;
+        Json::Value out;
+        out["id"] = room.id;
+        out["mode"] = room.mode;
+        out["private"] = room.is_private;
+        out["started"] = room.game_started;
+        out["game_start_ms"] = (Json::Int64)room.game_start_ms;
+        out["duration_ms"] = room.duration_ms;
+        out["total_words"] = room.total_words;
+        out["host_slot"] = room.host_slot;
+        out["spectators"] = room.spectators;
+        out["players"] = Json::arrayValue;
+        for (const auto& player : room.players) {
+            Json::Value p;
+            p["slot"] = player.slot;
+            p["client_id"] = player.client_id;
+            p["display_name"] = player.display_name;
+            p["connected"] = player.connected;
+            p["ready"] = player.ready;
+            p["eliminated"] = player.eliminated;
+            p["word_idx"] = player.word_idx;
+            p["wpm"] = player.wpm;
+            out["players"].append(p);
+        }
+        return out;
+    }
+    return Json::Value();
+}
+
+Json::Value AdminServer::clients(const AdminSnapshot& snap) const {
+    Json::Value out;
+    out["clients"] = Json::arrayValue;
+    for (const auto& client : snap.clients) {
+        Json::Value c;
+        c["fd"] = client.fd;
+        c["client_id"] = client.client_id;
+        c["display_name"] = client.display_name;
+        c["username"] = client.username;
+        c["room"] = client.room;
+        c["spectating"] = client.spectating;
+        c["training"] = client.training;
+        c["parked"] = client.parked;
+        c["queued"] = client.queued;
+        c["tournament"] = client.tournament;
+        out["clients"].append(c);
+    }
+    return out;
+}
+
+// `call="authenticate"` -> authenticate
+static std::string label_value(const std::string& labels) {
+    size_t open = labels.find('"');
+    size_t close = labels.rfind('"');
+    if (open == std::string::npos || close <= open) return labels;
+    return labels.substr(open + 1, close - open - 1);
+}
+
+static Json::Value latency_json(const metrics::Histogram& histogram) {
+    metrics::Histogram::Snapshot snap = histogram.snapshot();
+    Json::Value out;
+    out["count"] = (Json::UInt64)snap.count;
+    out["p50_ms"] = snap.quantile_us(0.50) / 1000.0;
+    out["p99_ms"] = snap.quantile_us(0.99) / 1000.0;
+    out["mean_ms"] = snap.count ? (double)snap.sum_us / snap.count / 1000.0 : 0.0;
+    return out;
+}
+
+Json::Value AdminServer::db() const {
+    Json::Value out;
+    out["in_flight"] = (Json::Int64)registry_.gauge("kbh_db_calls_in_flight",
+        "Database calls in progress (PostgreSQL serves one at a time)").value();
+    out["calls"] = Json::objectValue;
+
+    std::vector<std::string> labels;
+    registry_.for_each_histogram([&](const std::string& name, const std::string& series,
+                                     const metrics::Histogram& histogram) {
+        if (name != "kbh_db_call_seconds") return;
+        out["calls"][label_value(series)] = latency_json(histogram);
+        labels.push_back(series);
+    });
+    // Outside for_each_histogram: the registry lock is not recursive
+    for (const auto& series : labels) {
+        out["calls"][label_value(series)]["errors"] = (Json::UInt64)registry_.counter(
+            "kbh_db_errors_total", "Database calls that failed", series).value();
+    }
+    return out;
+}
+
+Json::Value AdminServer::latency() const {
+    Json::Value out;
+    out["handlers"] = Json::objectValue;
+    registry_.for_each_histogram([&](const std::string& name, const std::string& series,
+                                     const metrics::Histogram& histogram) {
+        if (name != "kbh_handler_seconds") return;
+        Json::Value entry = latency_json(histogram);
+        if (entry["count"].asUInt64() > 0) {
+            out["handlers"][label_value(series)] = entry;
+        }
+    });
+    return out;
+}
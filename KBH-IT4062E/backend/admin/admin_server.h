@@ -0,0 +1,85 @@
+#ifndef ADMIN_SERVER_H
+#define ADMIN_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jsoncpp/json/json.h>
+#include "admin_snapshot.h"
+#include "../metrics/metrics.h"
+
+// Local introspection channel: a Unix domain socket (mode 0600) taking
+// one command per line and answering one JSON line each:
+//
+//   stats          counts, queue depths, tournament phase
+//   rooms          every room with its mode, state and head count
+//   room <code>    one room's seats, progress and spectators
+//   clients        every connection (and parked session)
+//   db             database calls in flight, latency and errors per call
+//   latency        handler latency per message type
+//   handoff        hot restart: listening sockets to the caller, then drain
+//   help
+//
+// Room and client views come from an AdminSnapshot the server's tick
+// takes for us; db and latency read the metrics registry. Neither locks
+// game state. All connections are served by one poll() thread.
+class AdminServer {
+public:
+    using SnapshotSource = std::function<std::shared_ptr<const AdminSnapshot>()>;
+    // Copies of the listening sockets (-1 = none), closed here once sent
+    using ListenerSource = std::function<std::vector<int>()>;
+
+    AdminServer(SnapshotSource snapshot, metrics::Registry& registry)
+        : snapshot_(std::move(snapshot)), registry_(registry) {}
+    ~AdminServer() { stop(); }
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // Replaces a stale socket file at path
+    bool start(const std::string& path);
+    void stop();
+
+    // Answer `handoff` with listeners() (game port first, then metrics)
+    // and call released() after they were sent
+    void enable_handoff(ListenerSource listeners, std::function<void()> released) {
+        listeners_ = std::move(listeners);
+        released_ = std::move(released);
+    }
+
+private:
+    struct Connection {
+        int fd;
+        std::string buffer;
+    };
+
+    void serve_loop();
+    bool read_commands(Connection& conn);  // false once the peer is gone
+    Json::Value run(const std::string& line);
+    bool hand_off(Connection& conn);
+
+    Json::Value stats(const AdminSnapshot& snap) const;
+    Json::Value rooms(const AdminSnapshot& snap) const;
+    Json::Value room(const AdminSnapshot& snap, const std::string& code) const;
+    Json::Value clients(const AdminSnapshot& snap) const;
+    Json::Value db() const;
+    Json::Value latency() const;
+
+    static constexpr int kMaxConnections = 8;
+    static constexpr size_t kMaxLineBytes = 1024;
+
+    SnapshotSource snapshot_;
+    metrics::Registry& registry_;
+    ListenerSource listeners_;
+    std::function<void()> released_;
+    std::string path_;
+    int listen_fd_ = -1;
+    std::vector<Connection> connections_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+#endif
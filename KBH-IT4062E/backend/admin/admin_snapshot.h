@@ -0,0 +1,63 @@
+#ifndef ADMIN_SNAPSHOT_H
+#define ADMIN_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Copy of the server's live state, taken by the tick in one pass under the
+// state lock and then only read (by admin connections), so it is
+// internally consistent and nobody else has to lock to look at it.
+struct AdminSnapshot {
+    struct Player {
+        int slot = 0;
+        int client_id = 0;
+        std::string display_name;
+        bool connected = true;     // false while the session is parked
+        bool ready = false;
+        bool eliminated = false;
+        int word_idx = 0;
+        double wpm = 0.0;
+    };
+
+    struct RoomInfo {
+        std::string id;
+        std::string mode;          // "" in the lobby, else arena / survival
+        bool is_private = false;
+        bool game_started = false;
+        int64_t game_start_ms = 0;
+        int duration_ms = 0;
+        int host_slot = -1;
+        int total_words = 0;
+        int spectators = 0;
+        std::vector<Player> players;
+    };
+
+    struct Client {
+        int fd = -1;               // placeholder (negative) when parked
+        int client_id = 0;
+        std::string display_name;
+        std::string username;      // empty for guests
+        std::string room;          // seat or spectated room, "" if none
+        bool spectating = false;
+        bool training = false;
+        bool parked = false;
+        bool queued = false;
+        bool tournament = false;
+    };
+
+    uint64_t seq = 0;              // request this snapshot answered
+    int64_t taken_ms = 0;          // server time (ms since start)
+
+    std::vector<RoomInfo> rooms;
+    std::vector<Client> clients;   // live first, then parked
+
+    size_t room_games = 0;
+    size_t training_games = 0;
+    size_t matchmaking_queued = 0;
+    std::string tournament_phase;
+    int tournament_round = 0;
+    size_t tournament_entrants = 0;
+};
+
+#endif
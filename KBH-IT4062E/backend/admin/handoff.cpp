@@ -0,0 +1,121 @@
+#include "handoff.h"
+#include "log.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <jsoncpp/json/json.h>
+
+static constexpr size_t kMaxFds = 4;
+
+bool send_with_fds(int sock, const std::string& line, const std::vector<int>& fds) {
+    if (fds.empty() || fds.size() > kMaxFds) return false;
+
+    iovec iov{const_cast<char*>(line.data()), line.size()};
+    char control[CMSG_SPACE(sizeof(int) * kMaxFds)] = {};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    // The reply line is short; the fds travel with its first byte
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == (ssize_t)line.size();
+}
+
+// Reads one reply line; fds that arrived with it are appended to `fds`
+static bool recv_with_fds(int sock, std::string& line, std::vector<int>& fds) {
+    char buffer[1024];
+    while (line.find('\n') == std::string::npos) {
+        iovec iov{buffer, sizeof(buffer)};
+        char control[CMSG_SPACE(sizeof(int) * kMaxFds)] = {};
+
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        if (n <= 0) return false;
+        line.append(buffer, n);
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; i++) {
+                int fd;
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                fds.push_back(fd);
+            }
+        }
+    }
+    line.erase(line.find('\n'));
+    return true;
+}
+
+bool take_over_listeners(const std::string& path, InheritedListeners& out) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("handoff", "No usable admin socket path").field("path", path);
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || connect(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("handoff", "Cannot reach the running server").field("path", path)
+            .field("error", strerror(errno));
+        if (sock >= 0) close(sock);
+        return false;
+    }
+
+    std::string reply;
+    std::vector<int> fds;
+    bool ok = send(sock, "handoff\n", 8, MSG_NOSIGNAL) == 8 && recv_with_fds(sock, reply, fds);
+    close(sock);
+
+    Json::Value msg;
+    Json::CharReaderBuilder builder;
+    std::string errs;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (ok) {
+        ok = reader->parse(reply.data(), reply.data() + reply.size(), &msg, &errs);
+    }
+
+    // Fds come in the order the reply names them
+    const Json::Value& names = msg["listeners"];
+    if (!ok || msg["type"].asString() != "handoff" || !names.isArray() || names.size() != fds.size()) {
+        LOG_ERROR("handoff", "Handoff refused").field("reply", reply);
+        for (int fd : fds) close(fd);
+        return false;
+    }
+    for (Json::ArrayIndex i = 0; i < names.size(); i++) {
+        if (names[i].asString() == "game") {
+            out.game = fds[i];
+        } else if (names[i].asString() == "metrics") {
+            out.metrics = fds[i];
+        } else {
+            close(fds[i]);
+        }
+    }
+    if (out.game < 0) {
+        LOG_ERROR("handoff", "No game listener in handoff");
+        if (out.metrics >= 0) close(out.metrics);
+        return false;
+    }
+
+    LOG_INFO("handoff", "Took over listening sockets").field("game_fd", out.game)
+        .field("metrics_fd", out.metrics);
+    return true;
+}
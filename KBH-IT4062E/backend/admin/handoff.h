@@ -0,0 +1,23 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <string>
+#include <vector>
+
+// Hot restart: the new process asks the running one, over the admin
+// socket, for its listening sockets. They arrive as SCM_RIGHTS ancillary
+// data, so the kernel accept queue carries over and no connection attempt
+// is refused in between; the old process then drains.
+
+struct InheritedListeners {
+    int game = -1;
+    int metrics = -1;   // -1 if the old process did not serve /metrics
+};
+
+// New process side: connect to the admin socket at path and send `handoff`
+bool take_over_listeners(const std::string& path, InheritedListeners& out);
+
+// One reply line with fds attached (old process side)
+bool send_with_fds(int sock, const std::string& line, const std::vector<int>& fds);
+
+#endif
@@ -0,0 +1,221 @@
+#include "keystroke_analytics.h"
+#include <chrono>
+#include "log.h"
+
+// Gaps longer than this are pauses, not typing latency
+static const int64_t kMaxLatencyMs = 2000;
+
+// -------------------------------------------
+// KeystrokeStats
+// -------------------------------------------
+void KeystrokeStats::record_hit(int key, float latency_ms) {
+    uint32_t n = ++key_samples[key];
+    key_mean_ms[key] += (latency_ms - key_mean_ms[key]) / n;
+}
+
+void KeystrokeStats::record_miss(int expected_key) {
+    key_errors[expected_key]++;
+}
+
+void KeystrokeStats::record_bigram(int first, int second, float latency_ms) {
+    uint32_t n = ++bigram_samples[first][second];
+    bigram_mean_ms[first][second] += (latency_ms - bigram_mean_ms[first][second]) / n;
+}
+
+static void merge_mean(uint32_t& n, float& mean, uint32_t other_n, float other_mean) {
+    if (other_n == 0) return;
+    uint32_t total = n + other_n;
+    mean = (mean * n + other_mean * other_n) / total;
+    n = total;
+}
+
+void KeystrokeStats::merge(const KeystrokeStats& other) {
+    for (int i = 0; i < kKeys; i++) {
+        merge_mean(key_samples[i], key_mean_ms[i], other.key_samples[i], other.key_mean_ms[i]);
+        key_errors[i] += other.key_errors[i];
+
+        for (int j = 0; j < kKeys; j++) {
+            merge_mean(bigram_samples[i][j], bigram_mean_ms[i][j],
+                       other.bigram_samples[i][j], other.bigram_mean_ms[i][j]);
+        }
+    }
+}
+
+bool KeystrokeStats::empty() const {
+    for (int i = 0; i < kKeys; i++) {
+        if (key_samples[i] || key_errors[i]) return false;
+    }
+    return true;
+}
+
+// -------------------------------------------
+// WordKeystrokeRecorder
+// -------------------------------------------
+void WordKeystrokeRecorder::start_word(KeystrokeStats* stats, std::string_view target_word) {
+    stats_ = stats;
+    target_ = target_word;
+    prev_key_ = -1;
+    prev_time_ms_ = -1;
+}
+
+void WordKeystrokeRecorder::on_char(char typed, size_t typed_pos, int64_t time_ms) {
+    if (!stats_) return;
+    std::string_view target = target_;
+    int key = KeystrokeStats::key_index(typed);
+    int expected = typed_pos < target.size() ? KeystrokeStats::key_index(target[typed_pos]) : -1;
+    bool correct = typed_pos < target.size() && typed == target[typed_pos];
+
+    if (correct && key >= 0) {
+        int64_t latency = prev_time_ms_ >= 0 ? time_ms - prev_time_ms_ : -1;
+        // First key of a word has no latency (the space before it is not sent)
+        if (latency > 0 && latency <= kMaxLatencyMs) {
+            stats_->record_hit(key, (float)latency);
+            if (prev_key_ >= 0) {
+                stats_->record_bigram(prev_key_, key, (float)latency);
+            }
+        }
+        prev_key_ = key;
+    } else {
+        if (!correct && expected >= 0) {
+            stats_->record_miss(expected);
+        }
+        prev_key_ = -1;
+    }
+
+    prev_time_ms_ = time_ms;
+}
+
+void WordKeystrokeRecorder::on_backspace(int64_t time_ms) {
+    prev_key_ = -1;
+    prev_time_ms_ = time_ms;
+}
+
+// -------------------------------------------
+// KeystrokeAnalytics
+// -------------------------------------------
+KeystrokeAnalytics::KeystrokeAnalytics(Database* db)
+    : db_(db)
+{
+    flush_thread_ = std::thread(&KeystrokeAnalytics::flush_loop, this);
+}
+
+KeystrokeAnalytics::~KeystrokeAnalytics() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (flush_thread_.joinable()) {
+        flush_thread_.join();
+    }
+    flush();
+}
+
+void KeystrokeAnalytics::submit(int64_t user_id, const KeystrokeStats& stats) {
+    if (user_id <= 0 || stats.empty()) return;
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_[user_id].merge(stats);
+        wake = pending_.size() >= kMaxPendingUsers;
+    }
+    if (wake) cv_.notify_all();
+}
+
+KeystrokeStats KeystrokeAnalytics::load(int64_t user_id) {
+    KeystrokeStats stats;
+
+    // Hold the flush lock so a batch is never counted twice (in DB and in flight)
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    if (db_) {
+        for (const auto& row : db_->get_keystroke_stats(user_id)) {
+            KeystrokeStats stored;
+            int a = row.key_seq.empty() ? -1 : KeystrokeStats::key_index(row.key_seq[0]);
+            if (a < 0) continue;
+
+            if (row.key_seq.size() == 1) {
+                stored.key_samples[a] = row.samples;
+                stored.key_mean_ms[a] = (float)row.mean_latency_ms;
+                stored.key_errors[a] = row.errors;
+            } else {
+                int b = KeystrokeStats::key_index(row.key_seq[1]);
+                if (b < 0) continue;
+                stored.bigram_samples[a][b] = row.samples;
+                stored.bigram_mean_ms[a][b] = (float)row.mean_latency_ms;
+            }
+            stats.merge(stored);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(user_id);
+    if (it != pending_.end()) {
+        stats.merge(it->second);
+    }
+    return stats;
+}
+
+void KeystrokeAnalytics::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    std::unordered_map<int64_t, KeystrokeStats> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(pending_);
+    }
+    if (batch.empty() || !db_) return;
+
+    std::vector<KeystrokeStatRow> rows;
+    for (const auto& kv : batch) {
+        auto user_rows = to_rows(kv.first, kv.second);
+        rows.insert(rows.end(), user_rows.begin(), user_rows.end());
+    }
+
+    if (!db_->save_keystroke_stats(rows)) {
+        // Put the batch back so it is retried on the next flush
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& kv : batch) {
+            pending_[kv.first].merge(kv.second);
+        }
+        return;
+    }
+
+    LOG_INFO("analytics", "Flushed keystroke stats").field("users", batch.size()).field("rows", rows.size());
+}
+
+void KeystrokeAnalytics::flush_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs), [this] {
+            return stop_ || pending_.size() >= kMaxPendingUsers;
+        });
+        if (stop_) break;
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+std::vector<KeystrokeStatRow> KeystrokeAnalytics::to_rows(int64_t user_id,
+                                                          const KeystrokeStats& stats) const {
+    std::vector<KeystrokeStatRow> rows;
+
+    for (int i = 0; i < KeystrokeStats::kKeys; i++) {
+        if (stats.key_samples[i] || stats.key_errors[i]) {
+            rows.push_back({user_id, std::string(1, char('a' + i)),
+                            (int)stats.key_samples[i], stats.key_mean_ms[i],
+                            (int)stats.key_errors[i]});
+        }
+        for (int j = 0; j < KeystrokeStats::kKeys; j++) {
+            if (stats.bigram_samples[i][j]) {
+                std::string seq{char('a' + i), char('a' + j)};
+                rows.push_back({user_id, seq, (int)stats.bigram_samples[i][j],
+                                stats.bigram_mean_ms[i][j], 0});
+            }
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,104 @@
+#ifndef KEYSTROKE_ANALYTICS_H
+#define KEYSTROKE_ANALYTICS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "../database/database.h"
+
+// Fixed-size per-player keystroke tables (letters a-z only).
+// Latencies are running means so the tables never grow.
+struct KeystrokeStats {
+    static constexpr int kKeys = 26;
+
+    uint32_t key_samples[kKeys] = {};
+    float key_mean_ms[kKeys] = {};
+    uint32_t key_errors[kKeys] = {};
+
+    uint32_t bigram_samples[kKeys][kKeys] = {};
+    float bigram_mean_ms[kKeys][kKeys] = {};
+
+    // Maps a character to its table index, -1 if not a letter
+    static int key_index(char c) {
+        if (c >= 'a' && c <= 'z') return c - 'a';
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        return -1;
+    }
+
+    void record_hit(int key, float latency_ms);
+    void record_miss(int expected_key);
+    void record_bigram(int first, int second, float latency_ms);
+
+    // Merge another table into this one (weighted means)
+    void merge(const KeystrokeStats& other);
+    bool empty() const;
+};
+
+// Feeds the keystrokes of one word into a KeystrokeStats table.
+// Called from the input loop, so every step is a couple of array updates.
+// Streaming input keeps one recorder per player and restarts it per word.
+class WordKeystrokeRecorder {
+public:
+    WordKeystrokeRecorder() = default;
+    WordKeystrokeRecorder(KeystrokeStats* stats, std::string_view target_word) {
+        start_word(stats, target_word);
+    }
+
+    // The text target_word views must stay alive until the next start_word
+    void start_word(KeystrokeStats* stats, std::string_view target_word);
+
+    // typed_pos = position of this char in the typed word (before appending)
+    void on_char(char typed, size_t typed_pos, int64_t time_ms);
+    void on_backspace(int64_t time_ms);
+
+private:
+    KeystrokeStats* stats_ = nullptr;
+    std::string_view target_;
+    int prev_key_ = -1;       // last correctly typed key (-1 = none / broken by error)
+    int64_t prev_time_ms_ = -1;
+};
+
+// Collects finished-game tables per user and persists them in batches
+// on a background thread, so the game threads never wait on the DB.
+class KeystrokeAnalytics {
+public:
+    explicit KeystrokeAnalytics(Database* db);
+    ~KeystrokeAnalytics();
+
+    KeystrokeAnalytics(const KeystrokeAnalytics&) = delete;
+    KeystrokeAnalytics& operator=(const KeystrokeAnalytics&) = delete;
+
+    // Queue a player's stats from a finished game (guests are ignored)
+    void submit(int64_t user_id, const KeystrokeStats& stats);
+
+    // Stored stats merged with anything still waiting to be flushed
+    KeystrokeStats load(int64_t user_id);
+
+    // Write all pending stats now (also called on shutdown)
+    void flush();
+
+private:
+    void flush_loop();
+    std::vector<KeystrokeStatRow> to_rows(int64_t user_id, const KeystrokeStats& stats) const;
+
+    Database* db_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unordered_map<int64_t, KeystrokeStats> pending_;
+    bool stop_ = false;
+    std::thread flush_thread_;
+
+    // Serializes flushes (background thread vs. explicit flush())
+    std::mutex flush_mutex_;
+
+    static constexpr int kFlushIntervalMs = 30000;
+    static constexpr size_t kMaxPendingUsers = 64;   // flush early past this
+};
+
+#endif
@@ -1,6 +1,6 @@
 #include "config.h"
+#include "log.h"
 #include <fstream>
-#include <iostream>
 #include <jsoncpp/json/json.h>  // Thư viện JsonCpp để xử lý JSON
 
 // Constructor: Đọc cấu hình từ file
@@ -17,7 +17,7 @@ Config::~Config() {
 void Config::load_config(const std::string& config_file) {
     std::ifstream config_stream(config_file, std::ifstream::binary);
     if (!config_stream.is_open()) {
-        std::cerr << "Failed to load config file: " << config_file << std::endl;
+        LOG_ERROR("config", "Failed to load config file").field("path", config_file);
         return;
     }
 
@@ -25,9 +25,9 @@ void Config::load_config(const std::string& config_file) {
     std::string errs;
     bool ok = Json::parseFromStream(builder, config_stream, &config_data_, &errs);
     if (!ok) {
-        std::cerr << "Failed to parse config file: " << config_file << "\n"
-                  << errs << std::endl;
+        LOG_ERROR("config", "Failed to parse config file").field("path", config_file).field("error", errs);
     }
+    loaded_ = ok && config_data_.isObject();
 }
 
 // Hàm lấy giá trị cấu hình từ JSON dưới dạng string
@@ -35,7 +35,7 @@ std::string Config::get_config_value(const std::string& key) {
     if (config_data_.isMember(key)) {
         return config_data_[key].asString();
     } else {
-        std::cerr << "Key not found: " << key << std::endl;
+        LOG_WARN("config", "Key not found").field("key", key);
         return "";
     }
 }
@@ -72,9 +72,41 @@ int Config::get_server_port() {
             try {
                 return std::stoi(v.asString());
             } catch (...) {
-                std::cerr << "Invalid server_port value, fallback 5000\n";
+                LOG_WARN("config", "Invalid server_port value, fallback 5000");
             }
         }
     }
     return 5000;
 }
+
+// Đọc giá trị số nguyên, mặc định default_value nếu thiếu hoặc không hợp lệ
+int Config::get_config_int(const std::string& key, int default_value) {
+    if (!config_data_.isMember(key)) {
+        return default_value;
+    }
+    const auto& v = config_data_[key];
+    if (v.isInt()) {
+        return v.asInt();
+    }
+    if (v.isString()) {
+        try {
+            return std::stoi(v.asString());
+        } catch (...) {
+            LOG_WARN("config", "Invalid value, using default").field("key", key).field("default", default_value);
+        }
+    }
+    return default_value;
+}
+
+// Đọc giá trị bool, mặc định default_value nếu thiếu hoặc không hợp lệ
+bool Config::get_config_bool(const std::string& key, bool default_value) {
+    if (!config_data_.isMember(key)) {
+        return default_value;
+    }
+    const auto& v = config_data_[key];
+    if (v.isBool()) {
+        return v.asBool();
+    }
+    LOG_WARN("config", "Invalid value, using default").field("key", key).field("default", default_value);
+    return default_value;
+}
@@ -26,11 +26,21 @@ public:
     // Lấy port server cho TCP (key "server_port", mặc định 5000 nếu thiếu)
     int get_server_port();
 
+    // Đọc giá trị số nguyên (số hoặc chuỗi), trả về default_value nếu thiếu
+    int get_config_int(const std::string& key, int default_value);
+
+    // Đọc giá trị true/false, trả về default_value nếu thiếu
+    bool get_config_bool(const std::string& key, bool default_value);
+
+    // false nếu file không mở được hoặc không phải JSON hợp lệ
+    bool is_loaded() const { return loaded_; }
+
 private:
     void load_config(const std::string& config_file);
 
     // Dữ liệu cấu hình (JsonCpp)
     Json::Value config_data_;
+    bool loaded_ = false;
 };
 
 #endif
@@ -0,0 +1,78 @@
+#include "config_watcher.h"
+#include "log.h"
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+ConfigWatcher::ConfigWatcher(const std::string& path, std::function<void()> on_change)
+    : on_change_(std::move(on_change)) {
+    size_t slash = path.rfind('/');
+    dir_ = slash == std::string::npos ? "." : path.substr(0, slash);
+    name_ = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool ConfigWatcher::start() {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0 ||
+        inotify_add_watch(inotify_fd_, dir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LOG_ERROR("config", "Cannot watch config directory").field("dir", dir_)
+            .field("error", strerror(errno));
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+
+    stop_ = false;
+    thread_ = std::thread(&ConfigWatcher::watch_loop, this);
+    LOG_INFO("config", "Watching config for changes").field("file", dir_ + "/" + name_);
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (inotify_fd_ >= 0) {
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+}
+
+bool ConfigWatcher::file_changed() {
+    alignas(inotify_event) char buffer[4096];
+    bool ours = false;
+    ssize_t n;
+    while ((n = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + n; ) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            if (event->len > 0 && name_ == event->name) ours = true;
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+    return ours;
+}
+
+void ConfigWatcher::watch_loop() {
+    using Clock = std::chrono::steady_clock;
+    bool pending = false;
+    Clock::time_point last_event;
+
+    while (!stop_) {
+        // Wake up now and then to notice stop()
+        pollfd pfd{inotify_fd_, POLLIN, 0};
+        int ready = poll(&pfd, 1, pending ? kSettleMs : 200);
+        if (ready > 0 && file_changed()) {
+            pending = true;
+            last_event = Clock::now();
+            continue;
+        }
+        if (pending && Clock::now() - last_event >= std::chrono::milliseconds(kSettleMs)) {
+            pending = false;
+            on_change_();
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Calls on_change() on its own thread whenever the file at path has been
+// rewritten (inotify). The directory is watched rather than the file, so
+// a new file renamed over it (how editors and deploy tools save) counts
+// too. A burst of events gives one call, once the file is quiet again.
+class ConfigWatcher {
+public:
+    ConfigWatcher(const std::string& path, std::function<void()> on_change);
+    ~ConfigWatcher() { stop(); }
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    bool start();
+    void stop();
+
+private:
+    void watch_loop();
+    bool file_changed();   // drains pending events; true if one was ours
+
+    static constexpr int kSettleMs = 100;
+
+    std::string dir_;
+    std::string name_;
+    std::function<void()> on_change_;
+    int inotify_fd_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+#endif
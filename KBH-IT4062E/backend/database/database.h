@@ -1,9 +1,10 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
-#include <pqxx/pqxx>
 
 struct LeaderboardEntry {
     int rank;
@@ -11,43 +12,55 @@ struct LeaderboardEntry {
     double wpm;
 };
 
+// One row of keystroke_stat: key_seq is "a" (single key) or "th" (bigram)
+struct KeystrokeStatRow {
+    int64_t user_id;
+    std::string key_seq;
+    int samples;
+    double mean_latency_ms;
+    int errors;
+};
+
+// Storage interface used by the server, rooms and analytics.
+// PgDatabase talks to PostgreSQL; MemoryDatabase keeps everything in
+// process for load tests. Implementations must be safe to call from
+// several threads at once.
 class Database {
 public:
-    // Constructor
-    Database(const std::string& db_conn_str);
-
-    // Destructor
-    ~Database();
+    virtual ~Database() = default;
 
     // Save score (future feature)
-    bool save_player_score(const std::string& player_name, int score);
+    virtual bool save_player_score(const std::string& player_name, int score) = 0;
 
     // Get leaderboard (future feature)
-    std::vector<std::string> get_leaderboard();
+    virtual std::vector<std::string> get_leaderboard() = 0;
 
     // Get random paragraph for Arena Mode
-    std::string get_random_paragraph(const std::string& language = "en");
+    virtual std::string get_random_paragraph(const std::string& language = "en") = 0;
     
     // Get paragraph_id by body text
-    int64_t get_paragraph_id(const std::string& paragraph_body);
+    virtual int64_t get_paragraph_id(const std::string& paragraph_body) = 0;
     
     // Save training result
-    bool save_training_result(int64_t user_id, const std::string& paragraph_body, 
-                              double wpm, double accuracy, 
-                              int duration_ms, int words_committed);
+    virtual bool save_training_result(int64_t user_id, const std::string& paragraph_body, 
+                                      double wpm, double accuracy, 
+                                      int duration_ms, int words_committed) = 0;
     
     // Authentication methods
-    std::pair<int64_t, std::string> authenticate(const std::string& username, const std::string& password);
-    int64_t create_user(const std::string& username, const std::string& password);
-    bool change_password(const std::string& username, const std::string& old_password, const std::string& new_password);
+    virtual std::pair<int64_t, std::string> authenticate(const std::string& username, const std::string& password) = 0;
+    virtual int64_t create_user(const std::string& username, const std::string& password) = 0;
+    virtual bool change_password(const std::string& username, const std::string& old_password, const std::string& new_password) = 0;
     
     // Leaderboard methods
-    std::vector<LeaderboardEntry> get_top_players(int limit = 8);
-    LeaderboardEntry get_user_rank(int64_t user_id);
-
-private:
-    pqxx::connection* conn_;
-    std::string db_conn_str_;
+    virtual std::vector<LeaderboardEntry> get_top_players(int limit = 8) = 0;
+    virtual LeaderboardEntry get_user_rank(int64_t user_id) = 0;
+    
+    // Mean WPM of the user's last 10 results, 0 if none (matchmaking)
+    virtual double get_recent_wpm(int64_t user_id) = 0;
+    
+    // Keystroke analytics (batched upsert, merges running means)
+    virtual bool save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) = 0;
+    virtual std::vector<KeystrokeStatRow> get_keystroke_stats(int64_t user_id) = 0;
 };
 
 #endif
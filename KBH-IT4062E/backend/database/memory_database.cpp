@@ -0,0 +1,273 @@
+#include "memory_database.h"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include "log.h"
+
+// Used when no corpus file is configured (first rows of the SQL seed)
+static const char* kBuiltinParagraphs[] = {
+    "silent rivers carry small dreams across open fields where tired travelers rest beside warm stones and listen to wind in tall grass until morning brings new plans and gentle courage for everyone who keeps trying today",
+    "the old lantern glows in a narrow room while friends trade stories about distant markets lost maps and lucky meals they laugh softly then breathe slowly and feel the night grow kind until sleep arrives softly",
+    "bright clouds drift above city rooftops as bicycles roll along quiet streets people share simple greetings and carry baskets of fruit they stop near parks watch birds and forget worries at home they breathe easy again",
+    "when winter fades the garden wakes with tender shoots and green leaves a child waters each corner patiently learning rhythm and care the soil responds with colors scents and steady joy before dinner they whisper thanks",
+    "a wandering musician plays soft chords under a bridge at dusk strangers pause for a moment then continue their paths the notes linger like warm tea and make cold air feel gentle for anyone waiting patiently",
+};
+
+// -------------------------------------------
+// Constructor
+// -------------------------------------------
+MemoryDatabase::MemoryDatabase(const std::string& corpus_path, int latency_ms, int jitter_ms)
+    : latency_ms_(latency_ms), jitter_ms_(jitter_ms), rng_(std::random_device{}())
+{
+    if (!corpus_path.empty()) {
+        std::ifstream in(corpus_path);
+        if (!in.is_open()) {
+            LOG_WARN("db", "Cannot open corpus, using built-in paragraphs").field("path", corpus_path);
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+                line.pop_back();
+            }
+            if (!line.empty()) corpus_.push_back(line);
+        }
+    }
+
+    if (corpus_.empty()) {
+        for (const char* p : kBuiltinParagraphs) {
+            corpus_.push_back(p);
+        }
+    }
+
+    for (size_t i = 0; i < corpus_.size(); i++) {
+        paragraph_ids_.emplace(corpus_[i], static_cast<int64_t>(i + 1));
+    }
+}
+
+void MemoryDatabase::simulate_latency() {
+    if (latency_ms_ <= 0 && jitter_ms_ <= 0) return;
+
+    int ms = latency_ms_;
+    if (jitter_ms_ > 0) {
+        ms += std::uniform_int_distribution<int>(0, jitter_ms_)(rng_);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// -------------------------------------------
+// Legacy score table
+// -------------------------------------------
+bool MemoryDatabase::save_player_score(const std::string& player_name, int score) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+    scores_.emplace_back(player_name, score);
+    return true;
+}
+
+std::vector<std::string> MemoryDatabase::get_leaderboard() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto sorted = scores_;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (sorted.size() > 50) sorted.resize(50);
+
+    std::vector<std::string> leaderboard;
+    for (const auto& s : sorted) {
+        leaderboard.push_back(s.first + ": " + std::to_string(s.second));
+    }
+    return leaderboard;
+}
+
+// -------------------------------------------
+// Paragraphs
+// -------------------------------------------
+std::string MemoryDatabase::get_random_paragraph(const std::string& language) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    // The corpus is English only
+    if (language != "en" || corpus_.empty()) {
+        return "No paragraph available.";
+    }
+    std::uniform_int_distribution<size_t> pick(0, corpus_.size() - 1);
+    return corpus_[pick(rng_)];
+}
+
+int64_t MemoryDatabase::get_paragraph_id(const std::string& paragraph_body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto it = paragraph_ids_.find(paragraph_body);
+    return it != paragraph_ids_.end() ? it->second : -1;
+}
+
+// -------------------------------------------
+// Results (append log)
+// -------------------------------------------
+bool MemoryDatabase::save_training_result(int64_t user_id, const std::string& paragraph_body,
+                                          double wpm, double accuracy,
+                                          int duration_ms, int words_committed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto it = paragraph_ids_.find(paragraph_body);
+    ResultRecord r;
+    r.user_id = user_id;
+    r.paragraph_id = it != paragraph_ids_.end() ? it->second : -1;
+    r.wpm = wpm;
+    r.accuracy = accuracy;
+    r.duration_ms = duration_ms;
+    r.words_committed = words_committed;
+    r.created_at = std::chrono::system_clock::now();
+    results_.push_back(r);
+    return true;
+}
+
+// -------------------------------------------
+// Users
+// -------------------------------------------
+std::pair<int64_t, std::string> MemoryDatabase::authenticate(const std::string& username, const std::string& password) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto it = users_.find(username);
+    if (it == users_.end() || it->second.password != password) {
+        return {-1, ""};
+    }
+    return {it->second.user_id, it->second.username};
+}
+
+int64_t MemoryDatabase::create_user(const std::string& username, const std::string& password) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    if (username.empty() || users_.count(username)) {
+        return -1;
+    }
+    UserRecord user{next_user_id_++, username, password};
+    users_.emplace(username, user);
+    usernames_.emplace(user.user_id, username);
+    return user.user_id;
+}
+
+bool MemoryDatabase::change_password(const std::string& username, const std::string& old_password, const std::string& new_password) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto it = users_.find(username);
+    if (it == users_.end() || it->second.password != old_password) {
+        return false;
+    }
+    it->second.password = new_password;
+    return true;
+}
+
+// -------------------------------------------
+// Leaderboard over the last 7 days
+// -------------------------------------------
+std::vector<LeaderboardEntry> MemoryDatabase::rank_recent_results(std::vector<int64_t>* user_ids) {
+    auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24 * 7);
+
+    std::unordered_map<int64_t, double> best;
+    for (const auto& r : results_) {
+        if (r.user_id < 0 || r.created_at < cutoff) continue;
+        auto it = best.find(r.user_id);
+        if (it == best.end() || r.wpm > it->second) {
+            best[r.user_id] = r.wpm;
+        }
+    }
+
+    std::vector<std::pair<int64_t, double>> sorted(best.begin(), best.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    std::vector<LeaderboardEntry> entries;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        LeaderboardEntry e;
+        // Ties share a rank, the next rank skips (SQL RANK())
+        e.rank = (i > 0 && sorted[i].second == sorted[i - 1].second)
+                     ? entries.back().rank : static_cast<int>(i + 1);
+        e.username = usernames_.count(sorted[i].first) ? usernames_[sorted[i].first] : "";
+        e.wpm = sorted[i].second;
+        entries.push_back(e);
+        if (user_ids) user_ids->push_back(sorted[i].first);
+    }
+    return entries;
+}
+
+std::vector<LeaderboardEntry> MemoryDatabase::get_top_players(int limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    auto entries = rank_recent_results(nullptr);
+    if (limit >= 0 && entries.size() > static_cast<size_t>(limit)) {
+        entries.resize(limit);
+    }
+    return entries;
+}
+
+LeaderboardEntry MemoryDatabase::get_user_rank(int64_t user_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    std::vector<int64_t> ids;
+    auto entries = rank_recent_results(&ids);
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (ids[i] == user_id) return entries[i];
+    }
+    return LeaderboardEntry{0, "", 0.0};  // rank=0 means not found
+}
+
+double MemoryDatabase::get_recent_wpm(int64_t user_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    double sum = 0.0;
+    int count = 0;
+    for (auto it = results_.rbegin(); it != results_.rend() && count < 10; ++it) {
+        if (it->user_id == user_id) {
+            sum += it->wpm;
+            count++;
+        }
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+// -------------------------------------------
+// Keystroke stats (same merge as the SQL upsert)
+// -------------------------------------------
+bool MemoryDatabase::save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    for (const auto& row : rows) {
+        auto key = std::make_pair(row.user_id, row.key_seq);
+        auto it = keystrokes_.find(key);
+        if (it == keystrokes_.end()) {
+            keystrokes_.emplace(key, row);
+            continue;
+        }
+        KeystrokeStatRow& cur = it->second;
+        int total = cur.samples + row.samples;
+        cur.mean_latency_ms = total == 0 ? 0.0
+            : (cur.mean_latency_ms * cur.samples + row.mean_latency_ms * row.samples) / total;
+        cur.samples = total;
+        cur.errors += row.errors;
+    }
+    return true;
+}
+
+std::vector<KeystrokeStatRow> MemoryDatabase::get_keystroke_stats(int64_t user_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    simulate_latency();
+
+    std::vector<KeystrokeStatRow> rows;
+    for (auto it = keystrokes_.lower_bound({user_id, ""});
+         it != keystrokes_.end() && it->first.first == user_id; ++it) {
+        rows.push_back(it->second);
+    }
+    return rows;
+}
@@ -0,0 +1,84 @@
+#ifndef MEMORY_DATABASE_H
+#define MEMORY_DATABASE_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "database.h"
+
+// In-process stand-in for PgDatabase, for load tests that should measure
+// the network and game loop rather than PostgreSQL. Nothing is persisted.
+//
+// Every call sleeps latency_ms (+ up to jitter_ms) while holding the lock,
+// which mimics the single serialized pqxx connection of PgDatabase.
+class MemoryDatabase : public Database {
+public:
+    // corpus_path: text file with one paragraph per line; empty or
+    // unreadable falls back to a few built-in paragraphs
+    MemoryDatabase(const std::string& corpus_path = "", int latency_ms = 0, int jitter_ms = 0);
+
+    bool save_player_score(const std::string& player_name, int score) override;
+    std::vector<std::string> get_leaderboard() override;
+
+    std::string get_random_paragraph(const std::string& language = "en") override;
+    int64_t get_paragraph_id(const std::string& paragraph_body) override;
+
+    bool save_training_result(int64_t user_id, const std::string& paragraph_body, 
+                              double wpm, double accuracy, 
+                              int duration_ms, int words_committed) override;
+    
+    std::pair<int64_t, std::string> authenticate(const std::string& username, const std::string& password) override;
+    int64_t create_user(const std::string& username, const std::string& password) override;
+    bool change_password(const std::string& username, const std::string& old_password, const std::string& new_password) override;
+    
+    std::vector<LeaderboardEntry> get_top_players(int limit = 8) override;
+    LeaderboardEntry get_user_rank(int64_t user_id) override;
+    double get_recent_wpm(int64_t user_id) override;
+    
+    bool save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) override;
+    std::vector<KeystrokeStatRow> get_keystroke_stats(int64_t user_id) override;
+
+    size_t paragraph_count() const { return corpus_.size(); }
+
+private:
+    struct UserRecord {
+        int64_t user_id;
+        std::string username;
+        std::string password;
+    };
+
+    struct ResultRecord {
+        int64_t user_id;
+        int64_t paragraph_id;   // -1 when the body is not in the corpus
+        double wpm;
+        double accuracy;
+        int duration_ms;
+        int words_committed;
+        std::chrono::system_clock::time_point created_at;
+    };
+
+    void simulate_latency();
+
+    // Best WPM per user over the last 7 days, ranked like RANK()
+    std::vector<LeaderboardEntry> rank_recent_results(std::vector<int64_t>* user_ids);
+
+    std::vector<std::string> corpus_;                        // paragraph_id = index + 1
+    std::unordered_map<std::string, int64_t> paragraph_ids_;
+    std::unordered_map<std::string, UserRecord> users_;      // by username
+    std::unordered_map<int64_t, std::string> usernames_;     // user_id -> username
+    std::vector<ResultRecord> results_;                      // append-only
+    std::vector<std::pair<std::string, int>> scores_;
+    std::map<std::pair<int64_t, std::string>, KeystrokeStatRow> keystrokes_;
+    int64_t next_user_id_ = 1;
+
+    int latency_ms_;
+    int jitter_ms_;
+    std::mt19937 rng_;
+    std::mutex mutex_;
+};
+
+#endif
@@ -1,24 +1,24 @@
-#include "database.h"
+#include "pg_database.h"
 #include <pqxx/pqxx>
-#include <iostream>
 #include <string>
+#include "log.h"
 
 // -------------------------------------------
 // Constructor
 // -------------------------------------------
-Database::Database(const std::string& db_conn_str)
+PgDatabase::PgDatabase(const std::string& db_conn_str)
     : conn_(nullptr), db_conn_str_(db_conn_str)
 {
     try {
         conn_ = new pqxx::connection(db_conn_str_);
 
         if (!conn_->is_open()) {
-            std::cerr << "Failed to open database." << std::endl;
+            LOG_ERROR("db", "Failed to open database");
             throw std::runtime_error("Database connection failed.");
         }
     }
     catch (const std::exception& e) {
-        std::cerr << "Database connection error: " << e.what() << std::endl;
+        LOG_ERROR("db", "Connection failed").field("error", e.what());
         throw;
     }
 }
@@ -26,7 +26,7 @@ Database::Database(const std::string& db_conn_str)
 // -------------------------------------------
 // Destructor
 // -------------------------------------------
-Database::~Database() {
+PgDatabase::~PgDatabase() {
     if (conn_ != nullptr) {
         delete conn_;
         conn_ = nullptr;
@@ -36,7 +36,8 @@ Database::~Database() {
 // -------------------------------------------
 // Save player score (optional)
 // -------------------------------------------
-bool Database::save_player_score(const std::string& player_name, int score) {
+bool PgDatabase::save_player_score(const std::string& player_name, int score) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
 
@@ -49,7 +50,7 @@ bool Database::save_player_score(const std::string& player_name, int score) {
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error inserting score: " << e.what() << std::endl;
+        LOG_ERROR("db", "save_player_score failed").field("error", e.what());
         return false;
     }
 }
@@ -57,9 +58,10 @@ bool Database::save_player_score(const std::string& player_name, int score) {
 // -------------------------------------------
 // Get leaderboard (optional)
 // -------------------------------------------
-std::vector<std::string> Database::get_leaderboard() {
+std::vector<std::string> PgDatabase::get_leaderboard() {
     std::vector<std::string> leaderboard;
 
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         pqxx::result r =
@@ -72,7 +74,7 @@ std::vector<std::string> Database::get_leaderboard() {
         }
     }
     catch (const std::exception& e) {
-        std::cerr << "Error fetching leaderboard: " << e.what() << std::endl;
+        LOG_ERROR("db", "get_leaderboard failed").field("error", e.what());
     }
 
     return leaderboard;
@@ -81,7 +83,8 @@ std::vector<std::string> Database::get_leaderboard() {
 // -------------------------------------------
 // NEW: Get a random paragraph from DB
 // -------------------------------------------
-std::string Database::get_random_paragraph(const std::string& language) {
+std::string PgDatabase::get_random_paragraph(const std::string& language) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
 
@@ -98,14 +101,15 @@ std::string Database::get_random_paragraph(const std::string& language) {
         return r[0][0].as<std::string>();
     }
     catch (const std::exception& e) {
-        std::cerr << "DB paragraph error: " << e.what() << std::endl;
+        LOG_ERROR("db", "get_random_paragraph failed").field("error", e.what());
         return "Error loading paragraph.";
     }
 }
 // -------------------------------------------
 // Authentication: kbh_authenticate
 // -------------------------------------------
-std::pair<int64_t, std::string> Database::authenticate(const std::string& username, const std::string& password) {
+std::pair<int64_t, std::string> PgDatabase::authenticate(const std::string& username, const std::string& password) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -126,7 +130,7 @@ std::pair<int64_t, std::string> Database::authenticate(const std::string& userna
         return {user_id, returned_username};
     }
     catch (const std::exception& e) {
-        std::cerr << "DB authenticate error: " << e.what() << std::endl;
+        LOG_ERROR("db", "authenticate failed").field("error", e.what());
         return {-1, ""};
     }
 }
@@ -134,7 +138,8 @@ std::pair<int64_t, std::string> Database::authenticate(const std::string& userna
 // -------------------------------------------
 // Create user: kbh_create_user
 // -------------------------------------------
-int64_t Database::create_user(const std::string& username, const std::string& password) {
+int64_t PgDatabase::create_user(const std::string& username, const std::string& password) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -154,7 +159,7 @@ int64_t Database::create_user(const std::string& username, const std::string& pa
         return user_id;
     }
     catch (const std::exception& e) {
-        std::cerr << "DB create_user error: " << e.what() << std::endl;
+        LOG_ERROR("db", "create_user failed").field("error", e.what());
         return -1;
     }
 }
@@ -162,7 +167,8 @@ int64_t Database::create_user(const std::string& username, const std::string& pa
 // -------------------------------------------
 // Change password: kbh_change_password
 // -------------------------------------------
-bool Database::change_password(const std::string& username, const std::string& old_password, const std::string& new_password) {
+bool PgDatabase::change_password(const std::string& username, const std::string& old_password, const std::string& new_password) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -182,7 +188,7 @@ bool Database::change_password(const std::string& username, const std::string& o
         return success;
     }
     catch (const std::exception& e) {
-        std::cerr << "DB change_password error: " << e.what() << std::endl;
+        LOG_ERROR("db", "change_password failed").field("error", e.what());
         return false;
     }
 }
@@ -190,7 +196,8 @@ bool Database::change_password(const std::string& username, const std::string& o
 // -------------------------------------------
 // Get paragraph_id by body text
 // -------------------------------------------
-int64_t Database::get_paragraph_id(const std::string& paragraph_body) {
+int64_t PgDatabase::get_paragraph_id(const std::string& paragraph_body) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -206,7 +213,7 @@ int64_t Database::get_paragraph_id(const std::string& paragraph_body) {
         return r[0][0].as<int64_t>();
     }
     catch (const std::exception& e) {
-        std::cerr << "DB get_paragraph_id error: " << e.what() << std::endl;
+        LOG_ERROR("db", "get_paragraph_id failed").field("error", e.what());
         return -1;
     }
 }
@@ -214,9 +221,10 @@ int64_t Database::get_paragraph_id(const std::string& paragraph_body) {
 // -------------------------------------------
 // Save training result
 // -------------------------------------------
-bool Database::save_training_result(int64_t user_id, const std::string& paragraph_body,
+bool PgDatabase::save_training_result(int64_t user_id, const std::string& paragraph_body,
                                      double wpm, double accuracy,
                                      int duration_ms, int words_committed) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -252,7 +260,7 @@ bool Database::save_training_result(int64_t user_id, const std::string& paragrap
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "DB save_training_result error: " << e.what() << std::endl;
+        LOG_ERROR("db", "save_training_result failed").field("error", e.what());
         return false;
     }
 }
@@ -260,9 +268,10 @@ bool Database::save_training_result(int64_t user_id, const std::string& paragrap
 // -------------------------------------------
 // Get top players in the last week
 // -------------------------------------------
-std::vector<LeaderboardEntry> Database::get_top_players(int limit) {
+std::vector<LeaderboardEntry> PgDatabase::get_top_players(int limit) {
     std::vector<LeaderboardEntry> entries;
     
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -297,7 +306,7 @@ std::vector<LeaderboardEntry> Database::get_top_players(int limit) {
         txn.commit();
     }
     catch (const std::exception& e) {
-        std::cerr << "DB get_top_players error: " << e.what() << std::endl;
+        LOG_ERROR("db", "get_top_players failed").field("error", e.what());
     }
     
     return entries;
@@ -306,9 +315,10 @@ std::vector<LeaderboardEntry> Database::get_top_players(int limit) {
 // -------------------------------------------
 // Get user rank in the last week
 // -------------------------------------------
-LeaderboardEntry Database::get_user_rank(int64_t user_id) {
+LeaderboardEntry PgDatabase::get_user_rank(int64_t user_id) {
     LeaderboardEntry entry{0, "", 0.0};  // rank=0 means not found
     
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     try {
         pqxx::work txn(*conn_);
         
@@ -341,8 +351,108 @@ LeaderboardEntry Database::get_user_rank(int64_t user_id) {
         txn.commit();
     }
     catch (const std::exception& e) {
-        std::cerr << "DB get_user_rank error: " << e.what() << std::endl;
+        LOG_ERROR("db", "get_user_rank failed").field("error", e.what());
     }
     
     return entry;
-}
\ No newline at end of file
+}
+
+// -------------------------------------------
+// Mean WPM of the last 10 results (matchmaking skill)
+// -------------------------------------------
+double PgDatabase::get_recent_wpm(int64_t user_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    try {
+        pqxx::work txn(*conn_);
+        
+        pqxx::result r = txn.exec_params(
+            "SELECT COALESCE(AVG(wpm), 0) FROM ( "
+            "  SELECT wpm FROM game_result "
+            "  WHERE user_id = $1 "
+            "  ORDER BY created_at DESC "
+            "  LIMIT 10 "
+            ") recent",
+            user_id
+        );
+        
+        if (r.empty()) {
+            return 0.0;
+        }
+        return r[0][0].as<double>();
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("db", "get_recent_wpm failed").field("error", e.what());
+        return 0.0;
+    }
+}
+
+// -------------------------------------------
+// Save a batch of keystroke stats in one statement
+// -------------------------------------------
+bool PgDatabase::save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) {
+    if (rows.empty()) return true;
+    
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    try {
+        pqxx::work txn(*conn_);
+        
+        std::string query =
+            "INSERT INTO keystroke_stat (user_id, key_seq, samples, mean_latency_ms, errors) VALUES ";
+        for (size_t i = 0; i < rows.size(); i++) {
+            const auto& row = rows[i];
+            if (i > 0) query += ", ";
+            query += "(" + std::to_string(row.user_id) + ", " + txn.quote(row.key_seq) + ", " +
+                     std::to_string(row.samples) + ", " + std::to_string(row.mean_latency_ms) + ", " +
+                     std::to_string(row.errors) + ")";
+        }
+        query +=
+            " ON CONFLICT (user_id, key_seq) DO UPDATE SET "
+            "  mean_latency_ms = CASE WHEN keystroke_stat.samples + EXCLUDED.samples = 0 THEN 0 "
+            "    ELSE (keystroke_stat.mean_latency_ms * keystroke_stat.samples "
+            "          + EXCLUDED.mean_latency_ms * EXCLUDED.samples) "
+            "         / (keystroke_stat.samples + EXCLUDED.samples) END, "
+            "  samples = keystroke_stat.samples + EXCLUDED.samples, "
+            "  errors = keystroke_stat.errors + EXCLUDED.errors;";
+        
+        txn.exec(query);
+        txn.commit();
+        return true;
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("db", "save_keystroke_stats failed").field("error", e.what());
+        return false;
+    }
+}
+
+// -------------------------------------------
+// Get stored keystroke stats for one user
+// -------------------------------------------
+std::vector<KeystrokeStatRow> PgDatabase::get_keystroke_stats(int64_t user_id) {
+    std::vector<KeystrokeStatRow> rows;
+    
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    try {
+        pqxx::work txn(*conn_);
+        
+        pqxx::result r = txn.exec_params(
+            "SELECT key_seq, samples, mean_latency_ms, errors "
+            "FROM keystroke_stat WHERE user_id = $1",
+            user_id
+        );
+        
+        for (const auto& row : r) {
+            KeystrokeStatRow entry;
+            entry.user_id = user_id;
+            entry.key_seq = row["key_seq"].as<std::string>();
+            entry.samples = row["samples"].as<int>();
+            entry.mean_latency_ms = row["mean_latency_ms"].as<double>();
+            entry.errors = row["errors"].as<int>();
+            rows.push_back(entry);
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("db", "get_keystroke_stats failed").field("error", e.what());
+    }
+    
+    return rows;
+}
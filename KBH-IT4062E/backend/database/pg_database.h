@@ -0,0 +1,49 @@
+#ifndef PG_DATABASE_H
+#define PG_DATABASE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <pqxx/pqxx>
+#include "database.h"
+
+// PostgreSQL storage (schema in database/New_DB.sql)
+class PgDatabase : public Database {
+public:
+    // Constructor
+    PgDatabase(const std::string& db_conn_str);
+
+    // Destructor
+    ~PgDatabase() override;
+
+    bool save_player_score(const std::string& player_name, int score) override;
+    std::vector<std::string> get_leaderboard() override;
+
+    std::string get_random_paragraph(const std::string& language = "en") override;
+    int64_t get_paragraph_id(const std::string& paragraph_body) override;
+
+    bool save_training_result(int64_t user_id, const std::string& paragraph_body, 
+                              double wpm, double accuracy, 
+                              int duration_ms, int words_committed) override;
+    
+    std::pair<int64_t, std::string> authenticate(const std::string& username, const std::string& password) override;
+    int64_t create_user(const std::string& username, const std::string& password) override;
+    bool change_password(const std::string& username, const std::string& old_password, const std::string& new_password) override;
+    
+    std::vector<LeaderboardEntry> get_top_players(int limit = 8) override;
+    LeaderboardEntry get_user_rank(int64_t user_id) override;
+    double get_recent_wpm(int64_t user_id) override;
+    
+    bool save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) override;
+    std::vector<KeystrokeStatRow> get_keystroke_stats(int64_t user_id) override;
+
+private:
+    pqxx::connection* conn_;
+    std::string db_conn_str_;
+    
+    // pqxx::connection is not thread-safe; client threads and the
+    // analytics flusher share it (recursive: methods call each other)
+    std::recursive_mutex mutex_;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "timed_database.h"
+
+namespace {
+
+// Times one call and counts it as in flight meanwhile
+class CallTimer {
+public:
+    CallTimer(metrics::Histogram& latency, metrics::Gauge& in_flight)
+        : timer_(latency), in_flight_(in_flight) {
+        in_flight_.add(1);
+    }
+    ~CallTimer() { in_flight_.add(-1); }
+
+private:
+    metrics::ScopedTimer timer_;
+    metrics::Gauge& in_flight_;
+};
+
+} // namespace
+
+TimedDatabase::TimedDatabase(Database* inner) : inner_(inner) {
+    static const char* kNames[kCallCount] = {
+        "save_player_score", "get_leaderboard", "get_random_paragraph", "get_paragraph_id",
+        "save_training_result", "authenticate", "create_user", "change_password",
+        "get_top_players", "get_user_rank", "get_recent_wpm", "save_keystroke_stats",
+        "get_keystroke_stats"
+    };
+
+    auto& registry = metrics::Registry::global();
+    in_flight_ = &registry.gauge("kbh_db_calls_in_flight",
+        "Database calls in progress (PostgreSQL serves one at a time)");
+    for (int i = 0; i < kCallCount; i++) {
+        std::string labels = std::string("call=\"") + kNames[i] + "\"";
+        calls_[i].latency = &registry.histogram("kbh_db_call_seconds", "Database call latency", labels);
+        calls_[i].errors = &registry.counter("kbh_db_errors_total", "Database calls that failed", labels);
+    }
+}
+
+bool TimedDatabase::save_player_score(const std::string& player_name, int score) {
+    CallTimer timer(*calls_[kSaveScore].latency, *in_flight_);
+    bool ok = inner_->save_player_score(player_name, score);
+    if (!ok) calls_[kSaveScore].errors->inc();
+    return ok;
+}
+
+std::vector<std::string> TimedDatabase::get_leaderboard() {
+    CallTimer timer(*calls_[kLeaderboard].latency, *in_flight_);
+    return inner_->get_leaderboard();
+}
+
+std::string TimedDatabase::get_random_paragraph(const std::string& language) {
+    CallTimer timer(*calls_[kRandomParagraph].latency, *in_flight_);
+    std::string paragraph = inner_->get_random_paragraph(language);
+    if (paragraph.empty()) calls_[kRandomParagraph].errors->inc();
+    return paragraph;
+}
+
+int64_t TimedDatabase::get_paragraph_id(const std::string& paragraph_body) {
+    CallTimer timer(*calls_[kParagraphId].latency, *in_flight_);
+    return inner_->get_paragraph_id(paragraph_body);
+}
+
+bool TimedDatabase::save_training_result(int64_t user_id, const std::string& paragraph_body,
+                                         double wpm, double accuracy,
+                                         int duration_ms, int words_committed) {
+    CallTimer timer(*calls_[kSaveTraining].latency, *in_flight_);
+    bool ok = inner_->save_training_result(user_id, paragraph_body, wpm, accuracy,
+                                           duration_ms, words_committed);
+    if (!ok) calls_[kSaveTraining].errors->inc();
+    return ok;
+}
+
+std::pair<int64_t, std::string> TimedDatabase::authenticate(const std::string& username, const std::string& password) {
+    // A wrong password is an answer, not an error
+    CallTimer timer(*calls_[kAuthenticate].latency, *in_flight_);
+    return inner_->authenticate(username, password);
+}
+
+int64_t TimedDatabase::create_user(const std::string& username, const std::string& password) {
+    CallTimer timer(*calls_[kCreateUser].latency, *in_flight_);
+    return inner_->create_user(username, password);
+}
+
+bool TimedDatabase::change_password(const std::string& username, const std::string& old_password, const std::string& new_password) {
+    CallTimer timer(*calls_[kChangePassword].latency, *in_flight_);
+    return inner_->change_password(username, old_password, new_password);
+}
+
+std::vector<LeaderboardEntry> TimedDatabase::get_top_players(int limit) {
+    CallTimer timer(*calls_[kTopPlayers].latency, *in_flight_);
+    return inner_->get_top_players(limit);
+}
+
+LeaderboardEntry TimedDatabase::get_user_rank(int64_t user_id) {
+    CallTimer timer(*calls_[kUserRank].latency, *in_flight_);
+    return inner_->get_user_rank(user_id);
+}
+
+double TimedDatabase::get_recent_wpm(int64_t user_id) {
+    CallTimer timer(*calls_[kRecentWpm].latency, *in_flight_);
+    return inner_->get_recent_wpm(user_id);
+}
+
+bool TimedDatabase::save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) {
+    CallTimer timer(*calls_[kSaveKeystrokes].latency, *in_flight_);
+    bool ok = inner_->save_keystroke_stats(rows);
+    if (!ok) calls_[kSaveKeystrokes].errors->inc();
+    return ok;
+}
+
+std::vector<KeystrokeStatRow> TimedDatabase::get_keystroke_stats(int64_t user_id) {
+    CallTimer timer(*calls_[kGetKeystrokes].latency, *in_flight_);
+    return inner_->get_keystroke_stats(user_id);
+}
@@ -0,0 +1,53 @@
+#ifndef TIMED_DATABASE_H
+#define TIMED_DATABASE_H
+
+#include "database.h"
+#include "../metrics/metrics.h"
+
+// Forwards every call to another Database and records its latency in
+// kbh_db_call_seconds{call=...}; writes that report failure and empty
+// paragraph fetches also count in kbh_db_errors_total, and
+// kbh_db_calls_in_flight shows how many are waiting or running. main wraps
+// whichever backend runs.
+class TimedDatabase : public Database {
+public:
+    explicit TimedDatabase(Database* inner);
+
+    bool save_player_score(const std::string& player_name, int score) override;
+    std::vector<std::string> get_leaderboard() override;
+
+    std::string get_random_paragraph(const std::string& language = "en") override;
+    int64_t get_paragraph_id(const std::string& paragraph_body) override;
+
+    bool save_training_result(int64_t user_id, const std::string& paragraph_body, 
+                              double wpm, double accuracy, 
+                              int duration_ms, int words_committed) override;
+    
+    std::pair<int64_t, std::string> authenticate(const std::string& username, const std::string& password) override;
+    int64_t create_user(const std::string& username, const std::string& password) override;
+    bool change_password(const std::string& username, const std::string& old_password, const std::string& new_password) override;
+    
+    std::vector<LeaderboardEntry> get_top_players(int limit = 8) override;
+    LeaderboardEntry get_user_rank(int64_t user_id) override;
+    double get_recent_wpm(int64_t user_id) override;
+    
+    bool save_keystroke_stats(const std::vector<KeystrokeStatRow>& rows) override;
+    std::vector<KeystrokeStatRow> get_keystroke_stats(int64_t user_id) override;
+
+private:
+    struct Call {
+        metrics::Histogram* latency;
+        metrics::Counter* errors;
+    };
+    enum CallId {
+        kSaveScore, kLeaderboard, kRandomParagraph, kParagraphId, kSaveTraining,
+        kAuthenticate, kCreateUser, kChangePassword, kTopPlayers, kUserRank,
+        kRecentWpm, kSaveKeystrokes, kGetKeystrokes, kCallCount
+    };
+
+    Database* inner_;
+    Call calls_[kCallCount];
+    metrics::Gauge* in_flight_;
+};
+
+#endif
@@ -1,48 +1,27 @@
-#pragma once
+#ifndef ARENA_MODE_H
+#define ARENA_MODE_H
 
-#include <unordered_map>
-#include <string>
 #include <vector>
-#include <jsoncpp/json/json.h>
+#include "../mode_input.h"
+#include "../../room/room_manager.h"
 
-#include "game_mode.h"
-#include "typing_engine.h"
-
-struct ArenaPlayer {
-    int fd;
-    std::string name;
-    bool ready = false;
-};
-
-class ArenaMode : public GameMode {
+// Classic race: everyone in the room types the room's paragraph until the
+// time is up or all have finished. The Room keeps the per-slot scoring.
+class ArenaMode {
 public:
-    explicit ArenaMode(const std::string& text);
-
-    /* ===== lifecycle from GameMode ===== */
-    void start() override;
-    void process_input(const std::string& input) override;   // unused, required by interface
-    void end() override;
-    void display_results() override;
-
-    /* ===== Arena specific APIs (used by Server / Room) ===== */
-    void add_player(int fd, const std::string& name);
-    void remove_player(int fd);
+    ArenaMode(RoomManager& rooms, Room* room) : rooms_(&rooms), room_(room) {}
 
-    void set_ready(int fd);
-    void set_unready(int fd);
-    bool all_ready() const;
+    Room* room() const { return room_; }
 
-    void process_player_input(int fd, int word_idx, const Json::Value& char_events, int64_t latest_time_ms);
-
-    bool finished() const;
-    std::string get_ranking() const;
-
-    const std::string& get_text() const;
+    void init(int64_t start_ms, int duration_ms);
+    void on_input(int fd, const ModeInput& input);
+    void on_tick(int64_t) {}
+    bool should_end(int64_t now_ms) const { return room_->is_game_ended(now_ms); }
+    std::vector<RankingEntry> rankings() const { return room_->get_rankings(); }
 
 private:
-    std::string target_text;
-    std::unordered_map<int, ArenaPlayer> players;
-
-    TypingEngine engine;
-    bool started = false;
+    RoomManager* rooms_;
+    Room* room_;
 };
+
+#endif
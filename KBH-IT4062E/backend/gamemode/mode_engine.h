@@ -0,0 +1,49 @@
+#ifndef MODE_ENGINE_H
+#define MODE_ENGINE_H
+
+#include <variant>
+#include <vector>
+#include "mode_input.h"
+#include "arena/arena_mode.h"
+#include "self_training/self_training_mode.h"
+#include "survival/survival_mode.h"
+
+// A running game in one of the modes. Every mode provides
+//
+//   void init(int64_t start_ms, int duration_ms)   start typing at start_ms
+//   void on_input(int fd, const ModeInput& input)  one input / input_batch
+//   void on_tick(int64_t now_ms)                   periodic work (tick thread)
+//   bool should_end(int64_t now_ms) const          time up or everyone done
+//   std::vector<RankingEntry> rankings() const     best first
+//   Room* room() const                             nullptr for training
+//
+// There is no base class: ModeGame holds the mode by value and std::visit
+// picks the implementation from the variant index, so every call below is
+// a direct (inlinable) call into the mode, keystrokes included.
+using ModeGame = std::variant<ArenaMode, TrainingMode, SurvivalMode>;
+
+inline void mode_init(ModeGame& game, int64_t start_ms, int duration_ms) {
+    std::visit([&](auto& mode) { mode.init(start_ms, duration_ms); }, game);
+}
+
+inline void mode_input(ModeGame& game, int fd, const ModeInput& input) {
+    std::visit([&](auto& mode) { mode.on_input(fd, input); }, game);
+}
+
+inline void mode_tick(ModeGame& game, int64_t now_ms) {
+    std::visit([&](auto& mode) { mode.on_tick(now_ms); }, game);
+}
+
+inline bool mode_should_end(const ModeGame& game, int64_t now_ms) {
+    return std::visit([&](const auto& mode) { return mode.should_end(now_ms); }, game);
+}
+
+inline Room* mode_room(const ModeGame& game) {
+    return std::visit([](const auto& mode) { return mode.room(); }, game);
+}
+
+inline std::vector<RankingEntry> mode_rankings(const ModeGame& game) {
+    return std::visit([](const auto& mode) { return mode.rankings(); }, game);
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef MODE_INPUT_H
+#define MODE_INPUT_H
+
+#include <jsoncpp/json/json.h>
+
+// One input message as the modes see it: a committed word (`input`,
+// word_idx >= 0 with its char events) or a streamed `input_batch`
+struct ModeInput {
+    int word_idx = -1;
+    const Json::Value* events = nullptr;
+
+    bool is_batch() const { return word_idx < 0; }
+};
+
+#endif
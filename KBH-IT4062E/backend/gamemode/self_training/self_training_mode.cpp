@@ -1,28 +1,52 @@
 #include "self_training_mode.h"
 
-SelfTrainingMode::SelfTrainingMode() {}
-SelfTrainingMode::SelfTrainingMode(const std::string& text) {
-    set_target_text(text);
+TrainingMode::TrainingMode(int fd, int client_id, std::string display_name,
+                           std::shared_ptr<const Paragraph> paragraph, ReplayWriter* replay_writer)
+    : fd_(fd), client_id_(client_id), display_name_(std::move(display_name)), paragraph_(std::move(paragraph)),
+      replay_writer_(replay_writer)
+{
 }
-SelfTrainingMode::~SelfTrainingMode() {}
 
-void SelfTrainingMode::start() {
-    std::cout << "Starting Self-training Mode...\n";
-    record_start();
+void TrainingMode::init(int64_t start_ms, int duration_ms) {
+    start_time_ms_ = start_ms;
+    duration_ms_ = duration_ms;
+    live_.start(&paragraph_->words(), start_ms);
+    replay_.begin(replay_writer_, "training", start_ms, duration_ms,
+                  paragraph_->text(), {{0, client_id_, display_name_}});
 }
 
-void SelfTrainingMode::process_input(const std::string& input) {
-    typed_text_ = input;
-    record_end();
-    last_result_ = compute_result(typed_text_);
+void TrainingMode::on_input(int, const ModeInput& input) {
+    if (input.is_batch()) {
+        for (const auto& event : *input.events) {
+            live_.apply_event(event, replay_, 0);
+        }
+    } else {
+        // The message carries the whole word, so start it from scratch
+        live_.begin_word(input.word_idx, replay_, 0);
+        for (const auto& event : *input.events) {
+            live_.apply_event(event, replay_, 0);
+        }
+        live_.commit(input.word_idx, replay_, 0);
+    }
+    replay_.flush();
 }
 
-void SelfTrainingMode::end() {
-    std::cout << "Ending Self-training Mode...\n";
+bool TrainingMode::should_end(int64_t now_ms) const {
+    return now_ms - start_time_ms_ >= duration_ms_ ||
+           live_.scorer.word_idx() >= paragraph_->total_words();
 }
 
-void SelfTrainingMode::display_results() {
-    std::cout << "Self-training results:\n";
-    std::cout << "WPM: " << last_result_.wpm 
-              << " | Accuracy: " << last_result_.accuracy << "%\n";
+std::vector<RankingEntry> TrainingMode::rankings() const {
+    PlayerMetrics metrics = live_.metrics();
+
+    RankingEntry entry;
+    entry.rank = 1;
+    entry.slot_idx = 0;
+    entry.client_id = fd_;
+    entry.display_name = display_name_;
+    entry.word_idx = metrics.word_idx;
+    entry.latest_time_ms = metrics.latest_time_ms;
+    entry.wpm = metrics.wpm;
+    entry.accuracy = metrics.accuracy;
+    return {entry};
 }
@@ -1,24 +1,50 @@
 #ifndef SELF_TRAINING_MODE_H
 #define SELF_TRAINING_MODE_H
 
-#include "game_mode.h"
-#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../mode_input.h"
+#include "../../room/room.h"
 
-class SelfTrainingMode : public GameMode {
+// One player alone against the clock, outside any room
+class TrainingMode {
 public:
-    SelfTrainingMode();
-    explicit SelfTrainingMode(const std::string& text);
-    ~SelfTrainingMode();
+    TrainingMode(int fd, int client_id, std::string display_name,
+                 std::shared_ptr<const Paragraph> paragraph, ReplayWriter* replay_writer);
+    ~TrainingMode() { replay_.end(); }
 
-    void start() override;
-    void process_input(const std::string& input) override;
-    void end() override;
-    void display_results() override;
+    // Not movable: the scorer points into live_. Construct in place.
+    TrainingMode(const TrainingMode&) = delete;
+    TrainingMode& operator=(const TrainingMode&) = delete;
 
-    Result get_result() const { return last_result_; }
+    void init(int64_t start_ms, int duration_ms);
+    void on_input(int fd, const ModeInput& input);
+    void on_tick(int64_t) {}
+    bool should_end(int64_t now_ms) const;
+    std::vector<RankingEntry> rankings() const;
+
+    int fd() const { return fd_; }
+    void set_fd(int fd) { fd_ = fd; }  // parked / resumed session
+    Room* room() const { return nullptr; }
+    const Paragraph& paragraph() const { return *paragraph_; }
+    const std::string& display_name() const { return display_name_; }
+    int64_t start_time_ms() const { return start_time_ms_; }
+    int duration_ms() const { return duration_ms_; }
+    PlayerMetrics metrics() const { return live_.metrics(); }
+    const KeystrokeStats& keystrokes() const { return live_.keystrokes; }
+    const LivePlayer& live() const { return live_; }
 
 private:
-    Result last_result_;
+    int fd_;
+    int client_id_;          // recorded in the replay as the player
+    std::string display_name_;
+    std::shared_ptr<const Paragraph> paragraph_;
+    int64_t start_time_ms_ = 0;
+    int duration_ms_ = 0;
+    LivePlayer live_;        // scoring + keystroke analytics, same as arena players
+    ReplayWriter* replay_writer_;
+    ReplayRecorder replay_;
 };
 
 #endif
@@ -1,51 +1,118 @@
 #include "survival_mode.h"
 #include <algorithm>
 
-SurvivalMode::SurvivalMode() {}
-SurvivalMode::~SurvivalMode() {}
+static bool plays_worse(const SurvivalScore& a, const SurvivalScore& b) {
+    if (a.word_idx != b.word_idx) return a.word_idx < b.word_idx;
+    return a.latest_time_ms > b.latest_time_ms;
+}
+
+SurvivalMode::SurvivalMode(RoomManager& rooms, Room* room, const SurvivalConfig& cfg)
+    : rooms_(&rooms), room_(room), cfg_(cfg)
+{
+}
 
-void SurvivalMode::start() {
-    std::cout << "Starting Survival Mode...\n";
+int SurvivalMode::stage_duration_ms() const {
+    int ms = cfg_.stage_ms - (stage_ - 1) * cfg_.stage_step_ms;
+    return std::max(ms, std::min(cfg_.min_stage_ms, cfg_.stage_ms));
 }
 
-void SurvivalMode::process_input(const std::string& input) {
-    std::cout << "SurvivalMode::process_input (not used, use process_player_result)\n";
+void SurvivalMode::init(int64_t start_ms, int) {
+    begin_stage(start_ms);
 }
 
-void SurvivalMode::add_player(const std::string& player_id) {
-    if (players_.size() >= 10) return;
-    SurvivalPlayer p;
-    p.id = player_id;
-    players_.push_back(p);
+void SurvivalMode::begin_stage(int64_t start_ms) {
+    stage_++;
+    rooms_->start_game(room_, start_ms, stage_duration_ms());
 }
 
-void SurvivalMode::process_player_result(
-    const std::string& player_id, 
-    const std::string& typed, 
-    double time_seconds
-) {
-    for (auto &p : players_) {
-        if (p.id == player_id && p.alive) {
-            p.last_result = compute_result_with_duration(typed, time_seconds);
-            p.alive = true;
-            break;
-        }
+void SurvivalMode::on_input(int fd, const ModeInput& input) {
+    if (input.is_batch()) {
+        room_->process_input_batch(fd, *input.events);
+    } else {
+        room_->process_input(fd, input.word_idx, *input.events);
     }
 }
 
-void SurvivalMode::advance_stage() {
-    current_stage_++;
+void SurvivalMode::on_tick(int64_t) {
+    // Stages end on the room clock (should_end); nothing to do between
+}
+
+std::vector<SurvivalScore> SurvivalMode::alive_scores() const {
+    std::vector<SurvivalScore> alive;
+    for (int i = 0; i < 8; i++) {
+        const auto& slot = room_->get_slot(i);
+        if (!slot.occupied || slot.eliminated) continue;
+
+        PlayerMetrics metrics = room_->get_player_metrics(slot.client_fd);
+        SurvivalScore score;
+        score.slot_idx = i;
+        score.word_idx = metrics.word_idx;
+        score.latest_time_ms = metrics.latest_time_ms;
+        score.wpm = metrics.wpm;
+        score.accuracy = metrics.accuracy;
+        alive.push_back(score);
+    }
+    return alive;
 }
 
-void SurvivalMode::end() {
-    std::cout << "Ending Survival Mode...\n";
+std::vector<SurvivalScore> SurvivalMode::end_stage() {
+    std::vector<SurvivalScore> alive = alive_scores();
+    if (alive.size() <= 1) return {};
+
+    // At least one goes out per stage, at least one stays in
+    size_t cut = alive.size() * cfg_.eliminate_pct / 100;
+    cut = std::min(std::max<size_t>(cut, 1), alive.size() - 1);
+
+    std::partial_sort(alive.begin(), alive.begin() + cut, alive.end(), plays_worse);
+    alive.resize(cut);
+    for (auto& score : alive) {
+        score.eliminated_stage = stage_;
+        out_.push_back(score);
+        room_->eliminate(score.slot_idx);
+    }
+    return alive;
+}
+
+void SurvivalMode::next_stage(int64_t start_ms) {
+    std::shared_ptr<const Paragraph> paragraph = rooms_->prefetched_paragraph();
+    if (paragraph) {
+        room_->set_paragraph(std::move(paragraph));
+    }
+    begin_stage(start_ms);
+}
+
+std::vector<RankingEntry> SurvivalMode::rankings() const {
+    std::vector<SurvivalScore> standings = alive_scores();
+    std::sort(standings.begin(), standings.end(), [](const SurvivalScore& a, const SurvivalScore& b) {
+        return plays_worse(b, a);
+    });
+
+    // out_ is worst first within a stage and earliest stage first, so
+    // walking it backwards gives the later (better) eliminations first
+    standings.insert(standings.end(), out_.rbegin(), out_.rend());
+
+    std::vector<RankingEntry> rankings;
+    for (const auto& s : standings) {
+        const auto& slot = room_->get_slot(s.slot_idx);
+        if (!slot.occupied) continue;  // left after being eliminated
+
+        RankingEntry entry;
+        entry.rank = (int)rankings.size() + 1;
+        entry.slot_idx = s.slot_idx;
+        entry.client_id = slot.client_id;
+        entry.display_name = slot.display_name;
+        entry.word_idx = s.word_idx;
+        entry.latest_time_ms = s.latest_time_ms;
+        entry.wpm = s.wpm;
+        entry.accuracy = s.accuracy;
+        rankings.push_back(entry);
+    }
+    return rankings;
 }
 
-void SurvivalMode::display_results() {
-    std::cout << "Survival Results:\n";
-    for (auto &p : players_) {
-        std::cout << p.id << " - WPM: " 
-                  << p.last_result.wpm
-                  << " | Acc: " << p.last_result.accuracy << "%\n";
+int SurvivalMode::eliminated_stage(int slot_idx) const {
+    for (const auto& s : out_) {
+        if (s.slot_idx == slot_idx) return s.eliminated_stage;
     }
+    return 0;
 }
@@ -1,42 +1,73 @@
 #ifndef SURVIVAL_MODE_H
 #define SURVIVAL_MODE_H
 
-#include "game_mode.h"
-#include <iostream>
+#include <cstdint>
+#include <memory>
 #include <vector>
+#include "../mode_input.h"
+#include "../../room/room_manager.h"
 
-struct SurvivalPlayer {
-    std::string id;
-    GameMode::Result last_result;
-    bool alive = true;
-    int survived_stages = 0;
-    int points = 0;
-    int eliminated_stage = 0;
+struct SurvivalConfig {
+    int min_players = 3;
+    int stage_ms = 40000;       // length of the first stage
+    int stage_step_ms = 5000;   // every later stage is this much shorter...
+    int min_stage_ms = 20000;   // ...down to this
+    int eliminate_pct = 25;     // share of the survivors cut per stage (at least 1)
+    int max_stages = 8;         // whoever is left after this stage shares the win
+    int break_ms = 5000;        // stage results on screen before the next one
 };
 
-class SurvivalMode : public GameMode {
+// A player still in the game, scored on the stage that just ended.
+// Worse = fewer words, then the later last commit (the arena order).
+struct SurvivalScore {
+    int slot_idx = 0;
+    int word_idx = 0;
+    int64_t latest_time_ms = 0;
+    double wpm = 0.0;
+    double accuracy = 0.0;
+    int eliminated_stage = 0;   // 0 = still alive
+};
+
+// Elimination game in one room: timed stages, the slowest players go out
+// after each. The Server owns the clock and the sockets; this class
+// decides who goes out. The next stage's paragraph comes from the ones
+// RoomManager fetches ahead while stages are played.
+class SurvivalMode {
 public:
-    SurvivalMode();
-    ~SurvivalMode();
+    SurvivalMode(RoomManager& rooms, Room* room, const SurvivalConfig& cfg);
 
-    void start() override;
-    void process_input(const std::string& input) override;
-    void end() override;
-    void display_results() override;
+    Room* room() const { return room_; }
+    int stage() const { return stage_; }
+    int stage_duration_ms() const;
 
-    void add_player(const std::string& player_id);
+    // Mode engine interface (duration comes from the stage schedule)
+    void init(int64_t start_ms, int duration_ms);
+    void on_input(int fd, const ModeInput& input);
+    void on_tick(int64_t now_ms);
+    bool should_end(int64_t now_ms) const { return room_->is_game_ended(now_ms); }
+    std::vector<RankingEntry> rankings() const;
 
-    void process_player_result(const std::string& player_id,
-                               const std::string& typed,
-                               double time_seconds);
+    // Ends the stage: cuts the slowest survivors (a partial sort, only the
+    // cut is ordered) and takes them out of the Room. Returns the
+    // eliminated, worst first.
+    std::vector<SurvivalScore> end_stage();
+    bool finished() const { return room_->alive_count() <= 1 || stage_ >= cfg_.max_stages; }
 
-    void advance_stage();
-    int get_current_stage() const { return current_stage_; }
+    // Starts the next stage at start_ms on the prefetched paragraph; if the
+    // corpus has not answered yet the room keeps its text rather than wait
+    void next_stage(int64_t start_ms);
+
+    int eliminated_stage(int slot_idx) const;
 
 private:
-    int current_stage_ = 1;
-    std::vector<SurvivalPlayer> players_;
-    const int min_players_ = 5;
+    std::vector<SurvivalScore> alive_scores() const;
+    void begin_stage(int64_t start_ms);
+
+    RoomManager* rooms_;
+    Room* room_;
+    SurvivalConfig cfg_;
+    int stage_ = 0;
+    std::vector<SurvivalScore> out_;  // in elimination order
 };
 
 #endif
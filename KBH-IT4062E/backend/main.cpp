@@ -1,24 +1,149 @@
-#include <iostream>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <csignal>
+#include <pthread.h>
 #include "server.h"
 #include "config.h"
-#include "database.h"
+#include "config_watcher.h"
+#include "pg_database.h"
+#include "memory_database.h"
+#include "timed_database.h"
+#include "metrics_exporter.h"
+#include "tracer.h"
+#include "admin_server.h"
+#include "handoff.h"
+#include "log.h"
 
-int main() {
-    std::cout << "=== Keyboard Heroes Arena Server ===\n";
+int main(int argc, char* argv[]) {
+    // A send() to a client that already hung up must not kill the server
+    signal(SIGPIPE, SIG_IGN);
 
-    Config config("config/server_config.json");
+    // SIGTERM / SIGINT drain the server instead of killing it. Blocked
+    // before any thread starts, so only sigwait() below ever takes them.
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGTERM);
+    sigaddset(&stop_signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    const std::string config_path = "config/server_config.json";
+    Config config(config_path);
     std::string server_ip   = config.get_server_ip();
     int         server_port = config.get_server_port();
     std::string db_conn_str = config.get_config_value("db_conn_str");
+    std::string replay_dir  = config.get_config_value("replay_dir");
+    std::string db_backend  = config.get_config_value("db_backend");
+
+    // Game timings, limits and log level; they can change while running
+    ServerSettings settings;
+    std::string settings_error;
+    if (!load_server_settings(config_path, settings, settings_error)) {
+        LOG_ERROR("config", "Invalid config").field("error", settings_error);
+        logging::flush();
+        return 1;
+    }
+    logging::set_level(settings.log_level);
+
+    LOG_INFO("server", "Keyboard Heroes Arena Server").field("ip", server_ip).field("port", server_port);
+
+    // "memory" runs without PostgreSQL (load tests); anything else is Postgres
+    std::unique_ptr<Database> db;
+    if (db_backend == "memory") {
+        int latency_ms = config.get_config_int("db_latency_ms", 0);
+        int jitter_ms  = config.get_config_int("db_latency_jitter_ms", 0);
+        LOG_INFO("config", "In-memory database").field("latency_ms", latency_ms)
+            .field("jitter_ms", jitter_ms);
+        db = std::make_unique<MemoryDatabase>(config.get_config_value("memory_corpus"),
+                                              latency_ms, jitter_ms);
+    } else {
+        db = std::make_unique<PgDatabase>(db_conn_str);
+    }
+
+    // Every DB call is timed for the metrics endpoint
+    TimedDatabase timed_db(db.get());
+    Server server(server_ip, server_port, &timed_db, replay_dir);
+
+    // Hot restart: the running server hands its listening sockets over
+    // through the admin socket, then drains. Must happen before our own
+    // admin socket replaces its socket file.
+    InheritedListeners inherited;
+    if (argc > 1 && std::string(argv[1]) == "--takeover") {
+        if (!take_over_listeners(config.get_socket_path(), inherited)) {
+            logging::flush();
+            return 1;
+        }
+        server.adopt_listener(inherited.game);
+    }
 
-    std::cout << "[CONFIG] IP: " << server_ip
-              << "  PORT: " << server_port << "\n";
+    // Prometheus scrape endpoint, loopback only (0 = off)
+    MetricsExporter exporter(metrics::Registry::global());
+    int metrics_port = config.get_config_int("metrics_port", 0);
+    if (inherited.metrics >= 0) {
+        exporter.adopt(inherited.metrics);
+    } else if (metrics_port > 0) {
+        exporter.start("127.0.0.1", metrics_port);
+    }
+    
+    // Sampled per-message traces in Chrome trace format (0 = off)
+    int trace_every = config.get_config_int("trace_sample_every", 0);
+    if (trace_every > 0) {
+        tracing::Tracer::global().start(config.get_config_value("trace_file"), trace_every);
+    }
 
-    Database db(db_conn_str);
+    // Local admin socket for live introspection ("" = off)
+    AdminServer admin([&server] { return server.admin_snapshot(); }, metrics::Registry::global());
+    std::string socket_path = config.get_socket_path();
+    if (!socket_path.empty()) {
+        admin.start(socket_path);
+    }
+
+    server.publish_settings(std::make_shared<const ServerSettings>(std::move(settings)));
+
+    // Edits to the config file go live; one that fails to load or check is
+    // logged and ignored. Addresses, ports, paths and the database stay.
+    ConfigWatcher config_watcher(config_path, [&] {
+        ServerSettings next;
+        std::string error;
+        if (!load_server_settings(config_path, next, error)) {
+            LOG_WARN("config", "Config change rejected, keeping the running settings").field("error", error);
+            return;
+        }
+        logging::set_level(next.log_level);
+        server.publish_settings(std::make_shared<const ServerSettings>(std::move(next)));
+        LOG_INFO("config", "Config reloaded");
+    });
+    config_watcher.start();
+
+    // The first signal drains (running games get drain_timeout_ms to
+    // finish), a second one ends them right away
+    auto drain_ms = [&server] { return server.settings()->drain_timeout_ms; };
+    std::atomic<bool> stopped{false};
+    std::thread signal_thread([&] {
+        for (int received = 0; ; received++) {
+            int sig = 0;
+            sigwait(&stop_signals, &sig);
+            if (stopped) return;
+            LOG_INFO("server", received == 0 ? "Stop signal, draining" : "Stop signal again, ending games now")
+                .field("signal", sig);
+            server.drain(received == 0 ? drain_ms() : 0);
+        }
+    });
+
+    admin.enable_handoff(
+        [&] { return std::vector<int>{server.dup_listener(), exporter.dup_listener()}; },
+        [&] {
+            exporter.stop();
+            server.drain(drain_ms());
+        });
 
-    Server server(server_ip, server_port, &db);
-    std::cout << "[SERVER] Starting...\n";
     server.start();
 
+    // Wake the signal thread so it can see we are done
+    stopped = true;
+    pthread_kill(signal_thread.native_handle(), SIGTERM);
+    signal_thread.join();
+
+    logging::flush();
     return 0;
 }
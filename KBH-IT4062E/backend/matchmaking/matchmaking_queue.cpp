@@ -0,0 +1,165 @@
+#include "matchmaking_queue.h"
+#include <algorithm>
+
+MatchmakingQueue::MatchmakingQueue(const MatchmakingConfig& cfg)
+    : cfg_(cfg) {}
+
+bool MatchmakingQueue::enqueue(int fd, double wpm, int64_t now_ms) {
+    if (entries_.count(fd)) return false;
+
+    Entry e{wpm, next_seq_++, now_ms};
+    entries_.emplace(fd, e);
+    by_wpm_.emplace(e.wpm, e.seq, fd);
+    return true;
+}
+
+bool MatchmakingQueue::remove(int fd) {
+    auto it = entries_.find(fd);
+    if (it == entries_.end()) return false;
+
+    by_wpm_.erase(Key{it->second.wpm, it->second.seq, fd});
+    entries_.erase(it);
+    return true;
+}
+
+double MatchmakingQueue::allowance(const Entry& e, int64_t now_ms) const {
+    double waited_s = std::max<int64_t>(0, now_ms - e.enqueued_ms) / 1000.0;
+    return std::min(cfg_.max_spread_wpm, cfg_.base_spread_wpm + cfg_.widen_wpm_per_s * waited_s);
+}
+
+bool MatchmakingQueue::requeue(int fd) {
+    auto it = matched_.find(fd);
+    if (it == matched_.end() || entries_.count(fd)) return false;
+
+    entries_.emplace(fd, it->second);
+    by_wpm_.emplace(it->second.wpm, it->second.seq, fd);
+    matched_.erase(it);
+    return true;
+}
+
+std::vector<std::vector<int>> MatchmakingQueue::tick(int64_t now_ms) {
+    matched_.clear();
+    std::vector<std::vector<int>> groups;
+    int room_size = std::max(2, cfg_.room_size);
+    int min_players = std::max(2, std::min(cfg_.min_players, room_size));
+    if ((int)entries_.size() < min_players) return groups;
+
+    // Snapshot in WPM order: (fd, entry)
+    std::vector<std::pair<int, const Entry*>> order;
+    order.reserve(by_wpm_.size());
+    for (const auto& key : by_wpm_) {
+        int fd = std::get<2>(key);
+        order.emplace_back(fd, &entries_.at(fd));
+    }
+
+    size_t n = order.size();
+    std::vector<bool> taken(n, false);
+    auto form = [&](std::vector<size_t> members) {
+        std::vector<int> group;
+        group.reserve(members.size());
+        for (size_t j : members) {
+            taken[j] = true;
+            group.push_back(order[j].first);
+        }
+        groups.push_back(std::move(group));
+    };
+
+    // Full rooms: the next room_size players, if their spread fits the
+    // widest allowance among them
+    size_t i = 0;
+    while (i + room_size <= n) {
+        double allow = 0.0;
+        for (size_t j = i; j < i + room_size; j++) {
+            allow = std::max(allow, allowance(*order[j].second, now_ms));
+        }
+        if (order[i + room_size - 1].second->wpm - order[i].second->wpm > allow) {
+            i++;
+            continue;
+        }
+        std::vector<size_t> members(room_size);
+        for (int k = 0; k < room_size; k++) members[k] = i + k;
+        form(std::move(members));
+        i += room_size;
+    }
+
+    // Smaller rooms around players who have waited long enough, longest
+    // wait first. The window grows towards whichever neighbour (slower or
+    // faster) keeps the spread smaller, within the widest allowance in it.
+    const size_t none = n;
+    std::vector<size_t> prev(n, none), next(n, none);   // untaken neighbours
+    std::vector<size_t> waiters;
+    size_t last = none;
+    for (size_t j = 0; j < n; j++) {
+        if (taken[j]) continue;
+        prev[j] = last;
+        if (last != none) next[last] = j;
+        last = j;
+        if (now_ms - order[j].second->enqueued_ms >= cfg_.partial_after_ms) {
+            waiters.push_back(j);
+        }
+    }
+    std::sort(waiters.begin(), waiters.end(), [&](size_t a, size_t b) {
+        return order[a].second->seq < order[b].second->seq;
+    });
+
+    auto wpm = [&](size_t j) { return order[j].second->wpm; };
+    for (size_t w : waiters) {
+        if (taken[w]) continue;
+        size_t lo = w, hi = w;
+        int count = 1;
+        double allow = allowance(*order[w].second, now_ms);
+        // Whether the window with cand added stays within the widest
+        // allowance (the members' so far are folded into allow)
+        auto fits = [&](size_t cand) {
+            if (cand == none) return false;
+            double spread = std::max(wpm(hi), wpm(cand)) - std::min(wpm(lo), wpm(cand));
+            return spread <= std::max(allow, allowance(*order[cand].second, now_ms));
+        };
+        while (count < room_size) {
+            size_t down = prev[lo], up = next[hi];
+            bool down_nearer = up == none || (down != none && wpm(hi) - wpm(down) <= wpm(up) - wpm(lo));
+            size_t picked = none;
+            if (fits(down_nearer ? down : up)) {
+                picked = down_nearer ? down : up;
+            } else if (fits(down_nearer ? up : down)) {
+                picked = down_nearer ? up : down;
+            }
+            if (picked == none) break;
+            allow = std::max(allow, allowance(*order[picked].second, now_ms));
+            if (picked == down) lo = down; else hi = up;
+            count++;
+        }
+        if (count < min_players) continue;
+
+        std::vector<size_t> members;
+        for (size_t j = lo; ; j = next[j]) {
+            members.push_back(j);
+            if (j == hi) break;
+        }
+        // Unlink the whole window from the untaken list
+        if (prev[lo] != none) next[prev[lo]] = next[hi];
+        if (next[hi] != none) prev[next[hi]] = prev[lo];
+        form(std::move(members));
+    }
+
+    for (const auto& group : groups) {
+        for (int fd : group) {
+            matched_.emplace(fd, entries_.at(fd));
+            remove(fd);
+        }
+    }
+    return groups;
+}
+
+std::vector<int> MatchmakingQueue::take_expired(int64_t now_ms) {
+    std::vector<int> expired;
+    for (const auto& kv : entries_) {
+        if (now_ms - kv.second.enqueued_ms >= cfg_.max_wait_ms) {
+            expired.push_back(kv.first);
+        }
+    }
+    for (int fd : expired) {
+        remove(fd);
+    }
+    return expired;
+}
@@ -0,0 +1,72 @@
+#ifndef MATCHMAKING_QUEUE_H
+#define MATCHMAKING_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+struct MatchmakingConfig {
+    bool enabled = false;
+    int room_size = 8;              // players per full room
+    int min_players = 2;            // smallest room formed for long waiters
+    double base_spread_wpm = 10.0;  // allowed WPM gap in a room at first
+    double widen_wpm_per_s = 5.0;   // gap grows by this per second waited
+    double max_spread_wpm = 80.0;
+    int partial_after_ms = 10000;   // then rooms below room_size are allowed
+    int max_wait_ms = 30000;        // then the player is handed back (join_random)
+    int tick_ms = 250;
+};
+
+// Players waiting for a skill-matched room, ordered by recent WPM.
+//
+// Insert/remove are O(log n) (ordered set + fd map). tick() walks the
+// queue once in WPM order and cuts it into rooms whose WPM spread fits the
+// most generous allowance in the group; allowances widen with waiting
+// time, so slow-to-match players eventually join a neighbouring bracket.
+// Players left over who waited partial_after_ms then get a smaller room
+// grown from them towards both slower and faster neighbours.
+class MatchmakingQueue {
+public:
+    explicit MatchmakingQueue(const MatchmakingConfig& cfg = MatchmakingConfig{});
+
+    void set_config(const MatchmakingConfig& cfg) { cfg_ = cfg; }
+    const MatchmakingConfig& config() const { return cfg_; }
+
+    // false if fd is already queued
+    bool enqueue(int fd, double wpm, int64_t now_ms);
+    bool remove(int fd);
+    bool contains(int fd) const { return entries_.count(fd) > 0; }
+    size_t size() const { return entries_.size(); }
+
+    // Forms as many rooms as possible; each group is removed from the queue
+    std::vector<std::vector<int>> tick(int64_t now_ms);
+
+    // Puts back a player the last tick() matched whose room could not be
+    // opened, keeping their place and time waited; false if it did not
+    // match fd
+    bool requeue(int fd);
+
+    // Removes and returns players that waited past max_wait_ms
+    std::vector<int> take_expired(int64_t now_ms);
+
+private:
+    struct Entry {
+        double wpm;
+        uint64_t seq;
+        int64_t enqueued_ms;
+    };
+    using Key = std::tuple<double, uint64_t, int>;  // (wpm, seq, fd)
+
+    double allowance(const Entry& e, int64_t now_ms) const;
+
+    MatchmakingConfig cfg_;
+    std::set<Key> by_wpm_;
+    std::unordered_map<int, Entry> entries_;
+    std::unordered_map<int, Entry> matched_;   // last tick's groups, for requeue
+    uint64_t next_seq_ = 0;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "metrics.h"
+#include <cstdio>
+#include <sstream>
+
+namespace metrics {
+
+int shard_index() {
+    static std::atomic<int> next{0};
+    thread_local int index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& cell : cells_) {
+        total += cell.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t Histogram::bucket_limit_us(int i) {
+    if (i < kSub) return i + 1;
+    int msb = (i >> kSubBits) + kSubBits - 1;
+    int64_t width = int64_t(1) << (msb - kSubBits);
+    return (int64_t(1) << msb) + (i & (kSub - 1)) * width + width;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snap;
+    for (const auto& shard : shards_) {
+        for (int i = 0; i < kBuckets; i++) {
+            snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snap.sum_us += shard.sum_us.load(std::memory_order_relaxed);
+    }
+    for (uint64_t n : snap.buckets) {
+        snap.count += n;
+    }
+    return snap;
+}
+
+int64_t Histogram::Snapshot::quantile_us(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)count);
+    if (rank >= count) rank = count - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen > rank) return bucket_limit_us(i);
+    }
+    return bucket_limit_us(kBuckets - 1);
+}
+
+Registry& Registry::global() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Series& Registry::series(const std::string& name, Kind kind, const std::string& help,
+                                   const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family& family = families_[name];
+    if (family.series.empty()) {
+        family.kind = kind;
+        family.help = help;
+    }
+    for (auto& s : family.series) {
+        if (s.labels == labels) return s;
+    }
+
+    family.series.emplace_back();
+    Series& s = family.series.back();
+    s.labels = labels;
+    switch (family.kind) {
+        case Kind::Counter:   s.counter = std::make_unique<Counter>(); break;
+        case Kind::Gauge:     s.gauge = std::make_unique<Gauge>(); break;
+        case Kind::Histogram: s.histogram = std::make_unique<Histogram>(); break;
+    }
+    return s;
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help,
+                           const std::string& labels) {
+    return *series(name, Kind::Counter, help, labels).counter;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help,
+                       const std::string& labels) {
+    return *series(name, Kind::Gauge, help, labels).gauge;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help,
+                               const std::string& labels) {
+    return *series(name, Kind::Histogram, help, labels).histogram;
+}
+
+static std::string seconds(int64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", (double)us / 1e6);
+    return buf;
+}
+
+std::string Registry::render() const {
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& [name, family] : families_) {
+        static const char* kTypes[] = {"counter", "gauge", "histogram"};
+        out << "# HELP " << name << " " << family.help << "\n";
+        out << "# TYPE " << name << " " << kTypes[(int)family.kind] << "\n";
+
+        for (const auto& s : family.series) {
+            std::string braces = s.labels.empty() ? "" : "{" + s.labels + "}";
+            if (s.counter) {
+                out << name << braces << " " << s.counter->value() << "\n";
+            } else if (s.gauge) {
+                out << name << braces << " " << s.gauge->value() << "\n";
+            } else {
+                // Cumulative, at the power-of-two bucket limits only
+                Histogram::Snapshot snap = s.histogram->snapshot();
+                std::string prefix = s.labels.empty() ? "" : s.labels + ",";
+                uint64_t cumulative = 0;
+                for (int i = 0; i < Histogram::kBuckets; i++) {
+                    cumulative += snap.buckets[i];
+                    int64_t limit = Histogram::bucket_limit_us(i);
+                    if ((limit & (limit - 1)) != 0) continue;
+                    out << name << "_bucket{" << prefix << "le=\"" << seconds(limit) << "\"} "
+                        << cumulative << "\n";
+                }
+                out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << snap.count << "\n";
+                out << name << "_sum" << braces << " " << seconds((int64_t)snap.sum_us) << "\n";
+                out << name << "_count" << braces << " " << snap.count << "\n";
+            }
+        }
+    }
+    return out.str();
+}
+
+} // namespace metrics
@@ -0,0 +1,166 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide counters, gauges and latency histograms, rendered in the
+// Prometheus text format (MetricsExporter serves it over HTTP).
+//
+// Recording is a relaxed atomic add into the calling thread's shard: no
+// lock and no cache line shared with other threads, a few ns per call, so
+// it stays on in production. Summing the shards happens only on a scrape.
+//
+// Metrics are created once through the Registry (at startup or on first
+// use) and live until exit; callers keep the returned reference.
+namespace metrics {
+
+constexpr int kShards = 16;
+
+// Shard of the calling thread (threads are spread round-robin)
+int shard_index();
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) {
+        cells_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    Cell cells_[kShards];
+};
+
+// Set from one place (the tick) or moved up and down; one cell is enough
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t d) { value_.fetch_add(d, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// HDR-style log-linear histogram over microseconds: 4 sub-buckets per
+// power of two from 1us to ~134s, so a bucket bound is never more than
+// 25% off the value. The exporter shows the power-of-two bounds.
+class Histogram {
+public:
+    static constexpr int kSubBits = 2;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kBuckets = 26 * kSub;   // last bucket also takes anything larger
+
+    void record_us(int64_t us) {
+        Shard& shard = shards_[shard_index()];
+        shard.buckets[bucket_of(us)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum_us.fetch_add(us > 0 ? (uint64_t)us : 0, std::memory_order_relaxed);
+    }
+    void record(std::chrono::steady_clock::duration d) {
+        record_us(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    }
+
+    struct Snapshot {
+        uint64_t buckets[kBuckets] = {};
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+
+        // Upper bound (us) of the bucket holding the q-quantile, 0 if empty
+        int64_t quantile_us(double q) const;
+    };
+    Snapshot snapshot() const;
+
+    static int bucket_of(int64_t us) {
+        if (us < kSub) return us < 0 ? 0 : (int)us;
+        int msb = 63 - __builtin_clzll((uint64_t)us);
+        int idx = ((msb - kSubBits + 1) << kSubBits) | (int)((us >> (msb - kSubBits)) & (kSub - 1));
+        return idx < kBuckets ? idx : kBuckets - 1;
+    }
+    // Values in bucket i are below this
+    static int64_t bucket_limit_us(int i);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[kBuckets] = {};
+        std::atomic<uint64_t> sum_us{0};
+    };
+    Shard shards_[kShards];
+};
+
+// Times a scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Name + label set -> metric. Asking again for the same pair returns the
+// same metric, so lazily registered call sites are fine.
+class Registry {
+public:
+    static Registry& global();
+
+    // labels is the inside of the braces, e.g. `type="input"`
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& labels = "");
+    // Seconds in the exposition (Prometheus convention), us inside
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::string& labels = "");
+
+    // Prometheus text exposition format 0.0.4
+    std::string render() const;
+
+    // Visit every histogram (admin / snapshot views)
+    template <typename Fn>
+    void for_each_histogram(Fn fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, family] : families_) {
+            for (const auto& series : family.series) {
+                if (series.histogram) fn(name, series.labels, *series.histogram);
+            }
+        }
+    }
+
+private:
+    enum class Kind { Counter, Gauge, Histogram };
+    struct Series {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+    struct Family {
+        Kind kind;
+        std::string help;
+        std::vector<Series> series;
+    };
+
+    Series& series(const std::string& name, Kind kind, const std::string& help,
+                   const std::string& labels);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;   // sorted: stable scrape output
+};
+
+} // namespace metrics
+
+#endif
@@ -0,0 +1,107 @@
+#include "metrics_exporter.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "log.h"
+
+bool MetricsExporter::start(const std::string& ip, int port) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("metrics", "socket failed").field("error", strerror(errno));
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr(ip.c_str());
+
+    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 16) < 0) {
+        LOG_ERROR("metrics", "bind failed").field("error", strerror(errno)).field("port", port);
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    LOG_INFO("metrics", "Serving /metrics").field("ip", ip).field("port", port);
+    thread_ = std::thread(&MetricsExporter::serve_loop, this);
+    return true;
+}
+
+bool MetricsExporter::adopt(int listen_fd) {
+    listen_fd_ = listen_fd;
+    LOG_INFO("metrics", "Serving /metrics on inherited socket").field("fd", listen_fd);
+    thread_ = std::thread(&MetricsExporter::serve_loop, this);
+    return true;
+}
+
+int MetricsExporter::dup_listener() const {
+    return listen_fd_ >= 0 ? dup(listen_fd_) : -1;
+}
+
+void MetricsExporter::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsExporter::serve_loop() {
+    while (!stop_) {
+        // Wake up now and then to notice stop()
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        serve(fd);
+        close(fd);
+    }
+}
+
+void MetricsExporter::serve(int fd) {
+    // A scraper that never sends its request must not hold the thread
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return;
+        request.append(buffer, n);
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0) {
+        body = registry_.render();
+    } else {
+        status = "404 Not Found";
+        body = "not found\n";
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += n;
+    }
+}
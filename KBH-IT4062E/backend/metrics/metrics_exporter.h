@@ -0,0 +1,40 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "metrics.h"
+
+// Minimal HTTP/1.0 endpoint for scrapers: GET /metrics answers the
+// registry in Prometheus text format, anything else is 404. One request
+// per connection on its own thread, away from the game port and the
+// server's state lock.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(metrics::Registry& registry) : registry_(registry) {}
+    ~MetricsExporter() { stop(); }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Bind ip:port (keep it on loopback) and start serving
+    bool start(const std::string& ip, int port);
+    // Serve on a listening socket inherited from the previous process
+    bool adopt(int listen_fd);
+    void stop();
+
+    // Copy of the listening socket for a hot restart, or -1
+    int dup_listener() const;
+
+private:
+    void serve_loop();
+    void serve(int fd);
+
+    metrics::Registry& registry_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+#endif
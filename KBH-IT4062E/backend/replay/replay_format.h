@@ -0,0 +1,102 @@
+#ifndef REPLAY_FORMAT_H
+#define REPLAY_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ===============================
+// Keystroke replay file (.kbr)
+// ===============================
+//
+// One append-only file per game:
+//
+//   header:  "KBHR" u8:version
+//            str:room_id  varint:server_start_ms  varint:duration_ms
+//            str:paragraph  u8:player_count
+//            { u8:slot_idx  varint:client_id  str:display_name } * player_count
+//
+//   records: u8:slot_idx  u8:code  varint:zigzag(time delta)  [varint:zigzag(word_idx)]
+//
+// str = varint length + bytes. Time deltas are per slot (first one is
+// relative to server_start_ms). `code` is the typed byte (never below
+// kFirstTypedCode), or one of the control codes below; only kCodeCommit
+// carries the trailing word_idx.
+//
+// An `input` message (one whole word) is recorded as kCodeWord, its keys
+// and kCodeCommit; `input_batch` keys and commits come without kCodeWord.
+// Version 1 files have no kCodeWord and are replayed as whole words.
+
+namespace replay {
+
+constexpr char kMagic[4] = {'K', 'B', 'H', 'R'};
+constexpr uint8_t kVersion = 2;
+constexpr uint8_t kOldestVersion = 1;   // still readable
+
+constexpr uint8_t kCodeBackspace = 0x08;
+constexpr uint8_t kCodeCommit = 0x0A;   // word_idx committed
+constexpr uint8_t kCodeWord = 0x0B;     // start of an `input` message
+constexpr uint8_t kSlotEnd = 0xFF;      // game finished (no further records)
+constexpr uint8_t kFirstTypedCode = 0x20;   // lower codes are reserved for control
+
+constexpr int kMaxSlots = 8;
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline void put_string(std::vector<uint8_t>& out, const std::string& s) {
+    put_varint(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// Bounds-checked cursor over a mapped file; any short read sets ok = false
+struct Cursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool at_end() const { return p >= end; }
+
+    uint8_t u8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) { ok = false; return 0; }
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string str() {
+        uint64_t n = varint();
+        if (!ok || static_cast<uint64_t>(end - p) < n) { ok = false; return {}; }
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+}  // namespace replay
+
+#endif
@@ -0,0 +1,211 @@
+#include "replay_reader.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -------------------------------------------
+// ReplayReader
+// -------------------------------------------
+ReplayReader::~ReplayReader() {
+    close();
+}
+
+void ReplayReader::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    complete_ = false;
+}
+
+bool ReplayReader::open(const std::string& path, std::string& err) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        err = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || st.st_size < 5) {
+        err = "not a replay file: " + path;
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = "mmap failed: " + std::string(strerror(errno));
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = st.st_size;
+    cursor_ = replay::Cursor{data_, data_ + size_};
+
+    if (memcmp(data_, replay::kMagic, 4) != 0) {
+        err = "bad magic in " + path;
+        close();
+        return false;
+    }
+    cursor_.p += 4;
+    header_ = ReplayHeader{};
+    header_.version = cursor_.u8();
+    if (header_.version < replay::kOldestVersion || header_.version > replay::kVersion) {
+        err = "unsupported replay version in " + path;
+        close();
+        return false;
+    }
+
+    header_.room_id = cursor_.str();
+    header_.server_start_ms = static_cast<int64_t>(cursor_.varint());
+    header_.duration_ms = static_cast<int>(cursor_.varint());
+    header_.paragraph = cursor_.str();
+    int count = cursor_.u8();
+    for (int i = 0; i < count && cursor_.ok; i++) {
+        ReplayPlayerInfo info;
+        info.slot_idx = cursor_.u8();
+        info.client_id = static_cast<int>(cursor_.varint());
+        info.display_name = cursor_.str();
+        header_.players.push_back(info);
+    }
+
+    if (!cursor_.ok) {
+        err = "truncated header in " + path;
+        close();
+        return false;
+    }
+
+    for (int i = 0; i < replay::kMaxSlots; i++) {
+        last_time_ms_[i] = header_.server_start_ms;
+    }
+    return true;
+}
+
+bool ReplayReader::next(ReplayEvent& ev) {
+    if (!data_ || complete_ || cursor_.at_end()) return false;
+
+    replay::Cursor c = cursor_;
+    uint8_t slot = c.u8();
+    if (slot == replay::kSlotEnd) {
+        complete_ = true;
+        cursor_ = c;
+        return false;
+    }
+
+    uint8_t code = c.u8();
+    int64_t delta = replay::unzigzag(c.varint());
+    int word_idx = 0;
+    if (code == replay::kCodeCommit) {
+        word_idx = static_cast<int>(replay::unzigzag(c.varint()));
+    }
+
+    // Partial trailing record (writer was interrupted)
+    if (!c.ok || slot >= replay::kMaxSlots) return false;
+
+    cursor_ = c;
+    last_time_ms_[slot] += delta;
+
+    ev.slot_idx = slot;
+    ev.code = code;
+    ev.time_ms = last_time_ms_[slot];
+    ev.word_idx = word_idx;
+    return true;
+}
+
+// -------------------------------------------
+// Replay through the scoring engine
+// -------------------------------------------
+ReplayResult replay_game(ReplayReader& reader, double speed) {
+    ReplayResult result;
+    const ReplayHeader& h = reader.header();
+
+    // Slot i is played by pseudo-fd i + 1
+    Room room(h.room_id, h.paragraph);
+    for (const auto& p : h.players) {
+        room.add_player(p.slot_idx + 1, p.client_id, p.display_name);
+    }
+    room.start_game(h.server_start_ms, h.duration_ms);
+
+    // Events since the slot's last input; whole_word once a kCodeWord
+    // opened an `input` message (version 1: every commit closes one)
+    Json::Value pending[replay::kMaxSlots];
+    bool whole_word[replay::kMaxSlots] = {};
+    for (auto& events : pending) {
+        events = Json::Value(Json::arrayValue);
+    }
+    bool words_only = h.version < 2;
+
+    auto feed_batch = [&](int slot_idx) {
+        if (pending[slot_idx].empty()) return;
+        room.process_input_batch(slot_idx + 1, pending[slot_idx]);
+        pending[slot_idx] = Json::Value(Json::arrayValue);
+        result.inputs++;
+    };
+
+    auto wall_start = std::chrono::steady_clock::now();
+    ReplayEvent ev;
+
+    while (reader.next(ev)) {
+        result.events++;
+        Json::Value& events = pending[ev.slot_idx];
+
+        if (ev.code == replay::kCodeWord) {
+            feed_batch(ev.slot_idx);  // streamed keys before it
+            whole_word[ev.slot_idx] = true;
+            continue;
+        }
+
+        if (ev.code == replay::kCodeCommit) {
+            if (speed > 0) {
+                auto offset = std::chrono::duration<double, std::milli>(
+                    (ev.time_ms - h.server_start_ms) / speed);
+                std::this_thread::sleep_until(
+                    wall_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+            }
+            if (whole_word[ev.slot_idx] || words_only) {
+                room.process_input(ev.slot_idx + 1, ev.word_idx, events);
+                events = Json::Value(Json::arrayValue);
+                whole_word[ev.slot_idx] = false;
+                result.inputs++;
+            } else {
+                Json::Value commit;
+                commit["type"] = "commit";
+                commit["word_idx"] = ev.word_idx;
+                commit["time_ms"] = (Json::Int64)ev.time_ms;
+                events.append(commit);
+                feed_batch(ev.slot_idx);
+            }
+            continue;
+        }
+
+        Json::Value event;
+        if (ev.code == replay::kCodeBackspace) {
+            event["type"] = "backspace";
+        } else {
+            event["type"] = "char";
+            event["char"] = std::string(1, static_cast<char>(ev.code));
+        }
+        event["time_ms"] = (Json::Int64)ev.time_ms;
+        events.append(event);
+    }
+
+    // Keys typed after a player's last commit (the word in progress when
+    // the game ended) were scored live too
+    for (int i = 0; i < replay::kMaxSlots; i++) {
+        feed_batch(i);
+    }
+
+    result.complete = reader.complete();
+    result.rankings = room.get_rankings();
+    return result;
+}
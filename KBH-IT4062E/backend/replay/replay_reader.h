@@ -0,0 +1,71 @@
+#ifndef REPLAY_READER_H
+#define REPLAY_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "replay_format.h"
+#include "replay_writer.h"
+#include "../room/room.h"
+
+struct ReplayHeader {
+    int version = 0;
+    std::string room_id;
+    int64_t server_start_ms = 0;
+    int duration_ms = 0;
+    std::string paragraph;
+    std::vector<ReplayPlayerInfo> players;
+};
+
+struct ReplayEvent {
+    int slot_idx = 0;
+    uint8_t code = 0;        // typed byte, kCodeBackspace, kCodeWord or kCodeCommit
+    int64_t time_ms = 0;     // absolute server time
+    int word_idx = 0;        // only for kCodeCommit
+};
+
+// Memory-mapped sequential reader for .kbr files. A truncated tail
+// (server died mid-game) simply ends the event stream.
+class ReplayReader {
+public:
+    ReplayReader() = default;
+    ~ReplayReader();
+
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    bool open(const std::string& path, std::string& err);
+    void close();
+
+    const ReplayHeader& header() const { return header_; }
+
+    // Next record; false at the end marker or end of data
+    bool next(ReplayEvent& ev);
+
+    // True once the end-of-game marker has been read
+    bool complete() const { return complete_; }
+    size_t file_size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    replay::Cursor cursor_{nullptr, nullptr};
+    ReplayHeader header_;
+    int64_t last_time_ms_[replay::kMaxSlots] = {};
+    bool complete_ = false;
+};
+
+struct ReplayResult {
+    std::vector<RankingEntry> rankings;
+    size_t events = 0;
+    size_t inputs = 0;
+    bool complete = false;
+};
+
+// Feeds a stored game through the Room input path it came in on
+// (process_input per word, process_input_batch for streamed keys, including
+// those after a player's last commit). speed is a multiple of real time
+// (10 = ten times faster); <= 0 runs as fast as possible.
+ReplayResult replay_game(ReplayReader& reader, double speed);
+
+#endif
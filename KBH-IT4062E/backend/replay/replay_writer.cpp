@@ -0,0 +1,190 @@
+#include "replay_writer.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "log.h"
+
+// -------------------------------------------
+// ReplayWriter
+// -------------------------------------------
+ReplayWriter::ReplayWriter(const std::string& dir)
+    : dir_(dir)
+{
+    if (!enabled()) return;
+
+    if (mkdir(dir_.c_str(), 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("replay", "Cannot create directory, recording disabled").field("dir", dir_)
+            .field("error", strerror(errno));
+        dir_.clear();
+        return;
+    }
+
+    thread_ = std::thread(&ReplayWriter::write_loop, this);
+}
+
+ReplayWriter::~ReplayWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (auto& kv : open_fds_) {
+        close(kv.second);
+    }
+}
+
+std::string ReplayWriter::path_for(const std::string& room_id, int client_id) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto epoch_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    uint64_t seq = next_seq_.fetch_add(1, std::memory_order_relaxed);
+    return dir_ + "/" + room_id + "-" + std::to_string(client_id) + "-" +
+           std::to_string(epoch_ms) + "-" + std::to_string(seq) + ".kbr";
+}
+
+void ReplayWriter::append(const std::string& path, std::vector<uint8_t> bytes, bool last) {
+    if (!enabled()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Chunk{path, std::move(bytes), last});
+    }
+    cv_.notify_one();
+}
+
+void ReplayWriter::write_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty() && stop_) break;
+
+        // Drain everything queued so far without holding the lock during I/O
+        std::deque<Chunk> batch;
+        batch.swap(queue_);
+        lock.unlock();
+
+        for (const auto& chunk : batch) {
+            write_chunk(chunk);
+        }
+
+        lock.lock();
+    }
+}
+
+void ReplayWriter::write_chunk(const Chunk& chunk) {
+    int fd;
+    auto it = open_fds_.find(chunk.path);
+    if (it != open_fds_.end()) {
+        fd = it->second;
+    } else {
+        // Never appends to a file already there (a previous run's, say)
+        fd = open(chunk.path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("replay", "open failed").field("path", chunk.path).field("error", strerror(errno));
+        }
+        open_fds_[chunk.path] = fd;
+    }
+    if (fd < 0) {
+        if (chunk.last) open_fds_.erase(chunk.path);
+        return;
+    }
+
+    const uint8_t* p = chunk.bytes.data();
+    size_t left = chunk.bytes.size();
+    while (left > 0) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("replay", "write failed").field("path", chunk.path).field("error", strerror(errno));
+            break;
+        }
+        p += n;
+        left -= n;
+    }
+
+    if (chunk.last) {
+        close(fd);
+        open_fds_.erase(chunk.path);
+    }
+}
+
+// -------------------------------------------
+// ReplayRecorder
+// -------------------------------------------
+void ReplayRecorder::begin(ReplayWriter* writer, const std::string& room_id,
+                           int64_t server_start_ms, int duration_ms, const std::string& paragraph,
+                           const std::vector<ReplayPlayerInfo>& players) {
+    if (active()) end();
+    if (!writer || !writer->enabled()) return;
+
+    writer_ = writer;
+    path_ = writer->path_for(room_id, players.empty() ? 0 : players.front().client_id);
+    for (int i = 0; i < replay::kMaxSlots; i++) {
+        last_time_ms_[i] = server_start_ms;
+    }
+
+    buf_.assign(replay::kMagic, replay::kMagic + 4);
+    buf_.push_back(replay::kVersion);
+    replay::put_string(buf_, room_id);
+    replay::put_varint(buf_, static_cast<uint64_t>(server_start_ms));
+    replay::put_varint(buf_, static_cast<uint64_t>(duration_ms));
+    replay::put_string(buf_, paragraph);
+    buf_.push_back(static_cast<uint8_t>(players.size()));
+    for (const auto& p : players) {
+        buf_.push_back(static_cast<uint8_t>(p.slot_idx));
+        replay::put_varint(buf_, static_cast<uint64_t>(p.client_id));
+        replay::put_string(buf_, p.display_name);
+    }
+    flush();
+}
+
+void ReplayRecorder::put_event(int slot_idx, uint8_t code, int64_t time_ms) {
+    if (slot_idx < 0 || slot_idx >= replay::kMaxSlots) return;
+    buf_.push_back(static_cast<uint8_t>(slot_idx));
+    buf_.push_back(code);
+    replay::put_varint(buf_, replay::zigzag(time_ms - last_time_ms_[slot_idx]));
+    last_time_ms_[slot_idx] = time_ms;
+}
+
+void ReplayRecorder::on_char(int slot_idx, char c, int64_t time_ms) {
+    // Bytes below 0x20 are the control codes; a literal one would be misread
+    if (!active() || static_cast<uint8_t>(c) < replay::kFirstTypedCode) return;
+    put_event(slot_idx, static_cast<uint8_t>(c), time_ms);
+}
+
+void ReplayRecorder::on_backspace(int slot_idx, int64_t time_ms) {
+    if (!active()) return;
+    put_event(slot_idx, replay::kCodeBackspace, time_ms);
+}
+
+void ReplayRecorder::on_word(int slot_idx) {
+    if (!active() || slot_idx < 0 || slot_idx >= replay::kMaxSlots) return;
+    put_event(slot_idx, replay::kCodeWord, last_time_ms_[slot_idx]);
+}
+
+void ReplayRecorder::on_commit(int slot_idx, int word_idx, int64_t time_ms) {
+    if (!active() || slot_idx < 0 || slot_idx >= replay::kMaxSlots) return;
+    put_event(slot_idx, replay::kCodeCommit, time_ms);
+    replay::put_varint(buf_, replay::zigzag(word_idx));
+}
+
+void ReplayRecorder::flush() {
+    if (!active() || buf_.empty()) return;
+    std::vector<uint8_t> chunk;
+    chunk.swap(buf_);
+    writer_->append(path_, std::move(chunk), false);
+}
+
+void ReplayRecorder::end() {
+    if (!active()) return;
+    buf_.push_back(replay::kSlotEnd);
+    std::vector<uint8_t> chunk;
+    chunk.swap(buf_);
+    writer_->append(path_, std::move(chunk), true);
+    writer_ = nullptr;
+    path_.clear();
+}
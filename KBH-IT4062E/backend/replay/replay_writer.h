@@ -0,0 +1,94 @@
+#ifndef REPLAY_WRITER_H
+#define REPLAY_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "replay_format.h"
+
+struct ReplayPlayerInfo {
+    int slot_idx = 0;
+    int client_id = 0;
+    std::string display_name;
+};
+
+// Appends encoded replay chunks to disk on a background thread.
+// An empty directory disables recording.
+class ReplayWriter {
+public:
+    explicit ReplayWriter(const std::string& dir);
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    bool enabled() const { return !dir_.empty(); }
+
+    // New file path for a game: room id, the client_id of its first player
+    // (the only one in training), start time and a sequence number, so two
+    // games starting in the same millisecond never share a file
+    std::string path_for(const std::string& room_id, int client_id);
+
+    // Queue bytes for `path`; `last` closes the file after writing
+    void append(const std::string& path, std::vector<uint8_t> bytes, bool last);
+
+private:
+    struct Chunk {
+        std::string path;
+        std::vector<uint8_t> bytes;
+        bool last = false;
+    };
+
+    void write_loop();
+    void write_chunk(const Chunk& chunk);
+
+    std::string dir_;
+    std::atomic<uint64_t> next_seq_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Chunk> queue_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    // Only touched by the writer thread; -1 for a file that could not be
+    // created (its chunks are dropped until the last one)
+    std::unordered_map<std::string, int> open_fds_;
+};
+
+// Encodes one game's keystrokes into replay records. Owned by whoever runs
+// the game (Room, training session); bytes go to the writer once per input.
+class ReplayRecorder {
+public:
+    void begin(ReplayWriter* writer, const std::string& room_id,
+               int64_t server_start_ms, int duration_ms, const std::string& paragraph,
+               const std::vector<ReplayPlayerInfo>& players);
+    bool active() const { return writer_ != nullptr; }
+
+    void on_char(int slot_idx, char c, int64_t time_ms);
+    void on_backspace(int slot_idx, int64_t time_ms);
+    void on_word(int slot_idx);
+    void on_commit(int slot_idx, int word_idx, int64_t time_ms);
+
+    // Hand buffered records to the writer
+    void flush();
+
+    // Write the end marker and stop recording
+    void end();
+
+private:
+    void put_event(int slot_idx, uint8_t code, int64_t time_ms);
+
+    ReplayWriter* writer_ = nullptr;
+    std::string path_;
+    std::vector<uint8_t> buf_;
+    int64_t last_time_ms_[replay::kMaxSlots] = {};
+};
+
+#endif
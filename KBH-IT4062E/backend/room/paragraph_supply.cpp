@@ -0,0 +1,51 @@
+#include "paragraph_supply.h"
+#include <chrono>
+
+ParagraphSupply::ParagraphSupply(Database* db, ParagraphCache& cache, size_t depth)
+    : db_(db), cache_(cache), depth_(depth)
+{
+    if (db_) {
+        fetch_thread_ = std::thread(&ParagraphSupply::fetch_loop, this);
+    }
+}
+
+ParagraphSupply::~ParagraphSupply() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (fetch_thread_.joinable()) {
+        fetch_thread_.join();
+    }
+}
+
+std::shared_ptr<const Paragraph> ParagraphSupply::try_take() {
+    std::shared_ptr<const Paragraph> paragraph;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_.empty()) return nullptr;
+        paragraph = std::move(ready_.front());
+        ready_.pop_front();
+    }
+    cv_.notify_one();
+    return paragraph;
+}
+
+void ParagraphSupply::fetch_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        cv_.wait(lock, [this] { return stop_ || ready_.size() < depth_; });
+        if (stop_) break;
+
+        lock.unlock();
+        std::shared_ptr<const Paragraph> paragraph = cache_.get(db_->get_random_paragraph("en"));
+        lock.lock();
+
+        if (paragraph->text().empty()) {
+            cv_.wait_for(lock, std::chrono::milliseconds(kRetryMs), [this] { return stop_; });
+            continue;
+        }
+        ready_.push_back(std::move(paragraph));
+    }
+}
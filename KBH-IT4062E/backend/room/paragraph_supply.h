@@ -0,0 +1,43 @@
+#ifndef PARAGRAPH_SUPPLY_H
+#define PARAGRAPH_SUPPLY_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../database/database.h"
+#include "../typing_engine/paragraph.h"
+
+// Keeps a few corpus paragraphs fetched ahead on one worker thread, so the
+// next room or survival stage gets its text without waiting on the DB.
+// The worker is joined by the destructor, so it never outlives db or cache.
+class ParagraphSupply {
+public:
+    ParagraphSupply(Database* db, ParagraphCache& cache, size_t depth = 8);
+    ~ParagraphSupply();
+
+    ParagraphSupply(const ParagraphSupply&) = delete;
+    ParagraphSupply& operator=(const ParagraphSupply&) = delete;
+
+    // A fetched paragraph, or nullptr if none is ready yet; never blocks
+    std::shared_ptr<const Paragraph> try_take();
+
+private:
+    void fetch_loop();
+
+    Database* db_;
+    ParagraphCache& cache_;
+    size_t depth_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<const Paragraph>> ready_;
+    bool stop_ = false;
+    std::thread fetch_thread_;
+
+    static constexpr int kRetryMs = 1000;   // after a failed query
+};
+
+#endif
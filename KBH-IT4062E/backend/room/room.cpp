@@ -1,29 +1,114 @@
 #include "room.h"
 #include <algorithm>
-#include <iostream>
-#include <sstream>
-#include <unordered_map>
 
-Room::Room(const std::string& id, Database* db)
-    : id_(id), db_(db)
-{
-    // Get random paragraph
-    if (db_) {
-        paragraph_ = db_->get_random_paragraph("en");
-    } else {
-        paragraph_ = "The quick brown fox jumps over the lazy dog";
+// -------------------------------------------
+// LivePlayer
+// -------------------------------------------
+void LivePlayer::start(const std::vector<std::string_view>* words, int64_t start_time_ms) {
+    scorer.reset(words, start_time_ms);
+    keystrokes = KeystrokeStats{};
+    events_applied = 0;
+    recorder.start_word(&keystrokes, scorer.target());
+}
+
+void LivePlayer::begin_word(int word_idx, ReplayRecorder& replay, int slot_idx) {
+    replay.on_word(slot_idx);
+    scorer.begin_word(word_idx);
+    recorder.start_word(&keystrokes, scorer.target());
+}
+
+void LivePlayer::apply_event(const Json::Value& event, ReplayRecorder& replay, int slot_idx) {
+    // Client input: anything malformed is skipped, the as*() calls throw
+    if (!event.isObject() || !event["type"].isString()) {
+        return;
     }
+    if (event["time_ms"].isInt64()) {
+        scorer.set_time(event["time_ms"].asInt64());
+    }
+    int64_t t = scorer.latest_time_ms();
+    events_applied++;
     
-    // Count words
-    std::istringstream iss(paragraph_);
-    std::string word;
-    while (iss >> word) {
-        paragraph_words_.push_back(word);
-        total_words_++;
+    std::string event_type = event["type"].asString();
+    if (event_type == "char") {
+        const Json::Value& char_value = event["char"];
+        std::string ch = char_value.isString() ? char_value.asString() : std::string();
+        // Control bytes are never part of a paragraph, and the replay
+        // format uses them as record codes
+        if (!ch.empty() && static_cast<uint8_t>(ch[0]) >= replay::kFirstTypedCode) {
+            recorder.on_char(ch[0], scorer.typed_len(), t);
+            replay.on_char(slot_idx, ch[0], t);
+            scorer.on_char(ch[0]);
+        }
+    } else if (event_type == "backspace") {
+        recorder.on_backspace(t);
+        replay.on_backspace(slot_idx, t);
+        scorer.on_backspace();
+    } else if (event_type == "commit") {
+        int word_idx = event["word_idx"].isInt() ? event["word_idx"].asInt() : scorer.current_word();
+        commit(word_idx, replay, slot_idx);
     }
 }
 
-Room::~Room() {}
+void LivePlayer::commit(int word_idx, ReplayRecorder& replay, int slot_idx) {
+    replay.on_commit(slot_idx, word_idx, scorer.latest_time_ms());
+    scorer.commit(word_idx);
+    recorder.start_word(&keystrokes, scorer.target());
+}
+
+PlayerMetrics LivePlayer::metrics() const {
+    PlayerMetrics m;
+    m.word_idx = scorer.word_idx();
+    m.latest_time_ms = scorer.latest_time_ms();
+    m.progress = scorer.progress();
+    m.wpm = scorer.wpm();
+    m.accuracy = scorer.accuracy();
+    m.total_correct_chars = scorer.total_correct_chars();
+    m.total_chars_typed = scorer.total_chars_typed();
+    return m;
+}
+
+// -------------------------------------------
+// Room
+// -------------------------------------------
+Room::Room(const std::string& id, const std::string& paragraph)
+    : id_(id), paragraph_(Paragraph::make(paragraph))
+{
+}
+
+Room::~Room() {
+    replay_.end();
+}
+
+void Room::open(const std::string& id, std::shared_ptr<const Paragraph> paragraph) {
+    id_.assign(id);
+    paragraph_ = std::move(paragraph);
+}
+
+void Room::close() {
+    replay_.end();
+    for (int i = 0; i < 8; i++) {
+        slots_[i].occupied = false;
+        slots_[i].client_fd = -1;
+        slots_[i].client_id = 0;
+        slots_[i].display_name.clear();
+        slots_[i].is_ready = false;
+        slots_[i].eliminated = false;
+        live_active_[i] = false;
+    }
+    host_slot_idx_ = -1;
+    player_count_ = 0;
+    is_private_ = false;
+    match_bucket_ = -1;
+    spectators_.clear();
+    watch_pos_ = -1;
+    game_started_ = false;
+    game_start_time_ = 0;
+    game_duration_ms_ = 50000;
+    last_state_broadcast_ms_ = 0;
+    last_spectator_state_ms_ = 0;
+    replay_writer_ = nullptr;
+    paragraph_.reset();
+}
 
 bool Room::add_player(int fd, int client_id, const std::string& display_name) {
     // Find first empty slot
@@ -34,6 +119,8 @@ bool Room::add_player(int fd, int client_id, const std::string& display_name) {
             slots_[i].client_id = client_id;
             slots_[i].display_name = display_name;
             slots_[i].is_ready = false;
+            slots_[i].eliminated = false;
+            player_count_++;
             
             // If this is the first player, they become host
             if (host_slot_idx_ == -1) {
@@ -56,19 +143,21 @@ void Room::remove_player(int fd) {
     slots_[slot_idx].client_id = 0;
     slots_[slot_idx].display_name.clear();
     slots_[slot_idx].is_ready = false;
+    slots_[slot_idx].eliminated = false;
+    player_count_--;
     
-    player_metrics_.erase(fd);
+    live_active_[slot_idx] = false;
     
     // Recalculate host if needed
     recalculate_host();
 }
 
-int Room::player_count() const {
-    int count = 0;
-    for (int i = 0; i < 8; i++) {
-        if (slots_[i].occupied) count++;
+void Room::remove_spectator(int fd) {
+    auto it = std::find(spectators_.begin(), spectators_.end(), fd);
+    if (it != spectators_.end()) {
+        *it = spectators_.back();
+        spectators_.pop_back();
     }
-    return count;
 }
 
 bool Room::is_host(int fd) const {
@@ -107,28 +196,62 @@ void Room::update_display_name(int fd, const std::string& name) {
     }
 }
 
+void Room::rebind_fd(int from_fd, int to_fd) {
+    int slot_idx = find_slot_by_fd(from_fd);
+    if (slot_idx == -1) return;
+    
+    slots_[slot_idx].client_fd = to_fd;
+}
+
 void Room::start_game(int64_t start_time, int duration) {
     game_started_ = true;
     game_start_time_ = start_time;
     game_duration_ms_ = duration;
+    last_state_broadcast_ms_ = 0;
     
     // Initialize metrics for all players
     for (int i = 0; i < 8; i++) {
-        if (slots_[i].occupied) {
-            player_metrics_[slots_[i].client_fd] = PlayerMetrics{};
+        live_active_[i] = false;
+        if (slots_[i].occupied && !slots_[i].eliminated) {
+            live_player(i);
         }
     }
+    
+    if (replay_writer_) {
+        std::vector<ReplayPlayerInfo> players;
+        for (int i = 0; i < 8; i++) {
+            if (slots_[i].occupied && !slots_[i].eliminated) {
+                players.push_back({i, slots_[i].client_id, slots_[i].display_name});
+            }
+        }
+        replay_.begin(replay_writer_, id_, start_time, duration, paragraph_->text(), players);
+    }
 }
 
 void Room::end_game() {
     game_started_ = false;
+    replay_.end();
     
     // Unready all players
     for (int i = 0; i < 8; i++) {
         slots_[i].is_ready = false;
+        slots_[i].eliminated = false;
     }
 }
 
+void Room::eliminate(int slot_idx) {
+    slots_[slot_idx].eliminated = true;
+    live_active_[slot_idx] = false;
+}
+
+int Room::alive_count() const {
+    int count = 0;
+    for (int i = 0; i < 8; i++) {
+        if (slots_[i].occupied && !slots_[i].eliminated) count++;
+    }
+    return count;
+}
+
 bool Room::is_game_ended(int64_t current_time) const {
     if (!game_started_) return false;
     
@@ -142,92 +265,70 @@ bool Room::is_game_ended(int64_t current_time) const {
 }
 
 void Room::process_input(int fd, int word_idx, const Json::Value& char_events) {
-    auto& metrics = player_metrics_[fd];
-    
-    // Update word_idx
-    if (word_idx >= metrics.word_idx) {
-        metrics.word_idx = word_idx + 1; // Next word index
-    }
-    
-    // Get the target word for accuracy calculation
-    std::string target_word = "";
-    if (word_idx >= 0 && word_idx < (int)paragraph_words_.size()) {
-        target_word = paragraph_words_[word_idx];
-    }
-    
-    // Calculate metrics from char_events
-    int correct_chars = 0;
-    int total_chars = 0;
-    std::string typed_word = "";
+    int slot = find_slot_by_fd(fd);
+    if (slot == -1 || slots_[slot].eliminated) return;
+    LivePlayer& player = live_player(slot);
+    int slot_idx = replay_.active() ? slot : -1;
     
+    // The message carries the whole word, so start it from scratch
+    player.begin_word(word_idx, replay_, slot_idx);
     for (const auto& event : char_events) {
-        std::string event_type = event["type"].asString();
-        
-        if (event_type == "char") {
-            std::string ch = event["char"].asString();
-            if (!ch.empty()) {
-                typed_word += ch[0];
-                total_chars++;
-            }
-        } else if (event_type == "backspace") {
-            if (!typed_word.empty()) {
-                typed_word.pop_back();
-            }
-        }
-        
-        if (event.isMember("time_ms")) {
-            metrics.latest_time_ms = event["time_ms"].asInt64();
-        }
-    }
-    
-    // Calculate correct chars by comparing typed_word with target_word
-    size_t min_len = std::min(typed_word.length(), target_word.length());
-    for (size_t i = 0; i < min_len; i++) {
-        if (typed_word[i] == target_word[i]) {
-            correct_chars++;
-        }
-    }
-    // If lengths don't match, remaining chars are wrong
-    // correct_chars already counted for matching portion
-    
-    // Update cumulative stats
-    metrics.total_correct_chars += correct_chars;
-    metrics.total_chars_typed += total_chars;
-    
-    // Calculate progress
-    metrics.progress = (double)metrics.word_idx / total_words_;
-    
-    // Calculate WPM (based on total correct chars typed so far)
-    if (metrics.latest_time_ms > game_start_time_) {
-        double elapsed_ms = metrics.latest_time_ms - game_start_time_;
-        double elapsed_minutes = elapsed_ms / 60000.0;
-        if (elapsed_minutes > 0) {
-            // WPM = (total correct chars / 5) / elapsed_minutes
-            metrics.wpm = (metrics.total_correct_chars / 5.0) / elapsed_minutes;
-        }
+        player.apply_event(event, replay_, slot_idx);
     }
+    player.commit(word_idx, replay_, slot_idx);
+    replay_.flush();
+}
+
+void Room::process_input_batch(int fd, const Json::Value& events) {
+    int slot = find_slot_by_fd(fd);
+    if (slot == -1 || slots_[slot].eliminated) return;
+    LivePlayer& player = live_player(slot);
+    int slot_idx = replay_.active() ? slot : -1;
     
-    // Calculate accuracy (cumulative)
-    if (metrics.total_chars_typed > 0) {
-        metrics.accuracy = (metrics.total_correct_chars * 100.0) / metrics.total_chars_typed;
-    } else {
-        metrics.accuracy = 100.0;
+    // Continues the buffered word of the previous batch
+    for (const auto& event : events) {
+        player.apply_event(event, replay_, slot_idx);
     }
+    replay_.flush();
 }
 
 PlayerMetrics Room::get_player_metrics(int fd) const {
-    auto it = player_metrics_.find(fd);
-    if (it != player_metrics_.end()) {
-        return it->second;
+    int slot_idx = find_slot_by_fd(fd);
+    if (slot_idx != -1 && live_active_[slot_idx]) {
+        return live_[slot_idx].metrics();
     }
     return PlayerMetrics{};
 }
 
+const LivePlayer* Room::get_live_player(int fd) const {
+    int slot_idx = find_slot_by_fd(fd);
+    if (slot_idx != -1 && live_active_[slot_idx]) {
+        return &live_[slot_idx];
+    }
+    return nullptr;
+}
+
+const KeystrokeStats* Room::get_keystroke_stats(int fd) const {
+    int slot_idx = find_slot_by_fd(fd);
+    if (slot_idx != -1 && live_active_[slot_idx]) {
+        return &live_[slot_idx].keystrokes;
+    }
+    return nullptr;
+}
+
+LivePlayer& Room::live_player(int slot_idx) {
+    // Started lazily for someone who was not seated at start_game
+    if (!live_active_[slot_idx]) {
+        live_[slot_idx].start(&paragraph_->words(), game_start_time_);
+        live_active_[slot_idx] = true;
+    }
+    return live_[slot_idx];
+}
+
 bool Room::all_finished() const {
     for (int i = 0; i < 8; i++) {
-        if (slots_[i].occupied) {
-            auto it = player_metrics_.find(slots_[i].client_fd);
-            if (it == player_metrics_.end() || it->second.word_idx < total_words_) {
+        if (slots_[i].occupied && !slots_[i].eliminated) {
+            if (!live_active_[i] || live_[i].scorer.word_idx() < total_words()) {
                 return false;
             }
         }
@@ -239,7 +340,7 @@ std::vector<RankingEntry> Room::get_rankings() const {
     std::vector<RankingEntry> rankings;
     
     for (int i = 0; i < 8; i++) {
-        if (slots_[i].occupied) {
+        if (slots_[i].occupied && !slots_[i].eliminated) {
             RankingEntry entry;
             entry.slot_idx = i;
             entry.client_id = slots_[i].client_id;
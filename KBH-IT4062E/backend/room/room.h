@@ -1,10 +1,15 @@
 #ifndef ROOM_H
 #define ROOM_H
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <jsoncpp/json/json.h>
-#include "../database/database.h"
+#include "../typing_engine/keystroke_scorer.h"
+#include "../typing_engine/paragraph.h"
+#include "../analytics/keystroke_analytics.h"
+#include "../replay/replay_writer.h"
 
 struct RoomSlot {
     bool occupied = false;
@@ -12,6 +17,7 @@ struct RoomSlot {
     int client_id = 0;
     std::string display_name;
     bool is_ready = false;
+    bool eliminated = false;  // survival: out of the game, still seated
 };
 
 struct PlayerMetrics {
@@ -26,6 +32,29 @@ struct PlayerMetrics {
     int total_chars_typed = 0;
 };
 
+// One typist's live state: O(1) scoring plus keystroke analytics.
+// Shared by arena rooms and training sessions.
+struct LivePlayer {
+    KeystrokeScorer scorer;
+    KeystrokeStats keystrokes;
+    WordKeystrokeRecorder recorder;
+    int events_applied = 0;  // streamed events this game; a resuming client re-sends the rest
+
+    // Call once the LivePlayer sits at its final address (the recorder
+    // points into it)
+    void start(const std::vector<std::string_view>* words, int64_t start_time_ms);
+
+    // Per-word input: restart the buffered word at word_idx
+    void begin_word(int word_idx, ReplayRecorder& replay, int slot_idx);
+
+    // Applies one event: {"type": "char"|"backspace"|"commit", "char",
+    // "word_idx", "time_ms"}. slot_idx is the replay slot (-1 = none).
+    void apply_event(const Json::Value& event, ReplayRecorder& replay, int slot_idx);
+    void commit(int word_idx, ReplayRecorder& replay, int slot_idx);
+
+    PlayerMetrics metrics() const;
+};
+
 struct RankingEntry {
     int rank = 0;
     int slot_idx = 0;
@@ -39,16 +68,31 @@ struct RankingEntry {
 
 class Room {
 public:
-    Room(const std::string& id, Database* db);
+    Room() = default;                                           // pooled, see open()
+    Room(const std::string& id, const std::string& paragraph);  // fixed text (replays)
     ~Room();
 
+    Room(const Room&) = delete;
+    Room& operator=(const Room&) = delete;
+
+    // Pool lifecycle (RoomPool): open() gives a recycled room a new id and
+    // paragraph, close() returns it to the empty state. Buffers are kept.
+    void open(const std::string& id, std::shared_ptr<const Paragraph> paragraph);
+    void close();
+
     const std::string& id() const { return id_; }
     
     // Slot management (8 fixed slots)
     bool add_player(int fd, int client_id, const std::string& display_name);
     void remove_player(int fd);
     const RoomSlot& get_slot(int idx) const { return slots_[idx]; }
-    int player_count() const;
+    int player_count() const { return player_count_; }
+    int open_slots() const { return 8 - player_count_; }
+    
+    // Spectators: unbounded, never part of slots_ or rankings
+    void add_spectator(int fd) { spectators_.push_back(fd); }
+    void remove_spectator(int fd);
+    const std::vector<int>& spectators() const { return spectators_; }
     
     // Host management
     int host_slot_idx() const { return host_slot_idx_; }
@@ -66,6 +110,12 @@ public:
     // Display name update
     void update_display_name(int fd, const std::string& name);
     
+    // Session resume: the seat and its metrics move to another fd
+    void rebind_fd(int from_fd, int to_fd);
+    
+    // Live scoring of a seated player (nullptr before their first input)
+    const LivePlayer* get_live_player(int fd) const;
+    
     // Game management
     void start_game(int64_t start_time, int duration);
     void end_game();
@@ -74,37 +124,71 @@ public:
     int64_t game_start_time() const { return game_start_time_; }
     int game_duration() const { return game_duration_ms_; }
     
-    // Paragraph
-    const std::string& paragraph() const { return paragraph_; }
-    int total_words() const { return total_words_; }
+    // Survival: the slot stops playing until end_game
+    void eliminate(int slot_idx);
+    int alive_count() const;
+    
+    // Paragraph (shared, immutable); replaced between survival stages
+    const Paragraph& paragraph() const { return *paragraph_; }
+    void set_paragraph(std::shared_ptr<const Paragraph> paragraph) { paragraph_ = std::move(paragraph); }
+    int total_words() const { return paragraph_->total_words(); }
     
-    // Input processing
+    // Input processing: one committed word (`input`) or a streamed batch
+    // of char/backspace/commit events (`input_batch`)
     void process_input(int fd, int word_idx, const Json::Value& char_events);
+    void process_input_batch(int fd, const Json::Value& events);
     PlayerMetrics get_player_metrics(int fd) const;
     bool all_finished() const;
     std::vector<RankingEntry> get_rankings() const;
+    
+    // Keystroke analytics collected during the current game (nullptr if none)
+    const KeystrokeStats* get_keystroke_stats(int fd) const;
+    
+    // game_state broadcast throttling for streamed input
+    int64_t last_state_broadcast_ms() const { return last_state_broadcast_ms_; }
+    void set_last_state_broadcast_ms(int64_t t) { last_state_broadcast_ms_ = t; }
+    int64_t last_spectator_state_ms() const { return last_spectator_state_ms_; }
+    void set_last_spectator_state_ms(int64_t t) { last_spectator_state_ms_ = t; }
+    
+    // Replay recording (nullptr disables)
+    void set_replay_writer(ReplayWriter* writer) { replay_writer_ = writer; }
 
 private:
     void recalculate_host();
     int find_slot_by_fd(int fd) const;
+    LivePlayer& live_player(int slot_idx);
     
     std::string id_;
     RoomSlot slots_[8];
     int host_slot_idx_ = -1;
+    int player_count_ = 0;
     bool is_private_ = false;
     
+    std::vector<int> spectators_;
+    
+    // Position in RoomManager's matchmaking index (-1 = not listed) and
+    // in its list of watched rooms (-1 = no spectators)
+    friend class RoomManager;
+    int match_bucket_ = -1;
+    size_t match_pos_ = 0;
+    int watch_pos_ = -1;
+    
     // Game state
     bool game_started_ = false;
     int64_t game_start_time_ = 0;
     int game_duration_ms_ = 50000;
+    int64_t last_state_broadcast_ms_ = 0;
+    int64_t last_spectator_state_ms_ = 0;
+    
+    std::shared_ptr<const Paragraph> paragraph_;
     
-    // Paragraph
-    std::string paragraph_;
-    int total_words_ = 0;    std::vector<std::string> paragraph_words_;    
-    // Player metrics
-    std::unordered_map<int, PlayerMetrics> player_metrics_;
+    // Per-slot scoring and analytics, reused across games
+    LivePlayer live_[8];
+    bool live_active_[8] = {};
     
-    Database* db_;
+    // Replay recording
+    ReplayWriter* replay_writer_ = nullptr;
+    ReplayRecorder replay_;
 };
 
 #endif
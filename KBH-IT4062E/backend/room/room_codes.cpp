@@ -0,0 +1,139 @@
+#include "room_codes.h"
+#include <random>
+
+namespace {
+
+constexpr int kHalfBits = 15;
+constexpr uint32_t kHalfMask = (1u << kHalfBits) - 1;
+constexpr uint32_t kCodeSpace = 1u << (2 * kHalfBits);
+
+const char kAlphabet[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+int char_value(char c) {
+    if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+    if (c == 'O') return 0;
+    if (c == 'I' || c == 'L') return 1;
+    for (int i = 0; i < 32; i++) {
+        if (kAlphabet[i] == c) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+RoomCodeTable::RoomCodeTable(size_t max_rooms)
+    : max_rooms_(max_rooms)
+{
+    // Load factor <= 1/2
+    size_t capacity = 16;
+    while (capacity < max_rooms * 2) capacity <<= 1;
+    table_.resize(capacity);
+    mask_ = capacity - 1;
+
+    std::random_device rd;
+    for (auto& key : keys_) {
+        key = (uint64_t(rd()) << 32) | rd();
+    }
+}
+
+uint32_t RoomCodeTable::permute(uint32_t n) const {
+    uint32_t left = (n >> kHalfBits) & kHalfMask;
+    uint32_t right = n & kHalfMask;
+    for (uint64_t key : keys_) {
+        uint32_t next = left ^ (uint32_t(mix64(right ^ key)) & kHalfMask);
+        left = right;
+        right = next;
+    }
+    return (left << kHalfBits) | right;
+}
+
+size_t RoomCodeTable::slot_of(uint32_t code) const {
+    // Codes are already well spread; the multiply keeps low bits honest
+    return (size_t)((code * 0x9E3779B1u) >> 2) & mask_;
+}
+
+bool RoomCodeTable::insert(Room* room, std::string& code_out) {
+    if (size_ >= max_rooms_) return false;
+
+    uint32_t code;
+    do {
+        code = permute(counter_);
+        counter_ = (counter_ + 1) & (kCodeSpace - 1);
+    } while (find_code(code));  // only after a wrap
+
+    size_t i = slot_of(code);
+    while (table_[i].room) {
+        i = (i + 1) & mask_;
+    }
+    table_[i].code = code;
+    table_[i].room = room;
+    size_++;
+
+    encode(code, code_out);
+    return true;
+}
+
+Room* RoomCodeTable::find(const std::string& code) const {
+    uint32_t value;
+    if (!decode(code, value)) return nullptr;
+    return find_code(value);
+}
+
+Room* RoomCodeTable::find_code(uint32_t code) const {
+    for (size_t i = slot_of(code); table_[i].room; i = (i + 1) & mask_) {
+        if (table_[i].code == code) return table_[i].room;
+    }
+    return nullptr;
+}
+
+void RoomCodeTable::erase(const std::string& code) {
+    uint32_t value;
+    if (!decode(code, value)) return;
+
+    size_t i = slot_of(value);
+    while (table_[i].room && table_[i].code != value) {
+        i = (i + 1) & mask_;
+    }
+    if (!table_[i].room) return;
+
+    // Backward-shift: pull later entries of the probe run into the hole
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask_; table_[j].room; j = (j + 1) & mask_) {
+        size_t home = slot_of(table_[j].code);
+        // Move j if its home is not in (hole, j] (cyclically)
+        if (((j - home) & mask_) >= ((j - hole) & mask_)) {
+            table_[hole] = table_[j];
+            hole = j;
+        }
+    }
+    table_[hole] = Entry{};
+    size_--;
+}
+
+bool RoomCodeTable::decode(const std::string& text, uint32_t& code) {
+    if (text.size() != (size_t)kCodeLen) return false;
+    code = 0;
+    for (char c : text) {
+        int v = char_value(c);
+        if (v < 0) return false;
+        code = (code << 5) | (uint32_t)v;
+    }
+    return true;
+}
+
+void RoomCodeTable::encode(uint32_t code, std::string& out) {
+    out.resize(kCodeLen);
+    for (int i = kCodeLen - 1; i >= 0; i--) {
+        out[i] = kAlphabet[code & 31];
+        code >>= 5;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ROOM_CODES_H
+#define ROOM_CODES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Room;
+
+// Room code allocator + lookup table.
+//
+// Codes are 6 Crockford base32 chars (30 bits). The n-th room gets a keyed
+// Feistel permutation of n, so codes never collide and cannot be guessed
+// from a neighbour's code; the keys come from std::random_device at startup.
+// Live codes sit in a fixed-capacity open-addressing table (linear probing,
+// backward-shift erase), so allocation and lookup never touch the heap.
+// A closed room's code is only handed out again after the 2^30 counter wraps.
+class RoomCodeTable {
+public:
+    static constexpr int kCodeLen = 6;
+
+    explicit RoomCodeTable(size_t max_rooms = 16384);
+
+    // Assigns a fresh code to room; false when max_rooms are live
+    bool insert(Room* room, std::string& code_out);
+    Room* find(const std::string& code) const;
+    void erase(const std::string& code);
+    size_t size() const { return size_; }
+
+    // Visits every live room, in table order
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (const Entry& entry : table_) {
+            if (entry.room) fn(entry.room);
+        }
+    }
+
+private:
+    struct Entry {
+        uint32_t code = 0;
+        Room* room = nullptr;   // nullptr = empty
+    };
+
+    uint32_t permute(uint32_t n) const;
+    size_t slot_of(uint32_t code) const;
+    Room* find_code(uint32_t code) const;
+
+    // Input is case-insensitive; I/L read as 1 and O as 0
+    static bool decode(const std::string& text, uint32_t& code);
+    static void encode(uint32_t code, std::string& out);
+
+    std::vector<Entry> table_;
+    size_t mask_;
+    size_t max_rooms_;
+    size_t size_ = 0;
+
+    uint32_t counter_ = 0;
+    uint64_t keys_[4];
+};
+
+#endif
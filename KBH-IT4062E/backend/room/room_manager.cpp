@@ -1,46 +1,56 @@
 #include "room_manager.h"
-#include <sstream>
-#include <iomanip>
 
 RoomManager::RoomManager(Database* db)
-    : db_(db) {}
+    : db_(db), supply_(db, paragraphs_),
+      repeats_(&metrics::Registry::global().counter(
+          "kbh_paragraph_repeats_total",
+          "Paragraphs served again because none had been prefetched")) {}
 
-Room* RoomManager::create_room(int fd, int client_id, const std::string& display_name) {
-    // Check if already in a room
+Room* RoomManager::create_room(int fd, int client_id, const std::string& display_name,
+                               std::shared_ptr<const Paragraph> paragraph) {
+    // Check if already in a room (taking a seat ends spectating)
     if (get_room_of_fd(fd)) {
         return nullptr;
     }
+    stop_spectating(fd);
     
-    std::string room_id = generate_room_id();
-    auto room = std::make_unique<Room>(room_id, db_);
-    Room* room_ptr = room.get();
+    Room* room_ptr = pool_.acquire();
+    std::string room_id;
+    if (!rooms_.insert(room_ptr, room_id)) {
+        pool_.release(room_ptr);
+        return nullptr; // At max_rooms
+    }
+    room_ptr->open(room_id, paragraph ? std::move(paragraph) : random_paragraph());
+    room_ptr->set_replay_writer(replay_writer_);
     
     // Add creator as first player (becomes host)
     if (!room_ptr->add_player(fd, client_id, display_name)) {
+        rooms_.erase(room_id);
+        pool_.release(room_ptr);
         return nullptr;
     }
     
-    rooms_[room_id] = std::move(room);
     fd_to_room_[fd] = room_ptr;
+    update_index(room_ptr);
     
     return room_ptr;
 }
 
 Room* RoomManager::join_room(const std::string& room_id, int fd, int client_id,
                              const std::string& display_name, std::string& err_msg) {
-    // Check if already in a room
+    // Check if already in a room (taking a seat ends spectating)
     if (get_room_of_fd(fd)) {
         err_msg = "ALREADY_IN_ROOM";
         return nullptr;
     }
+    stop_spectating(fd);
     
-    auto it = rooms_.find(room_id);
-    if (it == rooms_.end()) {
+    Room* room = rooms_.find(room_id);
+    if (!room) {
         err_msg = "ROOM_NOT_FOUND";
         return nullptr;
     }
-    
-    Room* room = it->second.get();
+
     
     // Try to add player
     if (!room->add_player(fd, client_id, display_name)) {
@@ -49,39 +59,127 @@ Room* RoomManager::join_room(const std::string& room_id, int fd, int client_id,
     }
     
     fd_to_room_[fd] = room;
+    update_index(room);
     err_msg.clear();
     return room;
 }
 
 Room* RoomManager::join_random(int fd, int client_id, const std::string& display_name) {
-    // Check if already in a room
+    // Check if already in a room (taking a seat ends spectating)
     if (get_room_of_fd(fd)) {
         return nullptr;
     }
+    stop_spectating(fd);
     
-    // Find a public room that is not full
-    for (auto& pair : rooms_) {
-        Room* room = pair.second.get();
-        if (!room->is_private() && room->player_count() < 8) {
-            if (room->add_player(fd, client_id, display_name)) {
-                fd_to_room_[fd] = room;
-                return room;
-            }
+    // Fullest public waiting room first: lowest non-empty open-slot bucket
+    for (int open = 1; open < 8; open++) {
+        if (open_rooms_[open].empty()) continue;
+        
+        Room* room = open_rooms_[open].back();
+        if (!room->add_player(fd, client_id, display_name)) {
+            return nullptr;
         }
+        fd_to_room_[fd] = room;
+        update_index(room);
+        return room;
     }
     
     return nullptr;
 }
 
+std::shared_ptr<const Paragraph> RoomManager::random_paragraph() {
+    if (!db_) {
+        return paragraphs_.get("The quick brown fox jumps over the lazy dog");
+    }
+    
+    // Callers hold the server's state lock: take one fetched ahead, or
+    // reuse a recent text while the supply catches up. Only before the
+    // first fetch has ever answered does this wait on the DB.
+    std::shared_ptr<const Paragraph> paragraph = supply_.try_take();
+    if (!paragraph && recent_count_ > 0) {
+        repeats_->inc();
+        recent_pick_ %= recent_count_;
+        return recent_[recent_pick_++];
+    }
+    if (!paragraph) {
+        paragraph = paragraphs_.get(db_->get_random_paragraph("en"));
+        if (paragraph->text().empty()) return paragraph;
+    }
+    recent_[recent_next_] = paragraph;
+    recent_next_ = (recent_next_ + 1) % recent_.size();
+    if (recent_count_ < recent_.size()) ++recent_count_;
+    return paragraph;
+}
+
 Room* RoomManager::get_room_of_fd(int fd) const {
     auto it = fd_to_room_.find(fd);
     if (it == fd_to_room_.end()) return nullptr;
     return it->second;
 }
 
+void RoomManager::rebind_fd(int from_fd, int to_fd) {
+    auto it = fd_to_room_.find(from_fd);
+    if (it == fd_to_room_.end()) return;
+    
+    Room* room = it->second;
+    fd_to_room_.erase(it);
+    fd_to_room_[to_fd] = room;
+    room->rebind_fd(from_fd, to_fd);
+}
+
+Room* RoomManager::spectate(const std::string& room_id, int fd, std::string& err_msg) {
+    if (get_room_of_fd(fd)) {
+        err_msg = "ALREADY_IN_ROOM";
+        return nullptr;
+    }
+    stop_spectating(fd);  // switching rooms
+    
+    Room* room = rooms_.find(room_id);
+    if (!room) {
+        err_msg = "ROOM_NOT_FOUND";
+        return nullptr;
+    }
+    
+    room->add_spectator(fd);
+    fd_to_spectated_[fd] = room;
+    if (room->watch_pos_ < 0) {
+        room->watch_pos_ = (int)watched_rooms_.size();
+        watched_rooms_.push_back(room);
+    }
+    err_msg.clear();
+    return room;
+}
+
+Room* RoomManager::get_spectated_room(int fd) const {
+    auto it = fd_to_spectated_.find(fd);
+    if (it == fd_to_spectated_.end()) return nullptr;
+    return it->second;
+}
+
+void RoomManager::stop_spectating(int fd) {
+    auto it = fd_to_spectated_.find(fd);
+    if (it == fd_to_spectated_.end()) return;
+    
+    Room* room = it->second;
+    fd_to_spectated_.erase(it);
+    room->remove_spectator(fd);
+    if (room->spectators().empty()) {
+        unwatch(room);
+    }
+}
+
+std::vector<int> RoomManager::take_orphaned_spectators() {
+    std::vector<int> fds;
+    fds.swap(orphaned_spectators_);
+    return fds;
+}
+
 Room* RoomManager::remove_fd(int fd) {
     auto it = fd_to_room_.find(fd);
-    if (it == fd_to_room_.end()) return nullptr;
+    if (it == fd_to_room_.end()) {
+        stop_spectating(fd);
+        return nullptr;
+    }
 
     Room* room = it->second;
     fd_to_room_.erase(it);
@@ -90,20 +188,68 @@ Room* RoomManager::remove_fd(int fd) {
 
     // Delete room if empty
     if (room->player_count() == 0) {
+        unlist(room);
+        for (int watcher : room->spectators()) {
+            fd_to_spectated_.erase(watcher);
+            orphaned_spectators_.push_back(watcher);
+        }
+        unwatch(room);
         rooms_.erase(room->id());
-        return nullptr; // Room deleted
+        pool_.release(room);
+        return nullptr; // Room recycled
     }
     
+    update_index(room);
     return room; // Room still has players
 }
 
-std::string RoomManager::generate_room_id() {
-    // Generate simple alphanumeric ID like "1A2B3C"
-    std::ostringstream oss;
-    int num = room_counter_++;
+void RoomManager::set_private(Room* room, bool is_private) {
+    room->set_private(is_private);
+    update_index(room);
+}
+
+void RoomManager::start_game(Room* room, int64_t start_time, int duration) {
+    room->start_game(start_time, duration);
+    update_index(room);
+}
+
+void RoomManager::end_game(Room* room) {
+    room->end_game();
+    update_index(room);
+}
+
+void RoomManager::update_index(Room* room) {
+    int bucket = -1;
+    if (!room->is_private() && !room->is_game_started() && room->open_slots() > 0) {
+        bucket = room->open_slots();
+    }
+    if (bucket == room->match_bucket_) return;
     
-    // Simple format: uppercase hex
-    oss << std::uppercase << std::hex << std::setw(6) << std::setfill('0') << num;
+    unlist(room);
+    if (bucket >= 0) {
+        room->match_bucket_ = bucket;
+        room->match_pos_ = open_rooms_[bucket].size();
+        open_rooms_[bucket].push_back(room);
+    }
+}
+
+void RoomManager::unlist(Room* room) {
+    if (room->match_bucket_ < 0) return;
+    
+    auto& list = open_rooms_[room->match_bucket_];
+    Room* last = list.back();
+    list[room->match_pos_] = last;
+    last->match_pos_ = room->match_pos_;
+    list.pop_back();
+    room->match_bucket_ = -1;
+}
+
+void RoomManager::unwatch(Room* room) {
+    if (room->watch_pos_ < 0) return;
     
-    return oss.str();
+    Room* last = watched_rooms_.back();
+    watched_rooms_[room->watch_pos_] = last;
+    last->watch_pos_ = room->watch_pos_;
+    watched_rooms_.pop_back();
+    room->watch_pos_ = -1;
 }
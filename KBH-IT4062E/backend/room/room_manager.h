@@ -1,17 +1,30 @@
 #ifndef ROOM_MANAGER_H
 #define ROOM_MANAGER_H
 
+#include <array>
 #include <string>
 #include <unordered_map>
-#include <memory>
+#include <vector>
+#include "../database/database.h"
+#include "../metrics/metrics.h"
+#include "paragraph_supply.h"
 #include "room.h"
+#include "room_codes.h"
+#include "room_pool.h"
 
 class RoomManager {
 public:
     explicit RoomManager(Database* db);
 
-    // Create new room
-    Room* create_room(int fd, int client_id, const std::string& display_name);
+    // Create new room (random paragraph unless one is given)
+    Room* create_room(int fd, int client_id, const std::string& display_name,
+                      std::shared_ptr<const Paragraph> paragraph = nullptr);
+    
+    // Room by code, nullptr once it has closed
+    Room* find_room(const std::string& room_id) const { return rooms_.find(room_id); }
+    size_t room_count() const { return rooms_.size(); }
+    template <typename Fn>
+    void for_each_room(Fn fn) const { rooms_.for_each(fn); }
     
     // Join existing room by ID
     Room* join_room(const std::string& room_id, int fd, int client_id, 
@@ -20,24 +33,72 @@ public:
     // Join random public room
     Room* join_random(int fd, int client_id, const std::string& display_name);
     
-    // Get room by fd
+    // Get room by fd (players only; see get_spectated_room)
     Room* get_room_of_fd(int fd) const;
     
-    // Remove fd from room
+    // Spectators watch a room without taking a slot
+    Room* spectate(const std::string& room_id, int fd, std::string& err_msg);
+    Room* get_spectated_room(int fd) const;
+    void stop_spectating(int fd);
+    const std::vector<Room*>& watched_rooms() const { return watched_rooms_; }
+    
+    // Spectators of rooms closed since the last call (their room is gone)
+    std::vector<int> take_orphaned_spectators();
+    
+    // Room state changes that affect join_random go through here so the
+    // matchmaking index stays current
+    void set_private(Room* room, bool is_private);
+    void start_game(Room* room, int64_t start_time, int duration);
+    void end_game(Room* room);
+    
+    // Moves a player's seat to another fd (parked / resumed sessions)
+    void rebind_fd(int from_fd, int to_fd);
+    
+    // Remove fd from room (as a player or a spectator)
     // Returns the Room* if room still has players (for broadcasting),
-    // or nullptr if room was deleted (empty)
+    // or nullptr if room was deleted (empty) or fd was only watching
     Room* remove_fd(int fd);
     
     // Getter for database (used by Server for authentication)
     Database* db() const { return db_; }
+    
+    // Random corpus paragraph, shared with every room / training session
+    // currently typing the same text (empty text if the DB query failed).
+    // Served from the prefetched ones, so it does not wait on the DB; while
+    // the supply is empty it cycles through the last few texts served.
+    std::shared_ptr<const Paragraph> random_paragraph();
+    
+    // One fetched ahead of time, nullptr if none has arrived yet (no DB wait)
+    std::shared_ptr<const Paragraph> prefetched_paragraph() { return supply_.try_take(); }
+    
+    // Rooms created after this call record replays through `writer`
+    void set_replay_writer(ReplayWriter* writer) { replay_writer_ = writer; }
 
 private:
-    std::string generate_room_id();
+    // Matchmaking index: open_rooms_[k] lists public, not-started rooms
+    // with exactly k free slots. Rooms know their position, so moving one
+    // between buckets is a swap-remove plus push_back.
+    void update_index(Room* room);
+    void unlist(Room* room);
+    void unwatch(Room* room);
     
     Database* db_;
-    std::unordered_map<std::string, std::unique_ptr<Room>> rooms_;
+    ReplayWriter* replay_writer_ = nullptr;
+    RoomPool pool_;
+    ParagraphCache paragraphs_;
+    ParagraphSupply supply_;  // after paragraphs_: its worker stops first
+    // Recently served paragraphs, reused round-robin while the supply is empty
+    std::array<std::shared_ptr<const Paragraph>, 8> recent_;
+    size_t recent_count_ = 0;
+    size_t recent_next_ = 0;  // slot the next fetched paragraph goes to
+    size_t recent_pick_ = 0;  // next one to reuse
+    metrics::Counter* repeats_;
+    RoomCodeTable rooms_;  // room code -> Room*
     std::unordered_map<int, Room*> fd_to_room_;
-    int room_counter_ = 1;
+    std::unordered_map<int, Room*> fd_to_spectated_;
+    std::vector<Room*> watched_rooms_;
+    std::vector<int> orphaned_spectators_;
+    std::vector<Room*> open_rooms_[8];
 };
 
 #endif
@@ -0,0 +1,23 @@
+#include "room_pool.h"
+
+Room* RoomPool::acquire() {
+    if (free_.empty()) {
+        slabs_.push_back(std::make_unique<Room[]>(kSlabSize));
+        Room* slab = slabs_.back().get();
+        free_.reserve(capacity());
+        
+        // Reverse order so the slab is handed out front to back
+        for (size_t i = kSlabSize; i > 0; i--) {
+            free_.push_back(&slab[i - 1]);
+        }
+    }
+    
+    Room* room = free_.back();
+    free_.pop_back();
+    return room;
+}
+
+void RoomPool::release(Room* room) {
+    room->close();
+    free_.push_back(room);
+}
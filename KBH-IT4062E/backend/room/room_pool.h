@@ -0,0 +1,34 @@
+#ifndef ROOM_POOL_H
+#define ROOM_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "room.h"
+
+// Slab allocator for Rooms. Rooms are constructed kSlabSize at a time and
+// never freed while the pool lives: release() resets a room and puts it on
+// the free list, so its per-slot scorers and the capacity of its name and
+// spectator buffers are reused by the next create_room instead of
+// reallocated. The paragraph is not: close() drops the room's reference.
+class RoomPool {
+public:
+    static constexpr size_t kSlabSize = 16;
+
+    RoomPool() = default;
+    RoomPool(const RoomPool&) = delete;
+    RoomPool& operator=(const RoomPool&) = delete;
+
+    // A closed room, ready for Room::open()
+    Room* acquire();
+    void release(Room* room);
+
+    size_t capacity() const { return slabs_.size() * kSlabSize; }
+    size_t in_use() const { return capacity() - free_.size(); }
+
+private:
+    std::vector<std::unique_ptr<Room[]>> slabs_;
+    std::vector<Room*> free_;
+};
+
+#endif
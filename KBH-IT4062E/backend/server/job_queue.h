@@ -0,0 +1,31 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs jobs one at a time, in order, on a thread of its own: database
+// writes the game threads hand off and nobody waits for. The destructor
+// runs what is still queued, then joins, so jobs may use anything that
+// outlives the queue.
+class JobQueue {
+public:
+    JobQueue();
+    ~JobQueue();
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    void post(std::function<void()> job);
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    bool stop_ = false;
+    std::thread thread_;
+};
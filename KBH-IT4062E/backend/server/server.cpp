@@ -1,71 +1,352 @@
 #include "server.h"
+#include "log.h"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
-#include <iostream>
 #include <sstream>
 #include <thread>
+#include <cerrno>
 #include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <random>
 
-Server::Server(const std::string& ip, int port, Database* db)
+Server::Server(const std::string& ip, int port, Database* db,
+               const std::string& replay_dir)
     : ip_(ip),
       port_(port),
       server_fd_(-1),
+      replay_writer_(replay_dir),
       room_manager_(db),
-      start_time_(std::chrono::steady_clock::now()) {}
+      analytics_(db),
+      start_time_(std::chrono::steady_clock::now())
+{
+    room_manager_.set_replay_writer(&replay_writer_);
+    register_metrics();
+    settings_ = std::make_shared<const ServerSettings>();
+}
 
-void Server::start() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
-        perror("socket");
-        return;
+void Server::publish_settings(std::shared_ptr<const ServerSettings> settings) {
+    std::atomic_store(&settings_, std::move(settings));
+}
+
+void Server::apply_settings(const std::shared_ptr<const ServerSettings>& settings) {
+    const ServerSettings& s = *settings;
+    matchmaking_.set_config(s.matchmaking);
+    tournament_.set_config(s.tournament);
+    survival_config_ = s.survival;
+    session_grace_ms_ = s.session_grace_ms;
+    
+    // New idle timeout (or switched back on): every connection is re-armed
+    // at its own last_recv_ms, and timers armed before are ignored
+    if (s.limits.idle_timeout_ms != limits_.idle_timeout_ms) {
+        idle_generation_++;
+        if (s.limits.idle_timeout_ms > 0) {
+            for (const auto& [fd, info] : clients_) {
+                idle_timers_.schedule({fd, info.conn_id, idle_generation_},
+                                      info.last_recv_ms + s.limits.idle_timeout_ms);
+            }
+        }
+    }
+    bool retune = s.limits.max_send_buffer_bytes != limits_.max_send_buffer_bytes ||
+                  s.limits.keepalive_idle_s != limits_.keepalive_idle_s ||
+                  s.limits.keepalive_interval_s != limits_.keepalive_interval_s ||
+                  s.limits.keepalive_count != limits_.keepalive_count;
+    limits_ = s.limits;
+    fanout_.set_max_backlog(s.limits.max_send_buffer_bytes);
+    if (retune) {
+        for (const auto& kv : clients_) {
+            tune_client_socket(kv.first);
+        }
+    }
+    
+    auto& registry = metrics::Registry::global();
+    const char* help = "Inbound messages over their rate limit";
+    auto limited = [&](const std::string& type, const RateLimit& limit) {
+        LimitedType entry{limit, nullptr, nullptr};
+        std::string label = "type=\"" + type + "\",action=";
+        entry.dropped = &registry.counter("kbh_rate_limited_messages_total", help, label + "\"dropped\"");
+        if (type == "set_username" || type == "set_private") {
+            entry.coalesced = &registry.counter("kbh_rate_limited_messages_total", help,
+                                                label + "\"coalesced\"");
+        }
+        return entry;
+    };
+    
+    rate_limits_.clear();
+    for (const auto& [type, limit] : s.rates.by_type) {
+        rate_limits_[type] = limited(type, limit);
+    }
+    rate_limits_[kOtherMessages] = limited(kOtherMessages, s.rates.other);
+    
+    if (applied_) {
+        LOG_INFO("server", "Settings changed");
     }
+    applied_ = settings;
+}
 
-    int opt = 1;
-    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+void Server::register_metrics() {
+    auto& registry = metrics::Registry::global();
+    metrics_.lock_wait = &registry.histogram("kbh_state_lock_wait_seconds",
+        "Time a client thread waited for the server state lock");
+    metrics_.tick = &registry.histogram("kbh_tick_seconds", "Duration of one server tick");
+    metrics_.broadcast = &registry.histogram("kbh_broadcast_seconds",
+        "Duration of one room broadcast to its players");
+    metrics_.bytes_in = &registry.counter("kbh_received_bytes_total", "Bytes read from clients");
+    metrics_.bytes_out = &registry.counter("kbh_sent_bytes_total", "Bytes written to players");
+    metrics_.messages_out = &registry.counter("kbh_sent_messages_total", "Messages written to players");
+    metrics_.clients = &registry.gauge("kbh_clients", "Connected clients");
+    metrics_.rooms = &registry.gauge("kbh_rooms", "Open rooms");
+    metrics_.room_games = &registry.gauge("kbh_games", "Running games", "mode=\"room\"");
+    metrics_.training_games = &registry.gauge("kbh_games", "Running games", "mode=\"training\"");
+    metrics_.parked_sessions = &registry.gauge("kbh_parked_sessions", "Dropped sessions waiting for resume");
+    metrics_.queued = &registry.gauge("kbh_matchmaking_queued", "Players in the matchmaking queue");
+    metrics_.refused = &registry.counter("kbh_connections_refused_total",
+        "Connections refused at accept (max_connections)");
+    const char* closed_help = "Connections the server closed for breaking a limit";
+    metrics_.closed_idle = &registry.counter("kbh_connections_closed_total", closed_help, "reason=\"idle\"");
+    metrics_.closed_oversized = &registry.counter("kbh_connections_closed_total", closed_help,
+                                                  "reason=\"oversized_message\"");
+    metrics_.closed_slow = &registry.counter("kbh_connections_closed_total", closed_help,
+                                             "reason=\"slow_reader\"");
+    
+    // Same list as handle_message
+    static const char* kTypes[] = {
+        "time_sync", "set_username", "sign_in", "create_account", "change_password",
+        "sign_out", "create_room", "join_room", "join_random", "queue_leave",
+        "tournament_join", "tournament_leave", "spectate", "resume", "exit_room",
+        "ready", "unready", "set_private", "start_game", "start_training",
+        "save_training_result", "leaderboard", "profile", "input", "input_batch"
+    };
+    for (const char* type : kTypes) {
+        handler_latency_[type] = &registry.histogram("kbh_handler_seconds",
+            "Message handler latency by type", std::string("type=\"") + type + "\"");
+    }
+    unknown_handler_latency_ = &registry.histogram("kbh_handler_seconds",
+        "Message handler latency by type", "type=\"unknown\"");
+}
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port_);
-    addr.sin_addr.s_addr = inet_addr(ip_.c_str());
+void Server::update_gauges() {
+    metrics_.clients->set((int64_t)clients_.size());
+    metrics_.rooms->set((int64_t)room_manager_.room_count());
+    metrics_.room_games->set((int64_t)room_games_.size());
+    metrics_.training_games->set((int64_t)training_games_.size());
+    metrics_.parked_sessions->set((int64_t)parked_.size());
+    metrics_.queued->set((int64_t)matchmaking_.size());
+}
 
-    if (bind(server_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
-        perror("bind");
-        return;
+std::shared_ptr<const AdminSnapshot> Server::admin_snapshot() {
+    uint64_t seq = snapshot_requested_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::unique_lock<std::mutex> lock(snapshot_mutex_);
+    bool answered = snapshot_cv_.wait_for(lock, std::chrono::milliseconds(kSnapshotTimeoutMs),
+                                          [&] { return snapshot_ && snapshot_->seq >= seq; });
+    return answered ? snapshot_ : nullptr;
+}
+
+void Server::publish_admin_snapshot(int64_t now_ms) {
+    // Copies only; formatting happens on the admin connection's thread
+    auto snap = std::make_shared<AdminSnapshot>();
+    snap->seq = snapshot_requested_.load(std::memory_order_acquire);
+    snap->taken_ms = now_ms;
+
+    room_manager_.for_each_room([&](Room* room) {
+        AdminSnapshot::RoomInfo info;
+        info.id = room->id();
+        auto game_it = room_games_.find(room->id());
+        if (game_it != room_games_.end()) {
+            info.mode = std::holds_alternative<SurvivalMode>(game_it->second) ? "survival" : "arena";
+        }
+        info.is_private = room->is_private();
+        info.game_started = room->is_game_started();
+        info.game_start_ms = room->game_start_time();
+        info.duration_ms = room->game_duration();
+        info.host_slot = room->host_slot_idx();
+        info.total_words = room->total_words();
+        info.spectators = (int)room->spectators().size();
+        for (int i = 0; i < 8; i++) {
+            const auto& slot = room->get_slot(i);
+            if (!slot.occupied) continue;
+            AdminSnapshot::Player player;
+            player.slot = i;
+            player.client_id = slot.client_id;
+            player.display_name = slot.display_name;
+            player.connected = slot.client_fd >= 0;
+            player.ready = slot.is_ready;
+            player.eliminated = slot.eliminated;
+            PlayerMetrics metrics = room->get_player_metrics(slot.client_fd);
+            player.word_idx = metrics.word_idx;
+            player.wpm = metrics.wpm;
+            info.players.push_back(std::move(player));
+        }
+        snap->rooms.push_back(std::move(info));
+    });
+
+    auto add_client = [&](int fd, const ClientInfo& info, bool parked) {
+        AdminSnapshot::Client client;
+        client.fd = fd;
+        client.client_id = info.client_id;
+        client.display_name = info.display_name;
+        client.username = info.username;
+        client.parked = parked;
+        if (Room* room = room_manager_.get_room_of_fd(fd)) {
+            client.room = room->id();
+        } else if (Room* watched = room_manager_.get_spectated_room(fd)) {
+            client.room = watched->id();
+            client.spectating = true;
+        }
+        client.training = training_games_.count(fd) > 0;
+        client.queued = matchmaking_.contains(fd);
+        client.tournament = tournament_.is_entrant(fd);
+        snap->clients.push_back(std::move(client));
+    };
+    for (const auto& [fd, info] : clients_) {
+        add_client(fd, info, false);
+    }
+    for (const auto& [token, parked] : parked_) {
+        add_client(parked.fd, parked.info, true);
     }
 
-    if (listen(server_fd_, 10) < 0) {
-        perror("listen");
-        return;
+    static const char* kPhases[] = {"idle", "registration", "running", "break"};
+    snap->room_games = room_games_.size();
+    snap->training_games = training_games_.size();
+    snap->matchmaking_queued = matchmaking_.size();
+    snap->tournament_phase = kPhases[(int)tournament_.phase()];
+    snap->tournament_round = tournament_.round();
+    snap->tournament_entrants = tournament_.entrant_count();
+
+    snapshot_taken_ = snap->seq;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot_ = std::move(snap);
     }
+    snapshot_cv_.notify_all();
+}
 
-    std::cout << "[SERVER] Running at " << ip_ << ":" << port_ << "\n";
+void Server::start() {
+    if (server_fd_ >= 0) {
+        LOG_INFO("server", "Running on inherited listener").field("fd", server_fd_).field("port", port_);
+    } else if (!listen_on_port()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        apply_settings(settings());
+    }
+    std::thread tick(&Server::tick_loop, this);
 
-    while (true) {
+    while (!draining_) {
+        // Wake up now and then to notice drain()
+        pollfd pfd{server_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0 || draining_) continue;
+        
         int client_fd = accept(server_fd_, nullptr, nullptr);
-        if (client_fd < 0) continue;
+        if (client_fd < 0) {
+            // Out of fds: the pending connection stays readable, don't spin on it
+            if (errno == EMFILE || errno == ENFILE) {
+                LOG_ERROR("server", "accept failed").field("error", strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
         
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        
+        if (limits_.max_connections > 0 && (int)clients_.size() >= limits_.max_connections) {
+            refuse_client(client_fd);
+            continue;
+        }
+        tune_client_socket(client_fd);
+
         // Assign client_id
         ClientInfo info;
         info.client_id = next_client_id_++;
         info.display_name = "Guest " + std::to_string(info.client_id);
+        info.session_token = new_session_token();
+        info.conn_id = info.client_id;
+        info.last_recv_ms = get_server_time_ms();
         clients_[client_fd] = info;
+        if (limits_.idle_timeout_ms > 0) {
+            idle_timers_.schedule({client_fd, info.conn_id, idle_generation_},
+                                  info.last_recv_ms + limits_.idle_timeout_ms);
+        }
         
-        std::cout << "[SERVER] Client connected: FD=" << client_fd 
-                  << " ID=" << info.client_id << "\n";
+        LOG_INFO("server", "Client connected").field("fd", client_fd).field("client_id", info.client_id);
         
         // Send hello message
         Json::Value hello;
         hello["type"] = "hello";
         hello["client_id"] = info.client_id;
         hello["server_time_ms"] = (Json::Int64)get_server_time_ms();
+        hello["session_token"] = info.session_token;
         send_json(client_fd, hello);
 
         std::thread(&Server::handle_client, this, client_fd).detach();
     }
+    
+    {
+        // A successor may hold a copy: closing ours leaves its queue intact
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        close(server_fd_);
+        server_fd_ = -1;
+    }
+    
+    // The tick runs the drain and returns once every game is over and
+    // every socket shut down; client threads then leave clients_ one by one
+    tick.join();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            if (clients_.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kTickIntervalMs));
+    }
+    LOG_INFO("server", "Drained, stopping");
+}
+
+bool Server::listen_on_port() {
+    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd_ < 0) {
+        LOG_ERROR("server", "socket failed").field("error", strerror(errno));
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = inet_addr(ip_.c_str());
+
+    if (bind(server_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("server", "bind failed").field("error", strerror(errno)).field("port", port_);
+        return false;
+    }
+
+    if (listen(server_fd_, SOMAXCONN) < 0) {
+        LOG_ERROR("server", "listen failed").field("error", strerror(errno));
+        return false;
+    }
+
+    LOG_INFO("server", "Running").field("ip", ip_).field("port", port_);
+    return true;
+}
+
+int Server::dup_listener() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (draining_ || server_fd_ < 0) return -1;
+    return dup(server_fd_);
+}
+
+void Server::drain(int deadline_ms) {
+    drain_deadline_ms_ = get_server_time_ms() + std::max(0, deadline_ms);
+    draining_ = true;
 }
 
 void Server::handle_client(int client_fd) {
@@ -73,56 +354,285 @@ void Server::handle_client(int client_fd) {
 
     while (true) {
         int n = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+        
+        auto received_at = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        auto locked_at = std::chrono::steady_clock::now();
+        metrics_.lock_wait->record(locked_at - received_at);
+
         if (n <= 0) {
-            std::cout << "[SERVER] Client disconnected: FD=" << client_fd << "\n";
+            LOG_INFO("server", "Client disconnected").field("fd", client_fd);
             
-            // Remove from room and broadcast update to remaining players
-            Room* room = room_manager_.remove_fd(client_fd);
-            if (room) {
-                std::cout << "[SERVER] Broadcasting room_state after disconnect\n";
-                broadcast_room_state(room);
+            // A seated or training player keeps their state for a grace
+            // period; everyone else leaves their room, queue and training now.
+            // Draining, nobody could come back to resume.
+            if (draining_ || !park_session(client_fd)) {
+                leave_lobby(client_fd);
+                tournament_.leave(client_fd);
             }
             
+            fanout_.remove(client_fd);
             clients_.erase(client_fd);
             close(client_fd);
             return;
         }
 
         buffer[n] = '\0';
+        metrics_.bytes_in->inc(n);
         
         // Append to recv buffer
         auto& client_info = clients_[client_fd];
         client_info.recv_buffer.append(buffer, n);
+        client_info.last_recv_ms = get_server_time_ms();
         
         // Process complete JSON lines
-        size_t pos;
-        while ((pos = client_info.recv_buffer.find('\n')) != std::string::npos) {
-            std::string line = client_info.recv_buffer.substr(0, pos);
-            client_info.recv_buffer.erase(0, pos + 1);
-            
-            // Trim whitespace
-            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
-                line.pop_back();
-            }
-            
+        std::string line;
+        while (next_line(client_info.recv_buffer, line)) {
             if (line.empty()) continue;
             
-            // Parse JSON
+            // No-op unless this message is sampled for tracing
+            tracing::MessageSpan span(client_fd, received_at, locked_at);
+            
             Json::Value msg;
-            Json::CharReaderBuilder builder;
-            std::istringstream ss(line);
             std::string errs;
-            
-            if (!Json::parseFromStream(builder, ss, &msg, &errs)) {
-                std::cerr << "[SERVER] JSON parse error: " << errs << "\n";
+            if (!parse_message(line, msg, errs)) {
+                LOG_WARN("server", "JSON parse error").field("fd", client_fd).field("error", errs);
                 continue;
             }
+            span.parsed();
             
             handle_message(client_fd, msg);
+            span.handled();
+            
+            // Only this thread removes client_info, so it survives the unlock
+            if (deferred_db_) {
+                std::function<void()> call = std::move(deferred_db_);
+                deferred_db_ = nullptr;
+                lock.unlock();
+                call();
+                lock.lock();
+            }
+        }
+        
+        // Still no newline past the cap: this is never going to be a message
+        if (limits_.max_message_bytes > 0 && client_info.recv_buffer.size() > limits_.max_message_bytes) {
+            LOG_WARN("server", "Message too large, disconnecting").field("fd", client_fd)
+                .field("bytes", (uint64_t)client_info.recv_buffer.size());
+            client_info.recv_buffer.clear();
+            metrics_.closed_oversized->inc();
+            cut_client(client_fd, "MESSAGE_TOO_LARGE",
+                       "Messages are limited to " + std::to_string(limits_.max_message_bytes) + " bytes");
+        }
+    }
+}
+
+bool Server::next_line(std::string& buffer, std::string& line) {
+    size_t pos = buffer.find('\n');
+    if (pos == std::string::npos) return false;
+    line.assign(buffer, 0, pos);
+    buffer.erase(0, pos + 1);
+    
+    // Trim whitespace
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+        line.pop_back();
+    }
+    return true;
+}
+
+bool Server::parse_message(const std::string& line, Json::Value& msg, std::string& errs) {
+    Json::CharReaderBuilder builder;
+    std::istringstream ss(line);
+    return Json::parseFromStream(builder, ss, &msg, &errs);
+}
+
+void Server::refuse_client(int fd) {
+    metrics_.refused->inc();
+    LOG_WARN("server", "Connection refused, server full").field("clients", (uint64_t)clients_.size());
+    
+    static const std::string kFull =
+        "{\"type\":\"error\",\"code\":\"SERVER_FULL\",\"message\":\"Server is full, try again later\"}\n";
+    send(fd, kFull.data(), kFull.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    close(fd);
+}
+
+void Server::tune_client_socket(int fd) {
+    // Output a client leaves unread piles up here, and no further
+    if (limits_.max_send_buffer_bytes > 0) {
+        int bytes = (int)limits_.max_send_buffer_bytes;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes));
+    }
+    
+    // Half-open peers (pulled cable, crashed host) never send a FIN;
+    // keepalive probes find them, TCP_USER_TIMEOUT does while output is
+    // unacknowledged (keepalive stays quiet then)
+    if (limits_.keepalive_idle_s > 0) {
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &limits_.keepalive_idle_s, sizeof(int));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &limits_.keepalive_interval_s, sizeof(int));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &limits_.keepalive_count, sizeof(int));
+        unsigned int user_timeout_ms = 1000u * (limits_.keepalive_idle_s +
+                                                limits_.keepalive_interval_s * limits_.keepalive_count);
+        setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &user_timeout_ms, sizeof(user_timeout_ms));
+    } else {
+        // Switched off by a reload: open sockets stop probing too
+        int off = 0;
+        unsigned int no_timeout = 0;
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &off, sizeof(off));
+        setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &no_timeout, sizeof(no_timeout));
+    }
+}
+
+void Server::reap_idle_clients(int64_t now_ms) {
+    idle_due_.clear();
+    idle_timers_.advance(now_ms, idle_due_);
+    for (const IdleTimer& timer : idle_due_) {
+        auto it = clients_.find(timer.fd);
+        if (it == clients_.end() || it->second.conn_id != timer.conn_id) continue;  // gone
+        if (timer.generation != idle_generation_) continue;  // armed under an older timeout
+        
+        int64_t deadline = it->second.last_recv_ms + limits_.idle_timeout_ms;
+        if (now_ms < deadline) {
+            idle_timers_.schedule(timer, deadline);
+            continue;
+        }
+        LOG_INFO("server", "Idle connection closed").field("fd", timer.fd)
+            .field("idle_ms", now_ms - it->second.last_recv_ms);
+        metrics_.closed_idle->inc();
+        cut_client(timer.fd, "IDLE_TIMEOUT", "Nothing received for " +
+                   std::to_string(limits_.idle_timeout_ms / 1000) + " s");
+    }
+}
+
+void Server::cut_client(int fd, const char* code, const std::string& message) {
+    Json::Value err;
+    err["type"] = "error";
+    err["code"] = code;
+    err["message"] = message;
+    send_json(fd, err);
+    
+    // The client thread sees EOF and cleans up as for any disconnect
+    shutdown(fd, SHUT_RDWR);
+}
+
+
+void Server::tick_loop() {
+    int64_t last_matchmaking_ms = 0;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kTickIntervalMs));
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        metrics::ScopedTimer timer(*metrics_.tick);
+        int64_t now = get_server_time_ms();
+        if (auto latest = settings(); latest != applied_) {
+            apply_settings(latest);
+        }
+        update_gauges();
+        if (draining_.load(std::memory_order_relaxed) && run_drain(now)) {
+            return;
+        }
+        if (matchmaking_.size() > 0 && now - last_matchmaking_ms >= matchmaking_.config().tick_ms) {
+            last_matchmaking_ms = now;
+            run_matchmaking(now);
+        }
+        push_spectator_states(now);
+        if (tournament_.phase() != Tournament::Phase::Idle) {
+            run_tournament(now);
+        }
+        if (!room_games_.empty() || !training_games_.empty()) {
+            run_games(now);
+        }
+        if (!parked_.empty()) {
+            expire_sessions(now);
+        }
+        if (limits_.idle_timeout_ms > 0) {
+            reap_idle_clients(now);
         }
+        if (!coalescing_.empty()) {
+            apply_coalesced(now);
+        }
+        if (!backlogged_.empty()) {
+            flush_backlogs();
+        }
+        if (snapshot_requested_.load(std::memory_order_acquire) != snapshot_taken_) {
+            publish_admin_snapshot(now);
+        }
+    }
+}
+
+// ========== Graceful drain ==========
+
+bool Server::run_drain(int64_t now_ms) {
+    if (!drain_started_) {
+        drain_started_ = true;
+        LOG_INFO("server", "Draining").field("games", (uint64_t)(room_games_.size() + training_games_.size()))
+            .field("clients", (uint64_t)clients_.size())
+            .field("deadline_ms", drain_deadline_ms_.load() - now_ms);
+        
+        Json::Value info;
+        info["type"] = "info";
+        info["code"] = "SERVER_DRAINING";
+        info["message"] = "Server is restarting; games in progress will finish first";
+        std::string line = json_line(info);
+        for (const auto& kv : clients_) {
+            send_line(kv.first, line);
+        }
+    }
+    
+    // No new rounds; a round being played is finished first
+    if (tournament_.phase() == Tournament::Phase::Registration ||
+        tournament_.phase() == Tournament::Phase::Break) {
+        std::vector<int> entrants = tournament_.cancel();
+        LOG_INFO("tournament", "Cancelled for shutdown").field("entrants", (uint64_t)entrants.size());
+    }
+    
+    bool games_left = !room_games_.empty() || !training_games_.empty();
+    if (games_left && now_ms < drain_deadline_ms_) {
+        disconnect_idle_clients();
+        return false;
+    }
+    
+    end_games_now();
+    expire_sessions(INT64_MAX);
+    db_jobs_.post([this] { analytics_.flush(); });
+    
+    // Client threads see EOF and clean up as for any disconnect
+    for (const auto& kv : clients_) {
+        shutdown(kv.first, SHUT_RDWR);
     }
+    LOG_INFO("server", "All games ended, disconnecting").field("clients", (uint64_t)clients_.size());
+    return true;
 }
 
+void Server::end_games_now() {
+    // Ended the regular way: players get game_end, results are saved
+    while (!room_games_.empty()) {
+        std::string room_id = room_games_.begin()->first;
+        ModeGame& game = room_games_.begin()->second;
+        Room* room = room_manager_.find_room(room_id);
+        if (room && room == mode_room(game) && room->is_game_started()) {
+            end_mode_game(game, true);
+        }
+        room_games_.erase(room_id);  // if ending it did not already
+    }
+    while (!training_games_.empty()) {
+        int fd = training_games_.begin()->first;
+        end_mode_game(training_games_.begin()->second);
+        training_games_.erase(fd);
+    }
+}
+
+void Server::disconnect_idle_clients() {
+    for (const auto& kv : clients_) {
+        int fd = kv.first;
+        if (game_of(fd)) continue;
+        Room* watched = room_manager_.get_spectated_room(fd);
+        if (watched && watched->is_game_started()) continue;
+        
+        // Their thread sees EOF and cleans up; repeating this is harmless
+        shutdown(fd, SHUT_RDWR);
+    }
+}
 
 void Server::handle_message(int fd, const Json::Value& msg) {
     if (!msg.isMember("type") || !msg["type"].isString()) {
@@ -130,7 +640,124 @@ void Server::handle_message(int fd, const Json::Value& msg) {
     }
     
     std::string type = msg["type"].asString();
+    if (auto* span = tracing::MessageSpan::current()) {
+        span->dispatched(type);
+    }
+    
+    if (!admit_message(fd, type, msg)) {
+        return;
+    }
+    
+    // Draining: games already running carry on, nothing new starts
+    if (draining_.load(std::memory_order_relaxed) &&
+        (type == "create_room" || type == "join_room" || type == "join_random" ||
+         type == "start_game" || type == "start_training" || type == "tournament_join" ||
+         type == "spectate")) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "SERVER_DRAINING";
+        err["message"] = "Server is restarting, try again in a moment";
+        send_json(fd, err);
+        return;
+    }
+    
+    dispatch_message(fd, type, msg);
+}
+
+bool Server::admit_message(int fd, const std::string& type, const Json::Value& msg) {
+    auto limit_it = rate_limits_.find(type);
+    bool listed = limit_it != rate_limits_.end();
+    if (!listed) limit_it = rate_limits_.find(kOtherMessages);
+    if (limit_it == rate_limits_.end() || limit_it->second.limit.per_second <= 0) return true;
+    LimitedType& limited = limit_it->second;
+    
+    auto client_it = clients_.find(fd);
+    if (client_it == clients_.end()) return true;
+    ClientInfo& client = client_it->second;
+    
+    // One already held back: this one replaces it, in its place in line
+    if (limited.coalesced && client.coalesced.count(type)) {
+        client.coalesced[type] = msg;
+        limited.coalesced->inc();
+        return false;
+    }
     
+    RateState& state = client.rates[listed ? type : kOtherMessages];
+    if (state.bucket.take(get_server_time_ms(), limited.limit.per_second, limited.limit.burst)) {
+        state.warned = false;
+        return true;
+    }
+    
+    if (limited.coalesced) {
+        client.coalesced[type] = msg;
+        coalescing_.insert(fd);
+        limited.coalesced->inc();
+        return false;
+    }
+    
+    limited.dropped->inc();
+    if (!state.warned) {
+        state.warned = true;
+        LOG_WARN("server", "Rate limited").field("fd", fd).field("type", type);
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "RATE_LIMITED";
+        err["message"] = "Too many " + type + " messages, some were ignored";
+        send_json(fd, err);
+    }
+    return false;
+}
+
+void Server::apply_coalesced(int64_t now_ms) {
+    for (auto fd_it = coalescing_.begin(); fd_it != coalescing_.end(); ) {
+        int fd = *fd_it;
+        auto client_it = clients_.find(fd);
+        if (client_it == clients_.end()) {
+            fd_it = coalescing_.erase(fd_it);
+            continue;
+        }
+        
+        std::vector<std::pair<std::string, Json::Value>> ready;
+        auto& pending = client_it->second.coalesced;
+        for (auto it = pending.begin(); it != pending.end(); ) {
+            const RateLimit& limit = rate_limits_[it->first].limit;
+            if (limit.per_second <= 0 ||
+                client_it->second.rates[it->first].bucket.take(now_ms, limit.per_second, limit.burst)) {
+                ready.emplace_back(it->first, std::move(it->second));
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        fd_it = pending.empty() ? coalescing_.erase(fd_it) : std::next(fd_it);
+        
+        for (const auto& [type, msg] : ready) {
+            dispatch_message(fd, type, msg);
+        }
+    }
+}
+
+void Server::dispatch_message(int fd, const std::string& type, const Json::Value& msg) {
+    auto latency_it = handler_latency_.find(type);
+    metrics::ScopedTimer timer(latency_it != handler_latency_.end() ? *latency_it->second
+                                                                    : *unknown_handler_latency_);
+    
+    // Handlers check the fields they read; this keeps one they missed from
+    // ending the client thread, and with it the process
+    try {
+        route_message(fd, type, msg);
+    } catch (const Json::Exception& e) {
+        LOG_WARN("server", "Malformed message").field("fd", fd).field("type", type)
+            .field("error", e.what());
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "MALFORMED_MESSAGE";
+        err["message"] = "Malformed " + type + " message";
+        send_json(fd, err);
+    }
+}
+
+void Server::route_message(int fd, const std::string& type, const Json::Value& msg) {
     if (type == "time_sync") {
         on_time_sync(fd, msg);
     } else if (type == "set_username") {
@@ -149,6 +776,16 @@ void Server::handle_message(int fd, const Json::Value& msg) {
         on_join_room(fd, msg);
     } else if (type == "join_random") {
         on_join_random(fd);
+    } else if (type == "queue_leave") {
+        on_queue_leave(fd);
+    } else if (type == "tournament_join") {
+        on_tournament_join(fd);
+    } else if (type == "tournament_leave") {
+        on_tournament_leave(fd);
+    } else if (type == "spectate") {
+        on_spectate(fd, msg);
+    } else if (type == "resume") {
+        on_resume(fd, msg);
     } else if (type == "exit_room") {
         on_exit_room(fd);
     } else if (type == "ready") {
@@ -165,8 +802,12 @@ void Server::handle_message(int fd, const Json::Value& msg) {
         on_save_training_result(fd, msg);
     } else if (type == "leaderboard") {
         on_leaderboard(fd);
+    } else if (type == "profile") {
+        on_profile(fd);
     } else if (type == "input") {
         on_input(fd, msg);
+    } else if (type == "input_batch") {
+        on_input_batch(fd, msg);
     } else {
         Json::Value err;
         err["type"] = "error";
@@ -178,23 +819,114 @@ void Server::handle_message(int fd, const Json::Value& msg) {
 
 // ========== Helper functions ==========
 
-void Server::send_json(int fd, const Json::Value& obj) {
+std::string Server::json_line(const Json::Value& obj) {
+    tracing::Scope scope("serialize");
     Json::StreamWriterBuilder builder;
     builder["indentation"] = "";
-    std::string msg = Json::writeString(builder, obj) + "\n";
-    send(fd, msg.c_str(), msg.size(), 0);
+    std::string line = Json::writeString(builder, obj) + "\n";
+    scope.set_bytes(line.size());
+    return line;
+}
+
+void Server::send_json(int fd, const Json::Value& obj) {
+    send_line(fd, json_line(obj));
+}
+
+void Server::send_line(int fd, const std::string& msg) {
+    if (fd < 0) return;  // parked session, nobody to write to
+    
+    // Clients that have spectated are written by the fanout workers only,
+    // so their messages can never interleave or reorder
+    auto it = clients_.find(fd);
+    if (it != clients_.end() && it->second.via_fanout) {
+        fanout_.send(fd, std::make_shared<const std::string>(msg));
+        return;
+    }
+    metrics_.messages_out->inc();
+    metrics_.bytes_out->inc(msg.size());
+    tracing::Scope scope("send");
+    scope.set_bytes(msg.size());
+    
+    if (it == clients_.end()) {
+        send(fd, msg.c_str(), msg.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        return;
+    }
+    
+    // Never blocks with the state lock held: what the socket does not take
+    // now waits in the backlog (whole lines, in order) for the tick to flush
+    ClientInfo& info = it->second;
+    size_t sent = 0;
+    if (info.send_backlog.empty()) {
+        ssize_t n = send(fd, msg.c_str(), msg.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n == (ssize_t)msg.size()) return;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return;  // peer gone
+        sent = n > 0 ? n : 0;
+        backlogged_.insert(fd);
+    }
+    info.send_backlog.append(msg, sent, std::string::npos);
+    
+    // A client that stopped reading is cut off once its unsent output
+    // passes max_send_buffer_bytes (never with no limit)
+    if (limits_.max_send_buffer_bytes > 0 && info.send_backlog.size() > limits_.max_send_buffer_bytes) {
+        LOG_WARN("server", "Client not reading, disconnecting").field("fd", fd)
+            .field("backlog_bytes", (uint64_t)info.send_backlog.size());
+        metrics_.closed_slow->inc();
+        info.send_backlog.clear();
+        backlogged_.erase(fd);
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+void Server::flush_backlogs() {
+    for (auto it = backlogged_.begin(); it != backlogged_.end();) {
+        auto client = clients_.find(*it);
+        if (client == clients_.end() || client->second.send_backlog.empty()) {
+            it = backlogged_.erase(it);
+            continue;
+        }
+        std::string& backlog = client->second.send_backlog;
+        ssize_t n = send(*it, backlog.data(), backlog.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            backlog.clear();  // peer gone; its client thread cleans up
+        } else if (n > 0) {
+            backlog.erase(0, n);
+        }
+        it = backlog.empty() ? backlogged_.erase(it) : std::next(it);
+    }
+}
+
+std::string Server::game_init_line(const Json::Value& init, const Paragraph& paragraph) {
+    std::string msg = json_line(init);
+    msg.pop_back();  // newline
+    
+    // Splice the cached paragraph members in before the closing brace
+    msg.pop_back();
+    msg += ',';
+    msg += paragraph.json_fragment();
+    msg += "}\n";
+    return msg;
 }
 
 void Server::broadcast_json(Room* room, const Json::Value& obj) {
     if (!room) return;
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "";
-    std::string msg = Json::writeString(builder, obj) + "\n";
-    
+    std::string msg = json_line(obj);
+    broadcast_line(room, msg);
+    send_to_spectators(room, std::move(msg), true);
+}
+
+void Server::send_to_spectators(Room* room, std::string msg, bool reliable) {
+    if (room->spectators().empty()) return;
+    fanout_.publish(std::make_shared<const std::string>(std::move(msg)),
+                    room->spectators(), reliable);
+}
+
+void Server::broadcast_line(Room* room, const std::string& msg) {
+    if (!room) return;
+    metrics::ScopedTimer timer(*metrics_.broadcast);
     for (int i = 0; i < 8; i++) {
         const auto& slot = room->get_slot(i);
         if (slot.occupied) {
-            send(slot.client_fd, msg.c_str(), msg.size(), 0);
+            send_line(slot.client_fd, msg);
         }
     }
 }
@@ -205,6 +937,22 @@ int64_t Server::get_server_time_ms() const {
     return elapsed.count();
 }
 
+double Server::skill_wpm(int fd) const {
+    auto it = clients_.find(fd);
+    if (it != clients_.end() && it->second.skill_wpm > 0) {
+        return it->second.skill_wpm;
+    }
+    return 40.0;  // typical casual typist
+}
+
+void Server::update_skill(int fd, double wpm) {
+    auto it = clients_.find(fd);
+    if (it == clients_.end() || wpm <= 0) return;
+    
+    double& skill = it->second.skill_wpm;
+    skill = skill > 0 ? 0.7 * skill + 0.3 * wpm : wpm;
+}
+
 bool Server::is_user_logged_in(int64_t user_id) const {
     if (user_id <= 0) return false;
     
@@ -219,6 +967,26 @@ bool Server::is_user_logged_in(int64_t user_id) const {
 void Server::broadcast_room_state(Room* room) {
     if (!room) return;
     
+    Json::Value state = room_state_json(room);
+    
+    // Add self_client_id for each client
+    for (int i = 0; i < 8; i++) {
+        const auto& slot = room->get_slot(i);
+        if (slot.occupied) {
+            Json::Value personal_state = state;
+            personal_state["self_client_id"] = slot.client_id;
+            send_json(slot.client_fd, personal_state);
+        }
+    }
+    
+    // One shared copy for every spectator
+    if (!room->spectators().empty()) {
+        state["spectating"] = true;
+        send_to_spectators(room, json_line(state), true);
+    }
+}
+
+Json::Value Server::room_state_json(Room* room) {
     Json::Value state;
     state["type"] = "room_state";
     state["room_id"] = room->id();
@@ -240,6 +1008,7 @@ void Server::broadcast_room_state(Room* room) {
             s["display_name"] = slot.display_name;
             s["is_host"] = (i == room->host_slot_idx());
             s["is_ready"] = slot.is_ready;
+            s["connected"] = slot.client_fd >= 0;
             s["knight_idx"] = i;
         }
         
@@ -247,15 +1016,246 @@ void Server::broadcast_room_state(Room* room) {
     }
     state["slots"] = slots;
     
-    // Add self_client_id for each client
-    for (int i = 0; i < 8; i++) {
-        const auto& slot = room->get_slot(i);
-        if (slot.occupied) {
-            Json::Value personal_state = state;
-            personal_state["self_client_id"] = slot.client_id;
-            send_json(slot.client_fd, personal_state);
-        }
+    state["spectators"] = (int)room->spectators().size();
+    return state;
+}
+
+// ========== Sessions ==========
+
+std::string Server::new_session_token() {
+    // 128 bits from the OS generator: the token alone resumes a session
+    std::random_device rd;
+    static const char kHex[] = "0123456789abcdef";
+    std::string token;
+    token.reserve(32);
+    for (int i = 0; i < 4; i++) {
+        uint32_t word = rd();
+        for (int j = 0; j < 8; j++) {
+            token += kHex[(word >> (j * 4)) & 0xF];
+        }
+    }
+    return token;
+}
+
+void Server::rebind_session(int from_fd, int to_fd) {
+    room_manager_.rebind_fd(from_fd, to_fd);
+    tournament_.rebind(from_fd, to_fd);
+    
+    auto node = training_games_.extract(from_fd);
+    if (!node.empty()) {
+        node.key() = to_fd;
+        std::get<TrainingMode>(node.mapped()).set_fd(to_fd);
+        training_games_.insert(std::move(node));
+    }
+}
+
+const Server::ClientInfo* Server::find_client(int fd) const {
+    if (fd >= 0) {
+        auto it = clients_.find(fd);
+        return it == clients_.end() ? nullptr : &it->second;
+    }
+    for (const auto& [token, parked] : parked_) {
+        if (parked.fd == fd) return &parked.info;
     }
+    return nullptr;
+}
+
+bool Server::park_session(int fd) {
+    if (session_grace_ms_ <= 0) return false;
+    
+    Room* room = room_manager_.get_room_of_fd(fd);
+    if (!room && !training_games_.count(fd)) return false;
+    
+    auto client_it = clients_.find(fd);
+    if (client_it == clients_.end() || client_it->second.session_token.empty()) return false;
+    
+    // Negative, so never a live socket, and unique per client
+    int placeholder = -1 - client_it->second.client_id;
+    matchmaking_.remove(fd);
+    rebind_session(fd, placeholder);
+    
+    ParkedSession& parked = parked_[client_it->second.session_token];
+    parked.fd = placeholder;
+    parked.info = std::move(client_it->second);
+    parked.info.recv_buffer.clear();
+    parked.info.send_backlog.clear();
+    parked.expires_ms = get_server_time_ms() + session_grace_ms_;
+    
+    LOG_INFO("server", "Session parked").field("client_id", parked.info.client_id)
+        .field("grace_ms", session_grace_ms_);
+    
+    // Others see the seat as disconnected
+    if (room) {
+        broadcast_room_state(room);
+    }
+    return true;
+}
+
+void Server::expire_sessions(int64_t now_ms) {
+    for (auto it = parked_.begin(); it != parked_.end(); ) {
+        if (now_ms < it->second.expires_ms) {
+            ++it;
+            continue;
+        }
+        int fd = it->second.fd;
+        it = parked_.erase(it);
+        
+        leave_lobby(fd);
+        tournament_.leave(fd);
+    }
+}
+
+void Server::on_resume(int fd, const Json::Value& msg) {
+    std::string token = msg.isMember("session_token") ? msg["session_token"].asString() : "";
+    
+    int from_fd = -1;
+    ClientInfo resumed;
+    
+    auto parked_it = token.empty() ? parked_.end() : parked_.find(token);
+    if (parked_it != parked_.end()) {
+        from_fd = parked_it->second.fd;
+        resumed = std::move(parked_it->second.info);
+        parked_.erase(parked_it);
+        
+        // Signed in again from elsewhere meanwhile: that login wins
+        if (is_user_logged_in(resumed.user_id)) {
+            leave_lobby(from_fd);
+            tournament_.leave(from_fd);
+            from_fd = -1;
+        }
+    } else if (!token.empty()) {
+        // The old connection may still look alive (half-open after a
+        // network change): take its session over and let it close
+        for (auto& [old_fd, info] : clients_) {
+            if (old_fd != fd && info.session_token == token) {
+                from_fd = old_fd;
+                resumed = info;
+                info.session_token.clear();
+                info.user_id = -1;
+                shutdown(old_fd, SHUT_RDWR);
+                break;
+            }
+        }
+    }
+    
+    if (from_fd == -1) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "SESSION_EXPIRED";
+        err["message"] = "Session expired, please join again";
+        send_json(fd, err);
+        return;
+    }
+    
+    // This connection becomes the old session: same id, name and login
+    leave_lobby(fd);
+    tournament_.leave(fd);
+    rebind_session(from_fd, fd);
+    
+    ClientInfo& info = clients_[fd];
+    info.client_id = resumed.client_id;
+    info.display_name = resumed.display_name;
+    info.user_id = resumed.user_id;
+    info.username = resumed.username;
+    info.skill_wpm = resumed.skill_wpm;
+    info.session_token = resumed.session_token;
+    
+    LOG_INFO("server", "Session resumed").field("client_id", info.client_id).field("fd", fd);
+    
+    bool with_paragraph = !msg.get("has_paragraph", false).asBool();
+    send_json(fd, resume_snapshot(fd, with_paragraph));
+    
+    Room* room = room_manager_.get_room_of_fd(fd);
+    if (room) {
+        broadcast_room_state(room);
+    }
+}
+
+Json::Value Server::resume_snapshot(int fd, bool with_paragraph) {
+    const ClientInfo& info = clients_[fd];
+    
+    Json::Value snap;
+    snap["type"] = "resume_ok";
+    snap["client_id"] = info.client_id;
+    snap["display_name"] = info.display_name;
+    snap["session_token"] = info.session_token;
+    snap["user_id"] = (Json::Int64)info.user_id;
+    snap["username"] = info.username;
+    snap["server_time_ms"] = (Json::Int64)get_server_time_ms();
+    
+    // Only what a client that was already playing is missing: where the
+    // game stands now, and how much of its own input arrived
+    Json::Value game;
+    const LivePlayer* self = nullptr;
+    
+    auto training_it = training_games_.find(fd);
+    if (training_it != training_games_.end()) {
+        const auto& training = std::get<TrainingMode>(training_it->second);
+        snap["room_id"] = "training";
+        snap["slot_idx"] = 0;
+        game["server_start_ms"] = (Json::Int64)training.start_time_ms();
+        game["duration_ms"] = training.duration_ms();
+        game["total_words"] = training.paragraph().total_words();
+        if (with_paragraph) game["paragraph"] = training.paragraph().text();
+        self = &training.live();
+    } else if (Room* room = room_manager_.get_room_of_fd(fd)) {
+        snap["room_id"] = room->id();
+        for (int i = 0; i < 8; i++) {
+            if (room->get_slot(i).occupied && room->get_slot(i).client_fd == fd) {
+                snap["slot_idx"] = i;
+            }
+        }
+        
+        if (room->is_game_started()) {
+            game["server_start_ms"] = (Json::Int64)room->game_start_time();
+            game["duration_ms"] = room->game_duration();
+            game["total_words"] = room->total_words();
+            if (with_paragraph) game["paragraph"] = room->paragraph().text();
+            
+            auto game_it = room_games_.find(room->id());
+            if (game_it != room_games_.end()) {
+                if (auto* survival = std::get_if<SurvivalMode>(&game_it->second)) {
+                    game["mode"] = "survival";
+                    game["stage"] = survival->stage();
+                }
+            }
+            
+            Json::Value players(Json::arrayValue);
+            for (int i = 0; i < 8; i++) {
+                const auto& slot = room->get_slot(i);
+                if (!slot.occupied || slot.client_fd == fd) continue;
+                
+                Json::Value p;
+                p["slot_idx"] = i;
+                p["client_id"] = slot.client_id;
+                p["display_name"] = slot.display_name;
+                if (slot.eliminated) {
+                    p["eliminated"] = true;
+                } else {
+                    auto metrics = room->get_player_metrics(slot.client_fd);
+                    p["word_idx"] = metrics.word_idx;
+                    p["progress"] = metrics.progress;
+                    p["wpm"] = metrics.wpm;
+                }
+                players.append(p);
+            }
+            game["players"] = players;
+            self = room->get_live_player(fd);
+        }
+    }
+    
+    if (!game.isNull()) {
+        PlayerMetrics metrics = self ? self->metrics() : PlayerMetrics{};
+        Json::Value me;
+        me["word_idx"] = metrics.word_idx;
+        me["latest_time_ms"] = (Json::Int64)metrics.latest_time_ms;
+        me["wpm"] = metrics.wpm;
+        me["accuracy"] = metrics.accuracy;
+        me["events_applied"] = self ? self->events_applied : 0;
+        game["self"] = me;
+        snap["game"] = game;
+    }
+    return snap;
 }
 
 // ========== Message handlers ==========
@@ -289,6 +1289,7 @@ void Server::on_set_username(int fd, const Json::Value& msg) {
 }
 
 void Server::on_create_room(int fd) {
+    matchmaking_.remove(fd);
     if (room_manager_.get_room_of_fd(fd)) {
         Json::Value err;
         err["type"] = "error";
@@ -324,6 +1325,27 @@ void Server::on_join_room(int fd, const Json::Value& msg) {
     
     std::string room_id = msg["room_id"].asString();
     std::string err_msg;
+    matchmaking_.remove(fd);
+    
+    // Codes are case-insensitive: compare against the room's own id
+    Room* target = room_manager_.find_room(room_id);
+    if (target && tournament_.owns_room(target->id())) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "TOURNAMENT_ROOM";
+        err["message"] = "Tournament rooms can only be watched";
+        send_json(fd, err);
+        return;
+    }
+    auto target_game = target ? room_games_.find(target->id()) : room_games_.end();
+    if (target_game != room_games_.end() && std::holds_alternative<SurvivalMode>(target_game->second)) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "GAME_IN_PROGRESS";
+        err["message"] = "Survival game in progress, spectate instead";
+        send_json(fd, err);
+        return;
+    }
     
     Room* room = room_manager_.join_room(room_id, fd, clients_[fd].client_id, 
                                          clients_[fd].display_name, err_msg);
@@ -341,6 +1363,18 @@ void Server::on_join_room(int fd, const Json::Value& msg) {
 }
 
 void Server::on_join_random(int fd) {
+    if (matchmaking_.config().enabled && !room_manager_.get_room_of_fd(fd)) {
+        double wpm = skill_wpm(fd);
+        matchmaking_.enqueue(fd, wpm, get_server_time_ms());
+        
+        Json::Value info;
+        info["type"] = "info";
+        info["code"] = "QUEUED";
+        info["message"] = "Searching for players near " + std::to_string((int)wpm) + " WPM";
+        send_json(fd, info);
+        return;
+    }
+    
     Room* room = room_manager_.join_random(fd, clients_[fd].client_id, 
                                            clients_[fd].display_name);
     
@@ -356,9 +1390,255 @@ void Server::on_join_random(int fd) {
     broadcast_room_state(room);
 }
 
+void Server::on_queue_leave(int fd) {
+    if (!matchmaking_.remove(fd)) return;
+    
+    Json::Value info;
+    info["type"] = "info";
+    info["code"] = "QUEUE_LEFT";
+    info["message"] = "Left the matchmaking queue";
+    send_json(fd, info);
+}
+
+void Server::run_matchmaking(int64_t now_ms) {
+    for (const auto& group : matchmaking_.tick(now_ms)) {
+        int host = group[0];
+        Room* room = room_manager_.create_room(host, clients_[host].client_id,
+                                               clients_[host].display_name);
+        if (!room) {
+            // No room free (max rooms): back in the queue with the time
+            // they already waited, so max_wait_ms still hands them back
+            for (int fd : group) {
+                matchmaking_.requeue(fd);
+            }
+            continue;
+        }
+        
+        std::string err_msg;
+        for (size_t i = 1; i < group.size(); i++) {
+            int fd = group[i];
+            if (!room_manager_.join_room(room->id(), fd, clients_[fd].client_id,
+                                         clients_[fd].display_name, err_msg)) {
+                matchmaking_.requeue(fd);
+            }
+        }
+        
+        LOG_INFO("matchmaking", "Formed room").field("room", room->id())
+            .field("players", room->player_count());
+        broadcast_room_state(room);
+    }
+    
+    // Nobody close enough in time: fall back to any open room, else host one
+    for (int fd : matchmaking_.take_expired(now_ms)) {
+        Room* room = room_manager_.join_random(fd, clients_[fd].client_id,
+                                               clients_[fd].display_name);
+        if (!room) {
+            room = room_manager_.create_room(fd, clients_[fd].client_id,
+                                             clients_[fd].display_name);
+        }
+        if (!room) {
+            Json::Value err;
+            err["type"] = "error";
+            err["code"] = "NO_AVAILABLE_ROOM";
+            err["message"] = "No room available, try again later";
+            send_json(fd, err);
+            continue;
+        }
+        broadcast_room_state(room);
+    }
+}
+
+// ========== Tournament ==========
+
+void Server::on_tournament_join(int fd) {
+    if (!tournament_.config().enabled) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "TOURNAMENT_DISABLED";
+        err["message"] = "Tournaments are not enabled on this server";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (!tournament_.enter(fd, skill_wpm(fd), get_server_time_ms())) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "TOURNAMENT_CLOSED";
+        err["message"] = tournament_.is_entrant(fd) ? "Already entered" : "Tournament already started";
+        send_json(fd, err);
+        return;
+    }
+    
+    Json::Value update;
+    update["type"] = "tournament_update";
+    update["event"] = "registered";
+    update["starts_at_ms"] = (Json::Int64)tournament_.starts_at_ms();
+    update["entrants"] = (int)tournament_.entrant_count();
+    send_json(fd, update);
+}
+
+void Server::on_tournament_leave(int fd) {
+    if (!tournament_.leave(fd)) return;
+    
+    Json::Value info;
+    info["type"] = "info";
+    info["code"] = "TOURNAMENT_LEFT";
+    info["message"] = "Left the tournament";
+    send_json(fd, info);
+}
+
+void Server::run_tournament(int64_t now_ms) {
+    if (tournament_.ready_to_start(now_ms)) {
+        start_tournament_round();
+        return;
+    }
+    if (tournament_.phase() != Tournament::Phase::Running) return;
+    
+    // Games end on the clock in run_games; a room emptied by leavers has
+    // nothing to report
+    for (const auto& room_id : tournament_.round_rooms()) {
+        if (!tournament_.room_finished(room_id) && !room_manager_.find_room(room_id)) {
+            tournament_.finish_room(room_id, {});
+        }
+    }
+    
+    if (tournament_.round_complete()) {
+        close_tournament_round(now_ms);
+    }
+}
+
+void Server::start_tournament_round() {
+    auto groups = tournament_.seed_round();
+    
+    // One corpus fetch for the whole round: every room types the same text
+    std::shared_ptr<const Paragraph> paragraph = room_manager_.random_paragraph();
+    
+    std::vector<Room*> rooms;
+    rooms.reserve(groups.size());
+    for (const auto& group : groups) {
+        for (int fd : group) {
+            leave_lobby(fd);
+        }
+        
+        // Entrants still parked get their seat too, under their placeholder.
+        // The first one still around hosts; anyone left without a seat (no
+        // room could be opened) forfeits instead of waiting for nothing.
+        Room* room = nullptr;
+        std::string err_msg;
+        for (int fd : group) {
+            const ClientInfo* client = find_client(fd);
+            if (!client) {
+                tournament_.leave(fd);
+                continue;
+            }
+            Room* seat = room ? room_manager_.join_room(room->id(), fd, client->client_id,
+                                                        client->display_name, err_msg)
+                              : room_manager_.create_room(fd, client->client_id,
+                                                          client->display_name, paragraph);
+            if (!seat) {
+                tournament_.leave(fd);
+                Json::Value err;
+                err["type"] = "error";
+                err["code"] = "TOURNAMENT_NO_ROOM";
+                err["message"] = "No room could be opened for your round; you are out of the tournament";
+                send_json(fd, err);
+                continue;
+            }
+            room = seat;
+        }
+        if (!room) continue;
+        room_manager_.set_private(room, true);
+        tournament_.add_room(room->id());
+        rooms.push_back(room);
+    }
+    
+    // Lockstep: one server_start_ms for every room of the round
+    int64_t start = get_server_time_ms();
+    for (Room* room : rooms) {
+        ModeGame& game = start_room_game(room, ArenaMode(room_manager_, room));
+        mode_init(game, start, tournament_.config().round_ms);
+    }
+    
+    Json::Value update;
+    update["type"] = "tournament_update";
+    update["event"] = "round_start";
+    update["round"] = tournament_.round();
+    update["rooms"] = (int)rooms.size();
+    update["entrants"] = (int)tournament_.entrant_count();
+    std::string update_line = json_line(update);
+    
+    for (Room* room : rooms) {
+        broadcast_line(room, update_line);
+        broadcast_room_state(room);
+        std::string line = room_game_init_line(room);
+        broadcast_line(room, line);
+        send_to_spectators(room, std::move(line), true);
+    }
+    
+    LOG_INFO("tournament", "Round started").field("round", tournament_.round())
+        .field("players", tournament_.entrant_count()).field("rooms", rooms.size());
+}
+
+void Server::close_tournament_round(int64_t now_ms) {
+    int round = tournament_.round();
+    size_t advancing = 0;
+    std::vector<TournamentStanding> standings = tournament_.close_round(now_ms, advancing);
+    
+    // Top of the table is the same for everyone; rank and outcome are not
+    Json::Value top(Json::arrayValue);
+    for (size_t i = 0; i < standings.size() && i < 10; i++) {
+        const auto& s = standings[i];
+        Json::Value entry;
+        entry["rank"] = s.rank;
+        entry["client_id"] = s.client_id;
+        entry["display_name"] = s.display_name;
+        entry["word_idx"] = s.word_idx;
+        entry["wpm"] = s.wpm;
+        top.append(entry);
+    }
+    
+    Json::Value update;
+    update["type"] = "tournament_update";
+    update["event"] = advancing > 0 ? "round_end" : "finished";
+    update["round"] = round;
+    update["field"] = (int)standings.size();
+    update["advancing"] = (int)advancing;
+    update["top"] = top;
+    if (advancing > 0) {
+        update["next_round_at_ms"] = (Json::Int64)tournament_.starts_at_ms();
+    }
+    
+    for (const auto& s : standings) {
+        update["rank"] = s.rank;
+        update["advanced"] = (size_t)s.rank <= advancing;
+        send_json(s.fd, update);
+    }
+    
+    LOG_INFO("tournament", "Round closed").field("round", round).field("ranked", standings.size())
+        .field("advancing", advancing)
+        .field("winner", advancing == 0 && !standings.empty() ? standings[0].display_name : "");
+}
+
+void Server::leave_lobby(int fd) {
+    matchmaking_.remove(fd);
+    room_manager_.stop_spectating(fd);
+    
+    if (room_manager_.get_room_of_fd(fd)) {
+        Room* room = room_manager_.remove_fd(fd);
+        if (room) {
+            broadcast_room_state(room);
+        }
+        notify_orphaned_spectators();
+    }
+    
+    training_games_.erase(fd);
+}
+
 void Server::on_exit_room(int fd) {
     Room* room = room_manager_.get_room_of_fd(fd);
     if (!room) {
+        // Spectators leave silently (room_state is not re-sent for them)
+        room_manager_.stop_spectating(fd);
         return;
     }
     
@@ -367,9 +1647,59 @@ void Server::on_exit_room(int fd) {
     
     // If room still exists (has players), broadcast new state
     if (room) {
-        std::cout << "[SERVER] Broadcasting room_state after exit_room\n";
         broadcast_room_state(room);
     }
+    notify_orphaned_spectators();
+}
+
+void Server::on_spectate(int fd, const Json::Value& msg) {
+    if (!msg.isMember("room_id") || !msg["room_id"].isString()) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "MISSING_FIELDS";
+        err["message"] = "room_id is required";
+        send_json(fd, err);
+        return;
+    }
+    
+    matchmaking_.remove(fd);
+    std::string err_msg;
+    Room* room = room_manager_.spectate(msg["room_id"].asString(), fd, err_msg);
+    if (!room) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = err_msg;
+        err["message"] = err_msg == "ROOM_NOT_FOUND" ? "Room not found" : "You are already in a room";
+        send_json(fd, err);
+        return;
+    }
+    
+    // From now on every write to this client goes through the fanout
+    auto& client = clients_[fd];
+    if (!client.via_fanout) {
+        client.via_fanout = true;
+        fanout_.add(fd);
+    }
+    
+    // Catch up: who is in the room and, mid-game, the text being typed.
+    // Players are not told about each new watcher; the count rides along
+    // on the next room_state / spectator game_state.
+    Json::Value state = room_state_json(room);
+    state["spectating"] = true;
+    send_json(fd, state);
+    if (room->is_game_started()) {
+        send_line(fd, room_game_init_line(room));
+    }
+}
+
+void Server::notify_orphaned_spectators() {
+    for (int fd : room_manager_.take_orphaned_spectators()) {
+        Json::Value info;
+        info["type"] = "info";
+        info["code"] = "ROOM_CLOSED";
+        info["message"] = "The room you were watching has closed";
+        send_json(fd, info);
+    }
 }
 
 void Server::on_ready(int fd) {
@@ -408,271 +1738,491 @@ void Server::on_set_private(int fd, const Json::Value& msg) {
         return;
     }
     
-    if (!room->is_host(fd)) {
-        Json::Value err;
-        err["type"] = "error";
-        err["code"] = "NOT_HOST";
-        err["message"] = "Only host can change privacy";
-        send_json(fd, err);
-        return;
+    if (!room->is_host(fd)) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "NOT_HOST";
+        err["message"] = "Only host can change privacy";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (tournament_.owns_room(room->id())) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "TOURNAMENT_ROOM";
+        err["message"] = "Tournament rooms stay private";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (!msg.isMember("is_private") || !msg["is_private"].isBool()) {
+        return;
+    }
+    
+    room_manager_.set_private(room, msg["is_private"].asBool());
+    broadcast_room_state(room);
+}
+
+void Server::on_start_game(int fd, const Json::Value& msg) {
+    Room* room = room_manager_.get_room_of_fd(fd);
+    if (!room) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "NOT_IN_ROOM";
+        err["message"] = "You are not in a room";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (!room->is_host(fd)) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "NOT_HOST";
+        err["message"] = "Only host can start game";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (tournament_.owns_room(room->id())) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "TOURNAMENT_ROOM";
+        err["message"] = "Tournament rounds are started by the server";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (!room->can_start()) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "CANNOT_START";
+        err["message"] = "Cannot start: need at least 2 players, all ready";
+        send_json(fd, err);
+        return;
+    }
+    
+    if (msg.isMember("mode") && msg["mode"].asString() == "survival") {
+        if (room->player_count() < survival_config_.min_players) {
+            Json::Value err;
+            err["type"] = "error";
+            err["code"] = "CANNOT_START";
+            err["message"] = "Survival needs at least " + std::to_string(survival_config_.min_players) + " players";
+            send_json(fd, err);
+            return;
+        }
+        
+        ModeGame& game = start_room_game(room, SurvivalMode(room_manager_, room, survival_config_));
+        mode_init(game, get_server_time_ms(), 0);
+        
+        std::string line = room_game_init_line(room);
+        broadcast_line(room, line);
+        send_to_spectators(room, std::move(line), true);
+        return;
+    }
+    
+    int duration_ms = 50000; // default
+    if (msg.isMember("duration_ms") && msg["duration_ms"].isInt()) {
+        duration_ms = msg["duration_ms"].asInt();
+    }
+    
+    ModeGame& game = start_room_game(room, ArenaMode(room_manager_, room));
+    mode_init(game, get_server_time_ms(), duration_ms);
+    
+    // Send game_init (the same bytes to players and spectators)
+    std::string line = room_game_init_line(room);
+    broadcast_line(room, line);
+    send_to_spectators(room, std::move(line), true);
+}
+
+std::string Server::room_game_init_line(Room* room) {
+    Json::Value init;
+    init["type"] = "game_init";
+    init["room_id"] = room->id();
+    init["server_start_ms"] = (Json::Int64)room->game_start_time();
+    init["duration_ms"] = room->game_duration();
+    
+    auto game_it = room_games_.find(room->id());
+    if (game_it != room_games_.end()) {
+        if (auto* survival = std::get_if<SurvivalMode>(&game_it->second)) {
+            init["mode"] = "survival";
+            init["stage"] = survival->stage();
+        }
+    }
+    
+    Json::Value players(Json::arrayValue);
+    for (int i = 0; i < 8; i++) {
+        const auto& slot = room->get_slot(i);
+        if (slot.occupied && !slot.eliminated) {
+            Json::Value p;
+            p["slot_idx"] = i;
+            p["client_id"] = slot.client_id;
+            p["display_name"] = slot.display_name;
+            players.append(p);
+        }
+    }
+    init["players"] = players;
+    
+    return game_init_line(init, room->paragraph());
+}
+
+void Server::on_input(int fd, const Json::Value& msg) {
+    if (!msg.isMember("word_idx") || !msg["word_idx"].isInt() ||
+        !msg.isMember("char_events") || !msg["char_events"].isArray()) {
+        return;
+    }
+    
+    ModeInput input;
+    input.word_idx = msg["word_idx"].asInt();
+    input.events = &msg["char_events"];
+    on_game_input(fd, input, true);
+}
+
+void Server::on_input_batch(int fd, const Json::Value& msg) {
+    if (!msg.isMember("events") || !msg["events"].isArray()) {
+        return;
+    }
+    
+    ModeInput input;
+    input.events = &msg["events"];
+    on_game_input(fd, input, false);
+}
+
+// ========== Mode engine ==========
+
+ModeGame* Server::game_of(int fd) {
+    auto training_it = training_games_.find(fd);
+    if (training_it != training_games_.end()) {
+        return &training_it->second;
+    }
+    
+    Room* room = room_manager_.get_room_of_fd(fd);
+    if (!room || !room->is_game_started()) {
+        return nullptr;
+    }
+    auto game_it = room_games_.find(room->id());
+    return game_it != room_games_.end() ? &game_it->second : nullptr;
+}
+
+template <typename Mode>
+ModeGame& Server::start_room_game(Room* room, Mode mode) {
+    room_games_.erase(room->id());
+    return room_games_.try_emplace(room->id(), std::in_place_type<Mode>, std::move(mode)).first->second;
+}
+
+void Server::on_game_input(int fd, const ModeInput& input, bool force_broadcast) {
+    ModeGame* game = game_of(fd);
+    if (!game) return;
+    
+    mode_input(*game, fd, input);
+    
+    if (auto* training = std::get_if<TrainingMode>(game)) {
+        send_training_state(fd, *training);
+    } else {
+        after_room_input(mode_room(*game), force_broadcast);
+    }
+    
+    if (mode_should_end(*game, get_server_time_ms())) {
+        end_mode_game(*game);
+    }
+}
+
+void Server::run_games(int64_t now_ms) {
+    // Games end on the clock even when nobody types
+    for (auto it = room_games_.begin(); it != room_games_.end(); ) {
+        // Closed (or recycled) room: nobody is left to play
+        Room* room = room_manager_.find_room(it->first);
+        if (!room || room != mode_room(it->second) || !room->is_game_started()) {
+            it = room_games_.erase(it);
+            continue;
+        }
+        auto next = std::next(it);
+        mode_tick(it->second, now_ms);
+        if (mode_should_end(it->second, now_ms)) {
+            end_mode_game(it->second);  // may erase `it`
+        }
+        it = next;
+    }
+    
+    for (auto it = training_games_.begin(); it != training_games_.end(); ) {
+        auto next = std::next(it);
+        mode_tick(it->second, now_ms);
+        if (mode_should_end(it->second, now_ms)) {
+            end_mode_game(it->second);
+        }
+        it = next;
+    }
+}
+
+void Server::end_mode_game(ModeGame& game, bool outright) {
+    if (std::holds_alternative<ArenaMode>(game)) {
+        finish_room_game(game);
+    } else if (std::holds_alternative<SurvivalMode>(game)) {
+        if (outright) {
+            finish_survival(game);
+        } else {
+            end_survival_stage(game);
+        }
+    } else {
+        finish_training(game);
+    }
+}
+
+Json::Value Server::ranking_json(const RankingEntry& r) {
+    Json::Value rank_entry;
+    rank_entry["rank"] = r.rank;
+    rank_entry["slot_idx"] = r.slot_idx;
+    rank_entry["client_id"] = r.client_id;
+    rank_entry["display_name"] = r.display_name;
+    rank_entry["word_idx"] = r.word_idx;
+    rank_entry["latest_time_ms"] = (Json::Int64)r.latest_time_ms;
+    rank_entry["wpm"] = r.wpm;
+    rank_entry["accuracy"] = r.accuracy;
+    return rank_entry;
+}
+
+void Server::send_training_state(int fd, const TrainingMode& training) {
+    PlayerMetrics metrics = training.metrics();
+    
+    // Send game_state
+    Json::Value state;
+    state["type"] = "game_state";
+    state["room_id"] = "training";
+    state["server_now_ms"] = (Json::Int64)get_server_time_ms();
+    state["duration_ms"] = training.duration_ms();
+    state["ended"] = false;
+    
+    Json::Value players_arr(Json::arrayValue);
+    for (int i = 0; i < 8; i++) {
+        Json::Value p;
+        p["slot_idx"] = i;
+        p["occupied"] = (i == 0);
+        
+        if (i == 0) {
+            p["word_idx"] = metrics.word_idx;
+            p["latest_time_ms"] = (Json::Int64)metrics.latest_time_ms;
+            p["progress"] = metrics.progress;
+            p["wpm"] = metrics.wpm;
+            p["accuracy"] = metrics.accuracy;
+        }
+        
+        players_arr.append(p);
+    }
+    state["players"] = players_arr;
+    
+    send_json(fd, state);
+}
+
+void Server::finish_training(ModeGame& game) {
+    TrainingMode& training = std::get<TrainingMode>(game);
+    int fd = training.fd();
+    PlayerMetrics metrics = training.metrics();
+    
+    Json::Value end;
+    end["type"] = "game_end";
+    end["room_id"] = "training";
+    end["reason"] = metrics.word_idx >= training.paragraph().total_words() ? "all_finished" : "timeout";
+    
+    Json::Value ranks(Json::arrayValue);
+    for (const auto& r : mode_rankings(game)) {
+        ranks.append(ranking_json(r));
+    }
+    end["rankings"] = ranks;
+    
+    send_json(fd, end);
+    
+    // Save result to database if user is logged in (on db_jobs_, this may
+    // be the tick thread)
+    const ClientInfo* client = find_client(fd);
+    if (client && client->user_id > 0) {
+        int64_t user_id = client->user_id;
+        int actual_duration_ms = metrics.latest_time_ms - training.start_time_ms();
+        
+        db_jobs_.post([db = room_manager_.db(), user_id, text = training.paragraph().text(),
+                       metrics, actual_duration_ms] {
+            bool saved = db->save_training_result(
+                user_id,
+                text,
+                metrics.wpm,
+                metrics.accuracy,
+                actual_duration_ms,
+                metrics.word_idx
+            );
+            
+            if (saved) {
+                LOG_INFO("server", "Training result saved").field("user_id", user_id)
+                    .field("wpm", metrics.wpm).field("accuracy", metrics.accuracy);
+            } else {
+                LOG_ERROR("server", "Failed to save training result").field("user_id", user_id);
+            }
+        });
     }
     
-    if (!msg.isMember("is_private") || !msg["is_private"].isBool()) {
-        return;
+    update_skill(fd, metrics.wpm);
+    
+    // Hand keystroke stats to the analytics batcher (no DB work here)
+    if (client) {
+        analytics_.submit(client->user_id, training.keystrokes());
     }
     
-    room->set_private(msg["is_private"].asBool());
-    broadcast_room_state(room);
+    // Clean up training session (closes its replay)
+    training_games_.erase(fd);
 }
 
-void Server::on_start_game(int fd, const Json::Value& msg) {
-    Room* room = room_manager_.get_room_of_fd(fd);
-    if (!room) {
-        Json::Value err;
-        err["type"] = "error";
-        err["code"] = "NOT_IN_ROOM";
-        err["message"] = "You are not in a room";
-        send_json(fd, err);
-        return;
+void Server::after_room_input(Room* room, bool force_broadcast) {
+    // Streamed batches arrive every ~100 ms from every player; coalesce
+    // them so the room sees no more game_states than with per-word input
+    int64_t now = get_server_time_ms();
+    if (force_broadcast || now - room->last_state_broadcast_ms() >= kStateBroadcastIntervalMs) {
+        room->set_last_state_broadcast_ms(now);
+        broadcast_game_state(room);
     }
+}
+
+void Server::finish_room_game(ModeGame& game) {
+    Room* room = mode_room(game);
     
-    if (!room->is_host(fd)) {
-        Json::Value err;
-        err["type"] = "error";
-        err["code"] = "NOT_HOST";
-        err["message"] = "Only host can start game";
-        send_json(fd, err);
-        return;
-    }
+    Json::Value end;
+    end["type"] = "game_end";
+    end["room_id"] = room->id();
+    end["reason"] = room->all_finished() ? "all_finished" : "timeout";
     
-    if (!room->can_start()) {
-        Json::Value err;
-        err["type"] = "error";
-        err["code"] = "CANNOT_START";
-        err["message"] = "Cannot start: need at least 2 players, all ready";
-        send_json(fd, err);
-        return;
-    }
+    bool tournament_room = tournament_.owns_room(room->id());
+    std::vector<TournamentStanding> standings;
     
-    int duration_ms = 50000; // default
-    if (msg.isMember("duration_ms") && msg["duration_ms"].isInt()) {
-        duration_ms = msg["duration_ms"].asInt();
+    Json::Value ranks(Json::arrayValue);
+    for (const auto& r : mode_rankings(game)) {
+        ranks.append(ranking_json(r));
+        
+        int fd = room->get_slot(r.slot_idx).client_fd;
+        update_skill(fd, r.wpm);
+        if (tournament_room) {
+            standings.push_back({fd, r.client_id, r.display_name, r.word_idx,
+                                 r.latest_time_ms, r.wpm, r.accuracy, 0});
+        }
     }
+    end["rankings"] = ranks;
     
-    room->start_game(get_server_time_ms(), duration_ms);
-    
-    // Send game_init
-    Json::Value init;
-    init["type"] = "game_init";
-    init["room_id"] = room->id();
-    init["server_start_ms"] = (Json::Int64)room->game_start_time();
-    init["duration_ms"] = duration_ms;
-    init["paragraph"] = room->paragraph();
-    init["total_words"] = room->total_words();
+    broadcast_json(room, end);
     
-    Json::Value players(Json::arrayValue);
+    // Hand keystroke stats to the analytics batcher (no DB work here)
     for (int i = 0; i < 8; i++) {
         const auto& slot = room->get_slot(i);
-        if (slot.occupied) {
-            Json::Value p;
-            p["slot_idx"] = i;
-            p["client_id"] = slot.client_id;
-            p["display_name"] = slot.display_name;
-            players.append(p);
+        if (!slot.occupied) continue;
+        
+        const ClientInfo* client = find_client(slot.client_fd);
+        const KeystrokeStats* stats = room->get_keystroke_stats(slot.client_fd);
+        if (client && stats) {
+            analytics_.submit(client->user_id, *stats);
         }
     }
-    init["players"] = players;
     
-    broadcast_json(room, init);
+    room_games_.erase(room->id());
+    room_manager_.end_game(room);
+    
+    // Send updated room_state after game ends (all players unready)
+    broadcast_room_state(room);
+    
+    if (tournament_room) {
+        tournament_.finish_room(room->id(), std::move(standings));
+    }
 }
 
-void Server::on_input(int fd, const Json::Value& msg) {
-    // Check if this is training mode
-    auto training_it = training_sessions_.find(fd);
-    if (training_it != training_sessions_.end()) {
-        // Training mode input handling
-        if (!msg.isMember("word_idx") || !msg["word_idx"].isInt() ||
-            !msg.isMember("char_events") || !msg["char_events"].isArray()) {
-            return;
-        }
-        
-        int word_idx = msg["word_idx"].asInt();
-        const Json::Value& char_events = msg["char_events"];
-        
-        auto& session = training_it->second;
-        auto& metrics = session.metrics;
-        
-        // Update word_idx
-        if (word_idx >= metrics.word_idx) {
-            metrics.word_idx = word_idx + 1; // Next word index
-        }
-        
-        // Get the target word for accuracy calculation
-        std::string target_word = "";
-        if (word_idx >= 0 && word_idx < (int)session.paragraph_words.size()) {
-            target_word = session.paragraph_words[word_idx];
-        }
-        
-        // Calculate metrics from char_events (same logic as Room)
-        int correct_chars = 0;
-        int total_chars = 0;
-        std::string typed_word = "";
-        
-        for (const auto& event : char_events) {
-            std::string event_type = event["type"].asString();
-            
-            if (event_type == "char") {
-                std::string ch = event["char"].asString();
-                if (!ch.empty()) {
-                    typed_word += ch[0];
-                    total_chars++;
-                }
-            } else if (event_type == "backspace") {
-                if (!typed_word.empty()) {
-                    typed_word.pop_back();
-                }
-            }
-            
-            if (event.isMember("time_ms")) {
-                metrics.latest_time_ms = event["time_ms"].asInt64();
-            }
-        }
-        
-        // Calculate correct chars by comparing typed_word with target_word
-        size_t min_len = std::min(typed_word.length(), target_word.length());
-        for (size_t i = 0; i < min_len; i++) {
-            if (typed_word[i] == target_word[i]) {
-                correct_chars++;
-            }
-        }
-        
-        // Update cumulative stats
-        metrics.total_correct_chars += correct_chars;
-        metrics.total_chars_typed += total_chars;
-        
-        // Calculate progress
-        metrics.progress = (double)metrics.word_idx / session.total_words;
-        
-        // Calculate WPM (based on total correct chars typed so far)
-        if (metrics.latest_time_ms > session.start_time_ms) {
-            double elapsed_ms = metrics.latest_time_ms - session.start_time_ms;
-            double elapsed_minutes = elapsed_ms / 60000.0;
-            if (elapsed_minutes > 0) {
-                metrics.wpm = (metrics.total_correct_chars / 5.0) / elapsed_minutes;
-            }
-        }
-        
-        // Calculate accuracy (cumulative)
-        if (metrics.total_chars_typed > 0) {
-            metrics.accuracy = (metrics.total_correct_chars * 100.0) / metrics.total_chars_typed;
-        } else {
-            metrics.accuracy = 100.0;
-        }
-        
-        // Send game_state
-        Json::Value state;
-        state["type"] = "game_state";
-        state["room_id"] = "training";
-        state["server_now_ms"] = (Json::Int64)get_server_time_ms();
-        state["duration_ms"] = session.duration_ms;
-        state["ended"] = false;
-        
-        Json::Value players_arr(Json::arrayValue);
-        for (int i = 0; i < 8; i++) {
-            Json::Value p;
-            p["slot_idx"] = i;
-            p["occupied"] = (i == 0);
-            
-            if (i == 0) {
-                p["word_idx"] = metrics.word_idx;
-                p["latest_time_ms"] = (Json::Int64)metrics.latest_time_ms;
-                p["progress"] = metrics.progress;
-                p["wpm"] = metrics.wpm;
-                p["accuracy"] = metrics.accuracy;
-            }
-            
-            players_arr.append(p);
-        }
-        state["players"] = players_arr;
-        
-        send_json(fd, state);
-        
-        // Check if game ended (timeout or finished)
-        int64_t elapsed = get_server_time_ms() - session.start_time_ms;
-        bool timeout = (elapsed >= session.duration_ms);
-        bool finished = (metrics.word_idx >= session.total_words);
+// ========== Survival ==========
+
+void Server::end_survival_stage(ModeGame& game) {
+    SurvivalMode& survival = std::get<SurvivalMode>(game);
+    Room* room = survival.room();
+    
+    // Every stage is a game of its own for the keystroke tables
+    for (int i = 0; i < 8; i++) {
+        const auto& slot = room->get_slot(i);
+        if (!slot.occupied || slot.eliminated) continue;
         
-        if (timeout || finished) {
-            Json::Value end;
-            end["type"] = "game_end";
-            end["room_id"] = "training";
-            end["reason"] = finished ? "all_finished" : "timeout";
-            
-            Json::Value ranks(Json::arrayValue);
-            Json::Value rank_entry;
-            rank_entry["rank"] = 1;
-            rank_entry["slot_idx"] = 0;
-            rank_entry["client_id"] = fd;
-            rank_entry["display_name"] = session.display_name;
-            rank_entry["word_idx"] = metrics.word_idx;
-            rank_entry["latest_time_ms"] = (Json::Int64)metrics.latest_time_ms;
-            rank_entry["wpm"] = metrics.wpm;
-            rank_entry["accuracy"] = metrics.accuracy;
-            ranks.append(rank_entry);
-            end["rankings"] = ranks;
-            
-            send_json(fd, end);
-            
-            // Save result to database if user is logged in
-            auto client_it = clients_.find(fd);
-            if (client_it != clients_.end() && client_it->second.user_id > 0) {
-                int64_t user_id = client_it->second.user_id;
-                int actual_duration_ms = metrics.latest_time_ms - session.start_time_ms;
-                
-                std::cout << "[Server] Saving training result for user_id=" << user_id 
-                          << " WPM=" << metrics.wpm << " ACC=" << metrics.accuracy << "%\n";
-                
-                bool saved = room_manager_.db()->save_training_result(
-                    user_id,
-                    session.paragraph,
-                    metrics.wpm,
-                    metrics.accuracy,
-                    actual_duration_ms,
-                    metrics.word_idx
-                );
-                
-                if (saved) {
-                    std::cout << "[Server] Training result saved successfully\n";
-                } else {
-                    std::cout << "[Server] Failed to save training result\n";
-                }
-            }
-            
-            // Clean up training session
-            training_sessions_.erase(training_it);
+        const ClientInfo* client = find_client(slot.client_fd);
+        const KeystrokeStats* stats = room->get_keystroke_stats(slot.client_fd);
+        if (client && stats) {
+            analytics_.submit(client->user_id, *stats);
         }
-        
-        return;
     }
     
-    // Arena mode input handling
-    Room* room = room_manager_.get_room_of_fd(fd);
-    if (!room || !room->is_game_started()) {
-        return;
+    std::vector<SurvivalScore> cut = survival.end_stage();
+    
+    Json::Value out(Json::arrayValue);
+    for (const auto& score : cut) {
+        const auto& slot = room->get_slot(score.slot_idx);
+        Json::Value entry;
+        entry["slot_idx"] = score.slot_idx;
+        entry["client_id"] = slot.client_id;
+        entry["display_name"] = slot.display_name;
+        entry["word_idx"] = score.word_idx;
+        entry["wpm"] = score.wpm;
+        out.append(entry);
     }
     
-    if (!msg.isMember("word_idx") || !msg["word_idx"].isInt() ||
-        !msg.isMember("char_events") || !msg["char_events"].isArray()) {
+    Json::Value stage_end;
+    stage_end["type"] = "survival_stage_end";
+    stage_end["room_id"] = room->id();
+    stage_end["stage"] = survival.stage();
+    stage_end["eliminated"] = out;
+    stage_end["survivors"] = room->alive_count();
+    broadcast_json(room, stage_end);
+    
+    if (survival.finished()) {
+        finish_survival(game);
         return;
     }
     
-    int word_idx = msg["word_idx"].asInt();
-    const Json::Value& events = msg["char_events"];
+    survival.next_stage(get_server_time_ms() + survival_config_.break_ms);
+    
+    std::string line = room_game_init_line(room);
+    broadcast_line(room, line);
+    send_to_spectators(room, std::move(line), true);
+}
+
+void Server::finish_survival(ModeGame& game) {
+    const SurvivalMode& survival = std::get<SurvivalMode>(game);
+    Room* room = survival.room();
+    
+    Json::Value end;
+    end["type"] = "game_end";
+    end["room_id"] = room->id();
+    end["reason"] = "survival";
+    end["stages"] = survival.stage();
+    
+    Json::Value ranks(Json::arrayValue);
+    for (const auto& r : mode_rankings(game)) {
+        Json::Value rank_entry = ranking_json(r);
+        rank_entry["eliminated_stage"] = survival.eliminated_stage(r.slot_idx);
+        ranks.append(rank_entry);
+    }
+    end["rankings"] = ranks;
     
-    // Process input in typing engine
-    room->process_input(fd, word_idx, events);
+    broadcast_json(room, end);
     
-    // Broadcast game_state
+    room_games_.erase(room->id());
+    room_manager_.end_game(room);
+    broadcast_room_state(room);
+}
+
+void Server::broadcast_game_state(Room* room) {
+    broadcast_line(room, json_line(game_state_json(room)));
+}
+
+void Server::push_spectator_states(int64_t now_ms) {
+    // Snapshots at a reduced rate; lossy, a lagging watcher just skips some
+    for (Room* room : room_manager_.watched_rooms()) {
+        if (!room->is_game_started()) continue;
+        if (now_ms - room->last_spectator_state_ms() < kSpectatorStateIntervalMs) continue;
+        room->set_last_spectator_state_ms(now_ms);
+        
+        Json::Value state = game_state_json(room);
+        state["spectators"] = (int)room->spectators().size();
+        send_to_spectators(room, json_line(state), false);
+    }
+}
+
+Json::Value Server::game_state_json(Room* room) {
     Json::Value state;
     state["type"] = "game_state";
     state["room_id"] = room->id();
@@ -687,7 +2237,9 @@ void Server::on_input(int fd, const Json::Value& msg) {
         p["slot_idx"] = i;
         p["occupied"] = slot.occupied;
         
-        if (slot.occupied) {
+        if (slot.eliminated) {
+            p["eliminated"] = true;
+        } else if (slot.occupied) {
             auto metrics = room->get_player_metrics(slot.client_fd);
             p["word_idx"] = metrics.word_idx;
             p["latest_time_ms"] = (Json::Int64)metrics.latest_time_ms;
@@ -699,44 +2251,13 @@ void Server::on_input(int fd, const Json::Value& msg) {
         players_arr.append(p);
     }
     state["players"] = players_arr;
-    
-    broadcast_json(room, state);
-    
-    // Check if game ended
-    if (room->is_game_ended(get_server_time_ms())) {
-        Json::Value end;
-        end["type"] = "game_end";
-        end["room_id"] = room->id();
-        end["reason"] = room->all_finished() ? "all_finished" : "timeout";
-        
-        auto rankings = room->get_rankings();
-        Json::Value ranks(Json::arrayValue);
-        for (const auto& r : rankings) {
-            Json::Value rank_entry;
-            rank_entry["rank"] = r.rank;
-            rank_entry["slot_idx"] = r.slot_idx;
-            rank_entry["client_id"] = r.client_id;
-            rank_entry["display_name"] = r.display_name;
-            rank_entry["word_idx"] = r.word_idx;
-            rank_entry["latest_time_ms"] = (Json::Int64)r.latest_time_ms;
-            rank_entry["wpm"] = r.wpm;
-            rank_entry["accuracy"] = r.accuracy;
-            ranks.append(rank_entry);
-        }
-        end["rankings"] = ranks;
-        
-        broadcast_json(room, end);
-        room->end_game();
-        
-        // Send updated room_state after game ends (all players unready)
-        broadcast_room_state(room);
-    }
+    return state;
 }
 
 void Server::on_start_training(int fd) {
     // Get random paragraph from database
-    std::string paragraph = room_manager_.db()->get_random_paragraph("en");
-    if (paragraph.empty()) {
+    std::shared_ptr<const Paragraph> paragraph = room_manager_.random_paragraph();
+    if (paragraph->text().empty()) {
         Json::Value err;
         err["type"] = "error";
         err["code"] = "NO_PARAGRAPH";
@@ -745,35 +2266,25 @@ void Server::on_start_training(int fd) {
         return;
     }
     
-    // Split paragraph into words
-    std::vector<std::string> words;
-    std::istringstream iss(paragraph);
-    std::string word;
-    while (iss >> word) {
-        words.push_back(word);
-    }
-    int total_words = words.size();
-    
     int duration_ms = 300000; // 5 minutes for training
     int64_t start_time = get_server_time_ms();
     
     // Get client display name
     std::string display_name = "Guest";
+    int client_id = 0;
     auto it = clients_.find(fd);
-    if (it != clients_.end() && !it->second.username.empty()) {
-        display_name = it->second.username;
+    if (it != clients_.end()) {
+        client_id = it->second.client_id;
+        if (!it->second.username.empty()) display_name = it->second.username;
     }
     
-    // Store training session with empty metrics
-    TrainingSession session;
-    session.paragraph = paragraph;
-    session.paragraph_words = words;
-    session.total_words = total_words;
-    session.start_time_ms = start_time;
-    session.duration_ms = duration_ms;
-    session.display_name = display_name;
-    session.metrics = PlayerMetrics();  // Initialize with default values
-    training_sessions_[fd] = session;
+    // Replace (and close) any previous unfinished session. Built in
+    // place: the scorer points into the mode.
+    training_games_.erase(fd);
+    ModeGame& game = training_games_.try_emplace(fd, std::in_place_type<TrainingMode>,
+                                                 fd, client_id, display_name, paragraph,
+                                                 &replay_writer_).first->second;
+    mode_init(game, start_time, duration_ms);
     
     // Send game_init
     Json::Value init;
@@ -781,8 +2292,6 @@ void Server::on_start_training(int fd) {
     init["room_id"] = "training";
     init["server_start_ms"] = (Json::Int64)start_time;
     init["duration_ms"] = duration_ms;
-    init["paragraph"] = paragraph;
-    init["total_words"] = total_words;
     
     Json::Value players(Json::arrayValue);
     Json::Value p;
@@ -792,7 +2301,7 @@ void Server::on_start_training(int fd) {
     players.append(p);
     init["players"] = players;
     
-    send_json(fd, init);
+    send_line(fd, game_init_line(init, *paragraph));
 }
 
 void Server::on_save_training_result(int fd, const Json::Value& msg) {
@@ -827,32 +2336,34 @@ void Server::on_save_training_result(int fd, const Json::Value& msg) {
     
     int64_t user_id = client_it->second.user_id;
     
-    std::cout << "[Server] Saving training result (post-login) for user_id=" << user_id 
-              << " WPM=" << wpm << " ACC=" << accuracy << "%\n";
-    
-    bool saved = room_manager_.db()->save_training_result(
-        user_id,
-        paragraph,
-        wpm,
-        accuracy,
-        duration_ms,
-        words_committed
-    );
-    
-    if (saved) {
-        std::cout << "[Server] Training result saved successfully\n";
-        Json::Value response;
-        response["type"] = "save_result_response";
-        response["success"] = true;
-        send_json(fd, response);
-    } else {
-        std::cout << "[Server] Failed to save training result\n";
-        Json::Value err;
-        err["type"] = "error";
-        err["code"] = "SAVE_FAILED";
-        err["message"] = "Failed to save training result";
-        send_json(fd, err);
-    }
+    defer_db([this, fd, db = room_manager_.db(), user_id, paragraph, wpm, accuracy,
+              duration_ms, words_committed] {
+        bool saved = db->save_training_result(
+            user_id,
+            paragraph,
+            wpm,
+            accuracy,
+            duration_ms,
+            words_committed
+        );
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (saved) {
+            LOG_INFO("server", "Training result saved after sign-in").field("user_id", user_id)
+                .field("wpm", wpm).field("accuracy", accuracy);
+            Json::Value response;
+            response["type"] = "save_result_response";
+            response["success"] = true;
+            send_json(fd, response);
+        } else {
+            LOG_ERROR("server", "Failed to save training result").field("user_id", user_id);
+            Json::Value err;
+            err["type"] = "error";
+            err["code"] = "SAVE_FAILED";
+            err["message"] = "Failed to save training result";
+            send_json(fd, err);
+        }
+    });
 }
 
 // ========== Authentication handlers ==========
@@ -870,45 +2381,49 @@ void Server::on_sign_in(int fd, const Json::Value& msg) {
     std::string username = msg["username"].asString();
     std::string password = msg["password"].asString();
     
-    // Call database function kbh_authenticate
-    auto result = room_manager_.db()->authenticate(username, password);
-    
-    if (result.first == -1) {
-        // Authentication failed
-        Json::Value err;
-        err["type"] = "sign_in_response";
-        err["success"] = false;
-        err["error"] = "Invalid username or password";
-        send_json(fd, err);
-        return;
-    }
-    
-    // Check if user is already logged in
-    if (is_user_logged_in(result.first)) {
-        Json::Value err;
-        err["type"] = "sign_in_response";
-        err["success"] = false;
-        err["error"] = "This account is already logged in";
-        send_json(fd, err);
-        std::cout << "[SERVER] Sign in rejected for " << username 
-                  << " - already logged in\n";
-        return;
-    }
-    
-    // Success - update client info
-    clients_[fd].user_id = result.first;
-    clients_[fd].username = result.second;
-    clients_[fd].display_name = result.second;
-    
-    Json::Value response;
-    response["type"] = "sign_in_response";
-    response["success"] = true;
-    response["user_id"] = (Json::Int64)result.first;
-    response["username"] = result.second;
-    send_json(fd, response);
-    
-    std::cout << "[SERVER] Client " << fd << " signed in as " << result.second 
-              << " (user_id=" << result.first << ")\n";
+    defer_db([this, fd, db = room_manager_.db(), username, password] {
+        // Call database function kbh_authenticate
+        auto result = db->authenticate(username, password);
+        double recent_wpm = result.first == -1 ? 0.0 : db->get_recent_wpm(result.first);
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (result.first == -1) {
+            // Authentication failed
+            Json::Value err;
+            err["type"] = "sign_in_response";
+            err["success"] = false;
+            err["error"] = "Invalid username or password";
+            send_json(fd, err);
+            return;
+        }
+        
+        // Check if user is already logged in
+        if (is_user_logged_in(result.first)) {
+            Json::Value err;
+            err["type"] = "sign_in_response";
+            err["success"] = false;
+            err["error"] = "This account is already logged in";
+            send_json(fd, err);
+            LOG_INFO("server", "Sign in rejected, already logged in").field("username", username);
+            return;
+        }
+        
+        // Success - update client info
+        clients_[fd].user_id = result.first;
+        clients_[fd].username = result.second;
+        clients_[fd].display_name = result.second;
+        clients_[fd].skill_wpm = recent_wpm;
+        
+        Json::Value response;
+        response["type"] = "sign_in_response";
+        response["success"] = true;
+        response["user_id"] = (Json::Int64)result.first;
+        response["username"] = result.second;
+        send_json(fd, response);
+        
+        LOG_INFO("server", "Signed in").field("fd", fd).field("username", result.second)
+            .field("user_id", result.first);
+    });
 }
 
 void Server::on_create_account(int fd, const Json::Value& msg) {
@@ -924,28 +2439,30 @@ void Server::on_create_account(int fd, const Json::Value& msg) {
     std::string username = msg["username"].asString();
     std::string password = msg["password"].asString();
     
-    // Call database function kbh_create_user
-    int64_t user_id = room_manager_.db()->create_user(username, password);
-    
-    if (user_id == -1) {
-        // Creation failed (likely duplicate username)
-        Json::Value err;
-        err["type"] = "create_account_response";
-        err["success"] = false;
-        err["error"] = "Username already exists";
-        send_json(fd, err);
-        return;
-    }
-    
-    // Success - don't auto-login, user must sign in
-    Json::Value response;
-    response["type"] = "create_account_response";
-    response["success"] = true;
-    response["username"] = username;
-    send_json(fd, response);
-    
-    std::cout << "[SERVER] New account created: " << username 
-              << " (user_id=" << user_id << ")\n";
+    defer_db([this, fd, db = room_manager_.db(), username, password] {
+        // Call database function kbh_create_user
+        int64_t user_id = db->create_user(username, password);
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (user_id == -1) {
+            // Creation failed (likely duplicate username)
+            Json::Value err;
+            err["type"] = "create_account_response";
+            err["success"] = false;
+            err["error"] = "Username already exists";
+            send_json(fd, err);
+            return;
+        }
+        
+        // Success - don't auto-login, user must sign in
+        Json::Value response;
+        response["type"] = "create_account_response";
+        response["success"] = true;
+        response["username"] = username;
+        send_json(fd, response);
+        
+        LOG_INFO("server", "Account created").field("username", username).field("user_id", user_id);
+    });
 }
 
 void Server::on_change_password(int fd, const Json::Value& msg) {
@@ -962,17 +2479,19 @@ void Server::on_change_password(int fd, const Json::Value& msg) {
     std::string old_password = msg["old_password"].asString();
     std::string new_password = msg["new_password"].asString();
     
-    // Call database function kbh_change_password
-    bool success = room_manager_.db()->change_password(username, old_password, new_password);
-    
-    Json::Value response;
-    response["type"] = "change_password_response";
-    response["success"] = success;
-    response["error"] = success ? "" : "Invalid old password";
-    send_json(fd, response);
-    
-    std::cout << "[SERVER] Password change for " << username 
-              << ": " << (success ? "success" : "failed") << "\n";
+    defer_db([this, fd, db = room_manager_.db(), username, old_password, new_password] {
+        // Call database function kbh_change_password
+        bool success = db->change_password(username, old_password, new_password);
+        
+        Json::Value response;
+        response["type"] = "change_password_response";
+        response["success"] = success;
+        response["error"] = success ? "" : "Invalid old password";
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        send_json(fd, response);
+        LOG_INFO("server", "Password change").field("username", username).field("success", success);
+    });
 }
 
 void Server::on_sign_out(int fd) {
@@ -981,15 +2500,13 @@ void Server::on_sign_out(int fd) {
         return;
     }
     
-    std::cout << "[SERVER] Client " << fd << " signing out";
-    if (it->second.user_id > 0) {
-        std::cout << " (user_id=" << it->second.user_id << ", username=" << it->second.username << ")";
-    }
-    std::cout << "\n";
+    LOG_INFO("server", "Signing out").field("fd", fd).field("user_id", it->second.user_id)
+        .field("username", it->second.username);
     
     // Clear user authentication
     it->second.user_id = 0;
     it->second.username.clear();
+    it->second.skill_wpm = 0.0;
     
     // Send confirmation
     Json::Value response;
@@ -1004,47 +2521,100 @@ void Server::on_leaderboard(int fd) {
         return;
     }
     
-    // Get top 8 players from last week
-    std::vector<LeaderboardEntry> top_players = room_manager_.db()->get_top_players(8);
-    
-    // Get self rank if user is logged in
-    LeaderboardEntry self_rank{0, "", 0.0};
-    if (it->second.user_id > 0) {
-        self_rank = room_manager_.db()->get_user_rank(it->second.user_id);
-    }
-    
-    // Build response
-    Json::Value response;
-    response["type"] = "leaderboard_response";
-    
-    // Add top 8
-    Json::Value top8(Json::arrayValue);
-    for (const auto& entry : top_players) {
-        Json::Value item;
-        item["rank"] = entry.rank;
-        item["username"] = entry.username;
-        item["wpm"] = entry.wpm;
-        top8.append(item);
-    }
-    response["top8"] = top8;
-    
-    // Add self rank (null if not found or guest)
-    if (self_rank.rank > 0) {
-        Json::Value self;
-        self["rank"] = self_rank.rank;
-        self["username"] = self_rank.username;
-        self["wpm"] = self_rank.wpm;
-        response["self_rank"] = self;
-    } else {
-        response["self_rank"] = Json::Value::null;
+    defer_db([this, fd, db = room_manager_.db(), user_id = it->second.user_id,
+              username = it->second.username] {
+        // Get top 8 players from last week
+        std::vector<LeaderboardEntry> top_players = db->get_top_players(8);
+        
+        // Get self rank if user is logged in
+        LeaderboardEntry self_rank{0, "", 0.0};
+        if (user_id > 0) {
+            self_rank = db->get_user_rank(user_id);
+        }
+        
+        // Build response
+        Json::Value response;
+        response["type"] = "leaderboard_response";
+        
+        // Add top 8
+        Json::Value top8(Json::arrayValue);
+        for (const auto& entry : top_players) {
+            Json::Value item;
+            item["rank"] = entry.rank;
+            item["username"] = entry.username;
+            item["wpm"] = entry.wpm;
+            top8.append(item);
+        }
+        response["top8"] = top8;
+        
+        // Add self rank (null if not found or guest)
+        if (self_rank.rank > 0) {
+            Json::Value self;
+            self["rank"] = self_rank.rank;
+            self["username"] = self_rank.username;
+            self["wpm"] = self_rank.wpm;
+            response["self_rank"] = self;
+        } else {
+            response["self_rank"] = Json::Value::null;
+        }
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        send_json(fd, response);
+        LOG_DEBUG("server", "Sent leaderboard").field("fd", fd).field("entries", top_players.size())
+            .field("username", username).field("rank", self_rank.rank);
+    });
+}
+
+void Server::on_profile(int fd) {
+    auto it = clients_.find(fd);
+    if (it == clients_.end() || it->second.user_id <= 0) {
+        Json::Value err;
+        err["type"] = "error";
+        err["code"] = "NOT_AUTHENTICATED";
+        err["message"] = "Must be logged in to view profile";
+        send_json(fd, err);
+        return;
     }
     
-    send_json(fd, response);
-    std::cout << "[SERVER] Sent leaderboard (top " << top_players.size() 
-              << " entries) to client " << fd;
-    if (it->second.user_id > 0) {
-        std::cout << " (user: " << it->second.username 
-                  << ", rank: " << (self_rank.rank > 0 ? std::to_string(self_rank.rank) : "unranked") << ")";
-    }
-    std::cout << "\n";
+    // Stored stats: a DB read, which may also wait for a flush in progress
+    defer_db([this, fd, user_id = it->second.user_id, username = it->second.username] {
+        KeystrokeStats stats = analytics_.load(user_id);
+        
+        // 26-entry key arrays and 26x26 bigram matrices, indexed 'a'..'z'
+        Json::Value response;
+        response["type"] = "profile_response";
+        response["user_id"] = (Json::Int64)user_id;
+        response["username"] = username;
+        
+        Json::Value key_samples(Json::arrayValue);
+        Json::Value key_mean_ms(Json::arrayValue);
+        Json::Value key_errors(Json::arrayValue);
+        Json::Value bigram_samples(Json::arrayValue);
+        Json::Value bigram_mean_ms(Json::arrayValue);
+        
+        for (int i = 0; i < KeystrokeStats::kKeys; i++) {
+            key_samples.append(stats.key_samples[i]);
+            key_mean_ms.append(stats.key_mean_ms[i]);
+            key_errors.append(stats.key_errors[i]);
+            
+            Json::Value samples_row(Json::arrayValue);
+            Json::Value mean_row(Json::arrayValue);
+            for (int j = 0; j < KeystrokeStats::kKeys; j++) {
+                samples_row.append(stats.bigram_samples[i][j]);
+                mean_row.append(stats.bigram_mean_ms[i][j]);
+            }
+            bigram_samples.append(samples_row);
+            bigram_mean_ms.append(mean_row);
+        }
+        
+        response["key_samples"] = key_samples;
+        response["key_mean_ms"] = key_mean_ms;
+        response["key_errors"] = key_errors;
+        response["bigram_samples"] = bigram_samples;
+        response["bigram_mean_ms"] = bigram_mean_ms;
+        
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        send_json(fd, response);
+        LOG_DEBUG("server", "Sent profile stats").field("fd", fd).field("username", username);
+    });
 }
@@ -2,25 +2,144 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <jsoncpp/json/json.h>
 #include "room_manager.h"
 #include "../database/database.h"
 #include "../typing_engine/typing_engine.h"
+#include "../analytics/keystroke_analytics.h"
+#include "../replay/replay_writer.h"
+#include "../matchmaking/matchmaking_queue.h"
+#include "spectator_fanout.h"
+#include "job_queue.h"
+#include "timer_wheel.h"
+#include "token_bucket.h"
+#include "server_settings.h"
+#include "../tournament/tournament.h"
+#include "../gamemode/mode_engine.h"
+#include "../metrics/metrics.h"
+#include "../trace/tracer.h"
+#include "../admin/admin_snapshot.h"
 
 class Server {
 public:
-    Server(const std::string& ip, int port, Database* db);
+    Server(const std::string& ip, int port, Database* db,
+           const std::string& replay_dir = "");
+    
+    // Accept loop; returns once a drain (below) has ended every game and
+    // closed every connection
     void start();
+    
+    // Hot restart: serve on the listening socket the previous process
+    // handed over instead of binding ip:port
+    void adopt_listener(int fd) { server_fd_ = fd; }
+    // Copy of the listening socket for a successor, or -1 once draining
+    int dup_listener();
+    
+    // Graceful shutdown, callable from any thread: stop accepting, send
+    // idle clients away, give running games until deadline_ms from now,
+    // then end the rest (results are saved as usual), flush pending
+    // keystroke stats and disconnect. Calling again moves the deadline.
+    void drain(int deadline_ms);
+    
+    // Swaps in new settings without locking; start() or the next tick
+    // applies them. Connection limits apply to open connections too (idle
+    // timers re-armed, socket options set again; a send buffer size stays
+    // on open sockets when the limit goes to 0), rate limits from the next
+    // message on, game timings from the next game.
+    // Over a rate limit set_username and set_private are coalesced (the
+    // latest applied when the bucket refills), other types are dropped.
+    void publish_settings(std::shared_ptr<const ServerSettings> settings);
+    // Latest published settings, from any thread
+    std::shared_ptr<const ServerSettings> settings() const { return std::atomic_load(&settings_); }
+    
+    // Consistent copy of rooms and clients for the admin socket. The next
+    // tick takes it while it holds the state lock anyway, so the caller
+    // never locks game state; nullptr if no tick answered within a second.
+    std::shared_ptr<const AdminSnapshot> admin_snapshot();
 
 private:
+    // tools/kbh_microbench.cpp times private handlers directly
+    friend class ServerBench;
+    
+    bool listen_on_port();
     void handle_client(int client_fd);
+    
+    // NDJSON framing: moves the first complete line out of buffer (trailing
+    // \r and spaces trimmed); false if there is none yet
+    static bool next_line(std::string& buffer, std::string& line);
+    static bool parse_message(const std::string& line, Json::Value& msg, std::string& errs);
+    
+    // Admission control (see ConnectionLimits); all under state_mutex_
+    void refuse_client(int fd);
+    void tune_client_socket(int fd);
+    void reap_idle_clients(int64_t now_ms);
+    void cut_client(int fd, const char* code, const std::string& message);
+    void flush_backlogs();  // from the tick: writes what sockets take now
+    
+    // Takes over a published snapshot; under state_mutex_
+    void apply_settings(const std::shared_ptr<const ServerSettings>& settings);
+    
+    // Rate limiting; false = not dispatched now (dropped or coalesced)
+    bool admit_message(int fd, const std::string& type, const Json::Value& msg);
+    void apply_coalesced(int64_t now_ms);
+    void dispatch_message(int fd, const std::string& type, const Json::Value& msg);
+    void route_message(int fd, const std::string& type, const Json::Value& msg);
+    
+    // Periodic work (matchmaking, spectator snapshots), runs under state_mutex_
+    void tick_loop();
+    void run_matchmaking(int64_t now_ms);
+    void push_spectator_states(int64_t now_ms);
+    void run_tournament(int64_t now_ms);
+    void start_tournament_round();
+    void close_tournament_round(int64_t now_ms);
+    
+    // One tick of a drain; true once everything is ended and disconnected
+    bool run_drain(int64_t now_ms);
+    void end_games_now();
+    void disconnect_idle_clients();
+    
+    // Mode engine: every game (arena, survival, training) is a ModeGame,
+    // fed input and ticks, and ended here
+    ModeGame* game_of(int fd);
+    template <typename Mode>
+    ModeGame& start_room_game(Room* room, Mode mode);  // replaces a finished game
+    void on_game_input(int fd, const ModeInput& input, bool force_broadcast);
+    void run_games(int64_t now_ms);
+    // game_end / next stage; may erase `game`. outright skips the stages
+    // a survival game has left (drain).
+    void end_mode_game(ModeGame& game, bool outright = false);
+    void finish_room_game(ModeGame& game);  // game_end, stats, tournament report
+    void end_survival_stage(ModeGame& game);
+    void finish_survival(ModeGame& game);
+    void send_training_state(int fd, const TrainingMode& training);
+    void finish_training(ModeGame& game);
+    static Json::Value ranking_json(const RankingEntry& r);  // one game_end rankings entry
     void handle_message(int fd, const Json::Value& msg);
     
-    // NDJSON helpers
+    // For handlers on a client thread: `call` runs once the state lock is
+    // released and before that connection's next message, so replies keep
+    // their order. It does the DB round trips, then locks to reply.
+    void defer_db(std::function<void()> call) { deferred_db_ = std::move(call); }
+    
+    // NDJSON helpers. broadcast_json reaches players and spectators,
+    // broadcast_line players only.
+    static std::string json_line(const Json::Value& obj);
     void send_json(int fd, const Json::Value& obj);
+    void send_line(int fd, const std::string& msg);
     void broadcast_json(Room* room, const Json::Value& obj);
+    void broadcast_line(Room* room, const std::string& msg);
+    void send_to_spectators(Room* room, std::string msg, bool reliable);
+    
+    // game_init with the paragraph's cached JSON members spliced in
+    static std::string game_init_line(const Json::Value& init, const Paragraph& paragraph);
+    std::string room_game_init_line(Room* room);
     
     // Message handlers
     void on_time_sync(int fd, const Json::Value& msg);
@@ -40,10 +159,28 @@ private:
     void on_start_training(int fd);
     void on_save_training_result(int fd, const Json::Value& msg);
     void on_leaderboard(int fd);
+    void on_profile(int fd);
     void on_input(int fd, const Json::Value& msg);
+    void on_input_batch(int fd, const Json::Value& msg);
+    void on_queue_leave(int fd);
+    void on_spectate(int fd, const Json::Value& msg);
+    void on_tournament_join(int fd);
+    void on_tournament_leave(int fd);
+    void on_resume(int fd, const Json::Value& msg);
+    void notify_orphaned_spectators();
+    
+    // Room game_state after input (throttled for streamed batches)
+    void after_room_input(Room* room, bool force_broadcast);
+    
+    // Takes fd out of any room, queue, spectating or training session
+    void leave_lobby(int fd);
+    
+    void broadcast_game_state(Room* room);
+    Json::Value game_state_json(Room* room);
     
     // Helper to broadcast room_state
     void broadcast_room_state(Room* room);
+    Json::Value room_state_json(Room* room);
     
     // Check if user_id is already logged in
     bool is_user_logged_in(int64_t user_id) const;
@@ -51,43 +188,150 @@ private:
     // Get server time in ms
     int64_t get_server_time_ms() const;
     
-    // Training session tracking
-    struct PlayerMetrics {
-        int word_idx = 0;
-        int64_t latest_time_ms = 0;
-        double progress = 0.0;
-        double wpm = 0.0;
-        double accuracy = 0.0;
-        int total_correct_chars = 0;
-        int total_chars_typed = 0;
-    };
+    // Matchmaking skill: recent WPM of a client (stored results at sign-in,
+    // then a moving average of finished games)
+    double skill_wpm(int fd) const;
+    void update_skill(int fd, double wpm);
     
-    struct TrainingSession {
-        std::string paragraph;
-        std::vector<std::string> paragraph_words;
-        int total_words;
-        int64_t start_time_ms;
-        int duration_ms;
-        std::string display_name;
-        PlayerMetrics metrics;  // Store metrics directly instead of using TypingEngine
-    };
-    std::unordered_map<int, TrainingSession> training_sessions_;
+    // Min gap between game_states caused by streamed input (per room)
+    static constexpr int64_t kStateBroadcastIntervalMs = 100;
+    
+    // Spectators get a game_state this often; the tick runs at a finer step
+    static constexpr int64_t kSpectatorStateIntervalMs = 500;
+    static constexpr int kTickIntervalMs = 50;
+    static constexpr int kSpectatorWorkers = 2;
+    
+    // Running games: room id -> arena / survival, fd -> training
+    std::unordered_map<std::string, ModeGame> room_games_;
+    std::unordered_map<int, ModeGame> training_games_;
+    
+    // Published by publish_settings(), read without a lock; applied_ is the
+    // snapshot the fields below were last taken from
+    std::shared_ptr<const ServerSettings> settings_;
+    std::shared_ptr<const ServerSettings> applied_;
+    SurvivalConfig survival_config_;
     
     // Client tracking
+    struct RateState {
+        TokenBucket bucket;
+        bool warned = false;     // RATE_LIMITED sent since the last admitted one
+    };
     struct ClientInfo {
         int client_id;
         std::string display_name;
         std::string recv_buffer; // for TCP streaming
         int64_t user_id = -1;    // -1 = guest, positive = authenticated user
         std::string username;    // empty for guests
+        double skill_wpm = 0.0;  // 0 = unknown
+        bool via_fanout = false; // has spectated: writes go through fanout_
+        std::string session_token; // sent in hello, presented in resume
+        int conn_id = 0;         // client_id given at accept (resume changes client_id)
+        int64_t last_recv_ms = 0;
+        std::string send_backlog; // whole lines the socket has not taken yet
+        std::unordered_map<std::string, RateState> rates;       // by limited type
+        std::unordered_map<std::string, Json::Value> coalesced; // latest held back, by type
     };
     
     std::unordered_map<int, ClientInfo> clients_;
     int next_client_id_ = 1;
+    
+    // Dropped sessions by token; fd is the placeholder their seat uses
+    struct ParkedSession {
+        int fd;
+        ClientInfo info;
+        int64_t expires_ms;
+    };
+    std::unordered_map<std::string, ParkedSession> parked_;
+    int session_grace_ms_ = 15000;
+    
+    // Session resume: a dropped player's room seat / training game is
+    // rebound to a placeholder fd until they resume or the grace ends
+    static std::string new_session_token();
+    const ClientInfo* find_client(int fd) const;  // live or parked
+    bool park_session(int fd);
+    void expire_sessions(int64_t now_ms);
+    void rebind_session(int from_fd, int to_fd);
+    Json::Value resume_snapshot(int fd, bool with_paragraph);
+
+    // Held by the accept loop and by client threads while they touch
+    // clients_, rooms or training sessions; recv() runs outside it
+    std::mutex state_mutex_;
 
     std::string ip_;
     int port_;
-    int server_fd_;
+    int server_fd_;  // closed under state_mutex_ when the drain starts
+    
+    std::atomic<bool> draining_{false};
+    std::atomic<int64_t> drain_deadline_ms_{0};
+    bool drain_started_ = false;  // tick thread only
+    ReplayWriter replay_writer_;  // declared before rooms: they flush into it on destruction
     RoomManager room_manager_;
+    KeystrokeAnalytics analytics_;
+    MatchmakingQueue matchmaking_;
+    Tournament tournament_;
+    SpectatorFanout fanout_{kSpectatorWorkers};
+    JobQueue db_jobs_;  // writes off the tick thread; joined before rooms and analytics go
+    std::function<void()> deferred_db_;  // see defer_db; set and taken under state_mutex_
     std::chrono::steady_clock::time_point start_time_;
+    
+    // Registered once in the constructor; recording never takes a lock
+    struct Metrics {
+        metrics::Histogram* lock_wait;     // client threads waiting for state_mutex_
+        metrics::Histogram* tick;
+        metrics::Histogram* broadcast;     // one room broadcast, all players
+        metrics::Counter* bytes_in;
+        metrics::Counter* bytes_out;
+        metrics::Counter* messages_out;
+        metrics::Gauge* clients;
+        metrics::Gauge* rooms;
+        metrics::Gauge* room_games;
+        metrics::Gauge* training_games;
+        metrics::Gauge* parked_sessions;
+        metrics::Gauge* queued;
+        metrics::Counter* refused;         // over max_connections
+        metrics::Counter* closed_idle;
+        metrics::Counter* closed_oversized;
+        metrics::Counter* closed_slow;     // stopped reading its socket
+    };
+    Metrics metrics_;
+    // Handler latency by message type; unknown types share one series
+    std::unordered_map<std::string, metrics::Histogram*> handler_latency_;
+    metrics::Histogram* unknown_handler_latency_;
+    void register_metrics();
+    void update_gauges();
+    
+    // Rate limits by type; kOtherMessages covers the rest
+    struct LimitedType {
+        RateLimit limit;
+        metrics::Counter* dropped;
+        metrics::Counter* coalesced;   // null where not coalescable
+    };
+    static constexpr const char* kOtherMessages = "other";
+    std::unordered_map<std::string, LimitedType> rate_limits_;
+    std::unordered_set<int> coalescing_;   // fds with coalesced messages waiting
+    std::unordered_set<int> backlogged_;   // fds with a non-empty send_backlog
+    
+    // Idle connections: one timer per socket, checked against
+    // last_recv_ms when it comes due and rescheduled if there was traffic
+    struct IdleTimer {
+        int fd;
+        int conn_id;      // a reused fd is a different connection
+        int generation;   // idle_generation_ when armed
+    };
+    static constexpr int64_t kIdleWheelResolutionMs = 500;
+    static constexpr size_t kIdleWheelSlots = 128;
+    ConnectionLimits limits_;
+    TimerWheel<IdleTimer> idle_timers_{kIdleWheelResolutionMs, kIdleWheelSlots};
+    int idle_generation_ = 0;   // bumped when idle_timeout_ms changes
+    std::vector<IdleTimer> idle_due_;   // scratch for the tick
+    
+    // Admin snapshots: requests bump snapshot_requested_; the tick takes
+    // one snapshot for all of them and publishes it under snapshot_mutex_
+    static constexpr int kSnapshotTimeoutMs = 1000;
+    void publish_admin_snapshot(int64_t now_ms);
+    std::atomic<uint64_t> snapshot_requested_{0};
+    uint64_t snapshot_taken_ = 0;  // tick thread only
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    std::shared_ptr<const AdminSnapshot> snapshot_;
 };
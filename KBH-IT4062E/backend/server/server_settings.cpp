@@ -0,0 +1,118 @@
+#include "server_settings.h"
+#include "../config/config.h"
+
+// First value outside [low, high] names itself in error
+static bool in_range(const char* key, long long value, long long low, long long high, std::string& error) {
+    if (value >= low && value <= high) return true;
+    error = std::string(key) + " must be between " + std::to_string(low) + " and " + std::to_string(high);
+    return false;
+}
+
+static bool rate_ok(const std::string& type, const RateLimit& limit, std::string& error) {
+    if (limit.per_second < 0 || (limit.per_second > 0 && limit.burst < 1)) {
+        error = "rate_" + type + ": per_s must be >= 0 and burst >= 1";
+        return false;
+    }
+    return true;
+}
+
+bool load_server_settings(const std::string& path, ServerSettings& out, std::string& error) {
+    Config config(path);
+    if (!config.is_loaded()) {
+        error = "cannot read or parse " + path;
+        return false;
+    }
+
+    ServerSettings s;
+
+    MatchmakingConfig& mm = s.matchmaking;
+    mm.enabled          = config.get_config_bool("skill_matchmaking", false);
+    mm.room_size        = config.get_config_int("matchmaking_room_size", mm.room_size);
+    mm.min_players      = config.get_config_int("matchmaking_min_players", mm.min_players);
+    mm.base_spread_wpm  = config.get_config_int("matchmaking_spread_wpm", (int)mm.base_spread_wpm);
+    mm.widen_wpm_per_s  = config.get_config_int("matchmaking_widen_wpm_per_s", (int)mm.widen_wpm_per_s);
+    mm.max_spread_wpm   = config.get_config_int("matchmaking_max_spread_wpm", (int)mm.max_spread_wpm);
+    mm.partial_after_ms = config.get_config_int("matchmaking_partial_after_ms", mm.partial_after_ms);
+    mm.max_wait_ms      = config.get_config_int("matchmaking_max_wait_ms", mm.max_wait_ms);
+
+    TournamentConfig& tc = s.tournament;
+    tc.enabled          = config.get_config_bool("tournament_enabled", false);
+    tc.lobby_ms         = config.get_config_int("tournament_lobby_ms", tc.lobby_ms);
+    tc.min_players      = config.get_config_int("tournament_min_players", tc.min_players);
+    tc.round_ms         = config.get_config_int("tournament_round_ms", tc.round_ms);
+    tc.advance_pct      = config.get_config_int("tournament_advance_pct", tc.advance_pct);
+    tc.break_ms         = config.get_config_int("tournament_break_ms", tc.break_ms);
+
+    SurvivalConfig& sc = s.survival;
+    sc.min_players      = config.get_config_int("survival_min_players", sc.min_players);
+    sc.stage_ms         = config.get_config_int("survival_stage_ms", sc.stage_ms);
+    sc.stage_step_ms    = config.get_config_int("survival_stage_step_ms", sc.stage_step_ms);
+    sc.min_stage_ms     = config.get_config_int("survival_min_stage_ms", sc.min_stage_ms);
+    sc.eliminate_pct    = config.get_config_int("survival_eliminate_pct", sc.eliminate_pct);
+    sc.max_stages       = config.get_config_int("survival_max_stages", sc.max_stages);
+    sc.break_ms         = config.get_config_int("survival_break_ms", sc.break_ms);
+
+    ConnectionLimits& limits = s.limits;
+    limits.max_connections      = config.get_config_int("max_connections", limits.max_connections);
+    limits.max_message_bytes    = config.get_config_int("max_message_bytes", (int)limits.max_message_bytes);
+    limits.max_send_buffer_bytes = config.get_config_int("max_send_buffer_bytes",
+                                                         (int)limits.max_send_buffer_bytes);
+    limits.idle_timeout_ms      = config.get_config_int("idle_timeout_ms", limits.idle_timeout_ms);
+    limits.keepalive_idle_s     = config.get_config_int("tcp_keepalive_idle_s", limits.keepalive_idle_s);
+    limits.keepalive_interval_s = config.get_config_int("tcp_keepalive_interval_s", limits.keepalive_interval_s);
+    limits.keepalive_count      = config.get_config_int("tcp_keepalive_count", limits.keepalive_count);
+
+    // rate_<type>_per_s / rate_<type>_burst; rate_other_* for unlisted types
+    for (auto& [type, limit] : s.rates.by_type) {
+        limit.per_second = config.get_config_int("rate_" + type + "_per_s", limit.per_second);
+        limit.burst      = config.get_config_int("rate_" + type + "_burst", limit.burst);
+    }
+    s.rates.other.per_second = config.get_config_int("rate_other_per_s", s.rates.other.per_second);
+    s.rates.other.burst      = config.get_config_int("rate_other_burst", s.rates.other.burst);
+
+    s.session_grace_ms = config.get_config_int("session_grace_ms", s.session_grace_ms);
+    s.drain_timeout_ms = config.get_config_int("drain_timeout_ms", s.drain_timeout_ms);
+
+    std::string level = config.get_config_value("log_level");
+    if (!level.empty() && !logging::parse_level(level, s.log_level)) {
+        error = "unknown log_level " + level;
+        return false;
+    }
+
+    // A typo here should be refused, not break running games
+    const int kDay = 24 * 3600 * 1000;
+    bool ok = in_range("matchmaking_room_size", mm.room_size, 2, 8, error) &&
+              in_range("matchmaking_min_players", mm.min_players, 2, mm.room_size, error) &&
+              in_range("matchmaking_partial_after_ms", mm.partial_after_ms, 0, kDay, error) &&
+              in_range("matchmaking_max_wait_ms", mm.max_wait_ms, 0, kDay, error) &&
+              in_range("tournament_lobby_ms", tc.lobby_ms, 1, kDay, error) &&
+              in_range("tournament_min_players", tc.min_players, 2, 1 << 16, error) &&
+              in_range("tournament_round_ms", tc.round_ms, 1000, kDay, error) &&
+              in_range("tournament_advance_pct", tc.advance_pct, 1, 99, error) &&
+              in_range("tournament_break_ms", tc.break_ms, 0, kDay, error) &&
+              in_range("survival_min_players", sc.min_players, 2, 8, error) &&
+              in_range("survival_stage_ms", sc.stage_ms, 1000, kDay, error) &&
+              in_range("survival_stage_step_ms", sc.stage_step_ms, 0, kDay, error) &&
+              in_range("survival_min_stage_ms", sc.min_stage_ms, 1000, sc.stage_ms, error) &&
+              in_range("survival_eliminate_pct", sc.eliminate_pct, 1, 99, error) &&
+              in_range("survival_max_stages", sc.max_stages, 1, 1000, error) &&
+              in_range("survival_break_ms", sc.break_ms, 0, kDay, error) &&
+              in_range("max_connections", limits.max_connections, 0, 1 << 20, error) &&
+              in_range("max_message_bytes", (long long)limits.max_message_bytes, 0, 1 << 30, error) &&
+              in_range("max_send_buffer_bytes", (long long)limits.max_send_buffer_bytes, 0, 1 << 30, error) &&
+              (limits.idle_timeout_ms == 0 ||
+               in_range("idle_timeout_ms", limits.idle_timeout_ms, 1000, kDay, error)) &&
+              in_range("tcp_keepalive_idle_s", limits.keepalive_idle_s, 0, 86400, error) &&
+              in_range("tcp_keepalive_interval_s", limits.keepalive_interval_s, 1, 3600, error) &&
+              in_range("tcp_keepalive_count", limits.keepalive_count, 1, 100, error) &&
+              in_range("session_grace_ms", s.session_grace_ms, 0, kDay, error) &&
+              in_range("drain_timeout_ms", s.drain_timeout_ms, 0, kDay, error) &&
+              rate_ok("other", s.rates.other, error);
+    for (const auto& [type, limit] : s.rates.by_type) {
+        ok = ok && rate_ok(type, limit, error);
+    }
+    if (!ok) return false;
+
+    out = std::move(s);
+    return true;
+}
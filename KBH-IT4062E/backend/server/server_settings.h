@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include "../matchmaking/matchmaking_queue.h"
+#include "../tournament/tournament.h"
+#include "../gamemode/survival/survival_mode.h"
+#include "log.h"
+
+// Admission control and per-connection resource caps (0 = no limit)
+struct ConnectionLimits {
+    int max_connections = 1000;                 // live sockets; more are refused
+    size_t max_message_bytes = 1 << 20;         // one NDJSON line
+    size_t max_send_buffer_bytes = 256 << 10;   // unsent output a client may leave queued
+    int idle_timeout_ms = 30000;                // nothing received for this long
+    int keepalive_idle_s = 15;                  // TCP keepalive for half-open peers
+    int keepalive_interval_s = 5;
+    int keepalive_count = 3;
+};
+
+// Inbound messages per connection and second, by message type
+struct RateLimit {
+    int per_second = 0;   // 0 = unlimited
+    int burst = 0;        // messages allowed back to back
+};
+
+struct RateLimitConfig {
+    // Types not listed share one bucket with the `other` limit
+    std::unordered_map<std::string, RateLimit> by_type = {
+        {"input",           {20, 40}},
+        {"input_batch",     {20, 40}},
+        {"set_username",    {1, 2}},
+        {"set_private",     {2, 4}},
+        {"leaderboard",     {1, 3}},
+        {"profile",         {1, 3}},
+        {"sign_in",         {1, 3}},
+        {"create_account",  {1, 3}},
+        {"change_password", {1, 3}},
+    };
+    RateLimit other = {20, 40};
+};
+
+// The part of server_config.json that can change while the server runs.
+// A snapshot is never modified once published; a reload builds a new one.
+// Addresses, ports, paths and the database are read once at startup.
+struct ServerSettings {
+    MatchmakingConfig matchmaking;
+    TournamentConfig tournament;
+    SurvivalConfig survival;
+    ConnectionLimits limits;
+    RateLimitConfig rates;
+    int session_grace_ms = 15000;   // 0 = remove on disconnect
+    int drain_timeout_ms = 60000;
+    logging::Level log_level = logging::Level::Info;
+};
+
+// Reads and checks the settings in the config file at path. false (with
+// the reason in error) if the file does not parse or a value is out of
+// range; out is only written on success.
+bool load_server_settings(const std::string& path, ServerSettings& out, std::string& error);
@@ -0,0 +1,166 @@
+#include "spectator_fanout.h"
+#include "../metrics/metrics.h"
+#include <sys/socket.h>
+#include <cerrno>
+#include <chrono>
+
+SpectatorFanout::SpectatorFanout(int shards) {
+    if (shards < 1) shards = 1;
+    for (int i = 0; i < shards; i++) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    for (auto& shard : shards_) {
+        shard->worker = std::thread(&SpectatorFanout::run, this, std::ref(*shard));
+    }
+}
+
+SpectatorFanout::~SpectatorFanout() {
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stop = true;
+        }
+        shard->cv.notify_all();
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+}
+
+void SpectatorFanout::add(int fd) {
+    Shard& shard = shard_of(fd);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.subs[fd];
+}
+
+void SpectatorFanout::remove(int fd) {
+    // Workers write under the shard mutex, so holding it here means no
+    // write to fd is in flight
+    Shard& shard = shard_of(fd);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.subs.find(fd);
+    if (it == shard.subs.end()) return;
+    if (!it->second.queue.empty()) shard.backlogged--;
+    shard.subs.erase(it);
+}
+
+bool SpectatorFanout::contains(int fd) const {
+    Shard& shard = shard_of(fd);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.subs.count(fd) > 0;
+}
+
+void SpectatorFanout::publish(const Frame& frame, const std::vector<int>& fds, bool reliable) {
+    if (fds.empty()) return;
+    
+    // Split by shard; single-shard (or single-fd) publishes skip the copy
+    if (shards_.size() == 1 || fds.size() == 1) {
+        Shard& shard = shard_of(fds[0]);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.jobs.push_back({frame, fds, reliable});
+        }
+        shard.cv.notify_one();
+        return;
+    }
+    
+    std::vector<std::vector<int>> split(shards_.size());
+    for (int fd : fds) {
+        split[fd % shards_.size()].push_back(fd);
+    }
+    for (size_t i = 0; i < shards_.size(); i++) {
+        if (split[i].empty()) continue;
+        {
+            std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+            shards_[i]->jobs.push_back({frame, std::move(split[i]), reliable});
+        }
+        shards_[i]->cv.notify_one();
+    }
+}
+
+void SpectatorFanout::flush(Shard& shard, Subscriber& sub, int fd) {
+    while (!sub.queue.empty()) {
+        const std::string& data = *sub.queue.front();
+        ssize_t n = ::send(fd, data.data() + sub.offset, data.size() - sub.offset,
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            // Peer is gone; its client thread will remove it
+            drop_queue(shard, sub);
+            return;
+        }
+        sub.offset += n;
+        if (sub.offset < data.size()) return;
+        sub.queued_bytes -= data.size();
+        sub.queue.pop_front();
+        sub.offset = 0;
+        if (sub.queue.empty()) shard.backlogged--;
+    }
+}
+
+void SpectatorFanout::drop_queue(Shard& shard, Subscriber& sub) {
+    if (sub.queue.empty()) return;
+    sub.queue.clear();
+    sub.offset = 0;
+    sub.queued_bytes = 0;
+    shard.backlogged--;
+}
+
+void SpectatorFanout::run(Shard& shard) {
+    auto& registry = metrics::Registry::global();
+    metrics::Counter& delivered = registry.counter("kbh_spectator_frames_total",
+        "Frames queued to spectators", "result=\"queued\"");
+    metrics::Counter& skipped = registry.counter("kbh_spectator_frames_total",
+        "Frames queued to spectators", "result=\"skipped\"");
+    metrics::Counter& cut_off = registry.counter("kbh_connections_closed_total",
+        "Connections the server closed for breaking a limit", "reason=\"slow_reader\"");
+    
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    while (!shard.stop) {
+        if (shard.jobs.empty()) {
+            // Backlogged sockets are retried on a short poll
+            if (shard.backlogged > 0) {
+                shard.cv.wait_for(lock, std::chrono::milliseconds(10));
+            } else {
+                shard.cv.wait(lock);
+            }
+        }
+        
+        std::vector<Job> jobs;
+        jobs.swap(shard.jobs);
+        for (const Job& job : jobs) {
+            for (int fd : job.fds) {
+                auto it = shard.subs.find(fd);
+                if (it == shard.subs.end()) continue;
+                Subscriber& sub = it->second;
+                if (sub.cut) continue;
+                
+                if (!sub.queue.empty() && !job.reliable) {  // behind: skip snapshot
+                    skipped.inc();
+                    continue;
+                }
+                size_t cap = max_backlog_;
+                if (cap > 0 && !sub.queue.empty() && sub.queued_bytes + job.frame->size() > cap) {
+                    // Its client thread sees EOF and removes it
+                    drop_queue(shard, sub);
+                    sub.cut = true;
+                    ::shutdown(fd, SHUT_RDWR);
+                    cut_off.inc();
+                    continue;
+                }
+                delivered.inc();
+                if (sub.queue.empty()) shard.backlogged++;
+                sub.queue.push_back(job.frame);
+                sub.queued_bytes += job.frame->size();
+                flush(shard, sub, fd);
+            }
+        }
+        
+        if (jobs.empty() && shard.backlogged > 0) {
+            for (auto& kv : shard.subs) {
+                if (!kv.second.queue.empty()) flush(shard, kv.second, kv.first);
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Delivers messages to spectators off the game threads.
+//
+// A frame is serialized once and shared (refcounted) by every watcher.
+// Subscribers are split across worker shards by fd; publish() hands each
+// shard only its own fds, so a room's broadcast fans out room -> shards ->
+// sockets and the caller never touches a spectator socket itself.
+//
+// Writes are non-blocking. A watcher that cannot keep up keeps its unsent
+// frames queued; lossy frames (game_state snapshots) are skipped for it
+// until it drains, reliable ones (room_state, game_init, game_end) always
+// queue. Nothing a slow watcher does can stall the room's players; one
+// whose queue outgrows the backlog cap is disconnected.
+class SpectatorFanout {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    explicit SpectatorFanout(int shards = 2);
+    ~SpectatorFanout();
+
+    SpectatorFanout(const SpectatorFanout&) = delete;
+    SpectatorFanout& operator=(const SpectatorFanout&) = delete;
+
+    void add(int fd);
+    // Once this returns no worker writes to fd again, so it may be closed
+    void remove(int fd);
+    bool contains(int fd) const;
+
+    void publish(const Frame& frame, const std::vector<int>& fds, bool reliable);
+    void send(int fd, const Frame& frame) { publish(frame, {fd}, true); }
+
+    // Queued bytes per watcher before it is cut off (0 = unbounded)
+    void set_max_backlog(size_t bytes) { max_backlog_ = bytes; }
+
+private:
+    struct Subscriber {
+        std::deque<Frame> queue;    // front is partially sent up to offset
+        size_t offset = 0;
+        size_t queued_bytes = 0;
+        bool cut = false;           // over the backlog cap, socket shut down
+    };
+    struct Job {
+        Frame frame;
+        std::vector<int> fds;
+        bool reliable;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<Job> jobs;
+        std::unordered_map<int, Subscriber> subs;
+        size_t backlogged = 0;      // subscribers with queued frames
+        bool stop = false;
+        std::thread worker;
+    };
+
+    Shard& shard_of(int fd) const { return *shards_[fd % shards_.size()]; }
+    void run(Shard& shard);
+    static void flush(Shard& shard, Subscriber& sub, int fd);
+    static void drop_queue(Shard& shard, Subscriber& sub);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> max_backlog_{0};
+};
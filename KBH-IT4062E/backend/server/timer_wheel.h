@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hashed timing wheel: `slots` buckets of `resolution_ms` each. schedule()
+// and advance() cost O(1) per entry, however many timers are pending.
+//
+// There is no cancel or re-arm. Callers keep the real deadline elsewhere,
+// check it when an entry comes due and schedule it again if it moved;
+// entries for things that are gone are just dropped. A deadline beyond the
+// wheel's span comes due early, at the far end, and is rescheduled then.
+template <typename T>
+class TimerWheel {
+public:
+    TimerWheel(int64_t resolution_ms, size_t slots, int64_t now_ms = 0)
+        : resolution_ms_(resolution_ms), cursor_(now_ms / resolution_ms), slots_(slots) {}
+
+    void schedule(const T& item, int64_t deadline_ms) {
+        // Overdue entries fire on the next advance
+        int64_t tick = std::max(deadline_ms / resolution_ms_, cursor_ + 1);
+        tick = std::min(tick, cursor_ + (int64_t)slots_.size() - 1);
+        slots_[tick % slots_.size()].push_back(item);
+    }
+
+    // Appends the entries of every slot passed since the last call
+    void advance(int64_t now_ms, std::vector<T>& due) {
+        int64_t now_tick = now_ms / resolution_ms_;
+        // After a long stall one full turn empties every slot
+        cursor_ = std::max(cursor_, now_tick - (int64_t)slots_.size());
+        while (cursor_ < now_tick) {
+            auto& slot = slots_[++cursor_ % slots_.size()];
+            due.insert(due.end(), slot.begin(), slot.end());
+            slot.clear();
+        }
+    }
+
+private:
+    int64_t resolution_ms_;
+    int64_t cursor_;        // last tick advanced past
+    std::vector<std::vector<T>> slots_;
+};
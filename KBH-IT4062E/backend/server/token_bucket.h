@@ -0,0 +1,27 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// Token bucket: holds up to `burst` tokens and refills at `per_second`.
+// The rate is passed on every call, so one limit can be shared by many
+// buckets and changed without touching them. Starts full.
+class TokenBucket {
+public:
+    // Takes one token if there is one
+    bool take(int64_t now_ms, double per_second, double burst) {
+        if (last_ms_ < 0) {
+            tokens_ = burst;
+        } else {
+            tokens_ = std::min(burst, tokens_ + (now_ms - last_ms_) * per_second / 1000.0);
+        }
+        last_ms_ = now_ms;
+        if (tokens_ < 1.0) return false;
+        tokens_ -= 1.0;
+        return true;
+    }
+
+private:
+    double tokens_ = 0.0;
+    int64_t last_ms_ = -1;
+};
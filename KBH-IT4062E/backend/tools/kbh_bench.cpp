@@ -0,0 +1,810 @@
+// Load generator for kbh_server.
+//
+//   kbh_bench [--host 127.0.0.1] [--port 5500] [--clients 800] [--room-size 8]
+//             [--wpm 80] [--error-rate 0.02] [--duration 30] [--game-ms 50000]
+//             [--connect-rate 500] [--seed 42] [--replay file.kbr]
+//             [--server-pid PID] [--json out.json] [--stream [--flush-ms 100]]
+//             [--spectators 0]
+//
+// Opens --clients loopback connections in groups of --room-size. The first
+// client of each group creates a room, the rest join it, everyone readies up
+// and the host starts; players then type the paragraph at --wpm (or with the
+// inter-key timing of a stored replay) and the games repeat until --duration
+// seconds have passed. All randomness comes from --seed, so runs are
+// reproducible. --stream sends keystrokes as input_batch every --flush-ms
+// instead of one input message per word. --spectators adds that many extra
+// connections that only watch, spread round-robin over the rooms.
+//
+// Reports input -> game_state latency percentiles (time from sending an
+// `input` until a game_state shows that word committed for the sender),
+// message rates and, with --server-pid, server CPU usage.
+//
+// Set "db_backend": "memory" in server_config.json to keep PostgreSQL out
+// of the measurement (db_latency_ms / db_latency_jitter_ms emulate it).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <jsoncpp/json/json.h>
+#include "replay_reader.h"
+
+// ===============================
+// Options
+// ===============================
+struct BenchConfig {
+    std::string host = "127.0.0.1";
+    int port = 5500;
+    int clients = 800;
+    int room_size = 8;
+    double wpm = 80.0;
+    double error_rate = 0.02;
+    int duration_s = 30;
+    int game_ms = 50000;
+    int connect_rate = 500;     // new connections per second
+    uint32_t seed = 42;
+    std::string replay_path;
+    int server_pid = 0;
+    std::string json_out;
+    bool stream = false;
+    int flush_ms = 100;
+    int spectators = 0;
+};
+
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ===============================
+// Per-connection state
+// ===============================
+struct Client {
+    int idx = 0;
+    int group = 0;
+    bool leader = false;
+    bool spectator = false;
+    int fd = -1;
+    bool connected = false;
+    bool closed = false;
+
+    std::string rbuf;
+    std::string wbuf;
+
+    int client_id = 0;
+    int self_slot = -1;
+    bool joined = false;
+    bool ready_sent = false;
+    bool start_sent = false;
+
+    // Typing
+    bool playing = false;
+    std::vector<std::string> words;
+    size_t word = 0;
+    size_t pos = 0;
+    bool typo_pending = false;     // typed a wrong char, backspace next
+    int64_t server_offset_ms = 0;  // server_ms = local_ms + offset
+    Json::Value events{Json::arrayValue};
+    int64_t batch_deadline_us = 0;          // --stream: pending flush time
+    std::vector<int> batch_commits;         // words committed in the batch
+    size_t replay_cursor = 0;
+    std::mt19937 rng;
+
+    // (word_idx that must be committed, send time)
+    std::deque<std::pair<int, int64_t>> probes;
+};
+
+struct Group {
+    std::string room_id;
+    int members = 0;
+    std::vector<int> watchers;  // client indices of its spectators
+};
+
+struct Stats {
+    std::vector<int64_t> latencies_us;
+    uint64_t msgs_sent = 0;
+    uint64_t msgs_recv = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_recv = 0;
+    uint64_t inputs_sent = 0;
+    uint64_t games_started = 0;
+    uint64_t games_ended = 0;
+    uint64_t errors = 0;
+    uint64_t disconnects = 0;
+    uint64_t spectator_states = 0;   // game_states received by spectators
+};
+
+class Bench {
+public:
+    explicit Bench(const BenchConfig& cfg) : cfg_(cfg) {}
+    int run();
+
+private:
+    bool load_replay();
+    void open_connection(Client& c);
+    void on_readable(Client& c);
+    void on_writable(Client& c);
+    void on_line(Client& c, const std::string& line);
+    void on_room_state(Client& c, const Json::Value& msg);
+    void on_game_init(Client& c, const Json::Value& msg);
+    void on_game_state(Client& c, const Json::Value& msg);
+    void type_next(Client& c, int64_t now);
+    void flush_batch(Client& c);
+    int64_t next_key_delay_us(Client& c);
+    void send_msg(Client& c, const Json::Value& msg);
+    void flush(Client& c);
+    void close_client(Client& c);
+    void report(double wall_s, double cpu_s);
+    double read_server_cpu_s() const;
+
+    BenchConfig cfg_;
+    int epfd_ = -1;
+    std::vector<Client> clients_;
+    std::vector<Group> groups_;
+    Stats stats_;
+    std::unique_ptr<Json::CharReader> reader_;
+    Json::StreamWriterBuilder writer_;
+
+    // Inter-key delays (ms) taken from a replay, cycled by every client
+    std::vector<int64_t> replay_delays_ms_;
+
+    // Timers: (due time, client idx * 2 + 1 for a batch flush, * 2 for a key)
+    using Timer = std::pair<int64_t, int>;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+};
+
+// ===============================
+// Setup
+// ===============================
+bool Bench::load_replay() {
+    if (cfg_.replay_path.empty()) return true;
+
+    ReplayReader reader;
+    std::string err;
+    if (!reader.open(cfg_.replay_path, err)) {
+        std::cerr << "[Bench] " << err << "\n";
+        return false;
+    }
+
+    int64_t last[replay::kMaxSlots];
+    bool seen[replay::kMaxSlots] = {};
+    ReplayEvent ev;
+    while (reader.next(ev)) {
+        if (ev.code == replay::kCodeCommit || ev.code == replay::kCodeWord) continue;
+        if (seen[ev.slot_idx]) {
+            int64_t d = ev.time_ms - last[ev.slot_idx];
+            if (d > 0 && d < 2000) replay_delays_ms_.push_back(d);
+        }
+        seen[ev.slot_idx] = true;
+        last[ev.slot_idx] = ev.time_ms;
+    }
+
+    if (replay_delays_ms_.empty()) {
+        std::cerr << "[Bench] Replay has no usable key timings\n";
+        return false;
+    }
+    std::cout << "[Bench] Using " << replay_delays_ms_.size()
+              << " inter-key delays from " << cfg_.replay_path << "\n";
+    return true;
+}
+
+void Bench::open_connection(Client& c) {
+    c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (c.fd < 0) {
+        perror("socket");
+        c.closed = true;
+        return;
+    }
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg_.port);
+    inet_pton(AF_INET, cfg_.host.c_str(), &addr.sin_addr);
+
+    if (connect(c.fd, (sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        perror("connect");
+        ::close(c.fd);
+        c.fd = -1;
+        c.closed = true;
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u32 = c.idx;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, c.fd, &ev);
+}
+
+// ===============================
+// I/O
+// ===============================
+void Bench::send_msg(Client& c, const Json::Value& msg) {
+    if (c.closed) return;
+    std::string line = Json::writeString(writer_, msg);
+    line += '\n';
+    c.wbuf += line;
+    stats_.msgs_sent++;
+    stats_.bytes_sent += line.size();
+    if (c.connected) flush(c);
+}
+
+void Bench::flush(Client& c) {
+    while (!c.wbuf.empty()) {
+        ssize_t n = send(c.fd, c.wbuf.data(), c.wbuf.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            close_client(c);
+            return;
+        }
+        c.wbuf.erase(0, n);
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | (c.wbuf.empty() ? 0u : (uint32_t)EPOLLOUT);
+    ev.data.u32 = c.idx;
+    epoll_ctl(epfd_, EPOLL_CTL_MOD, c.fd, &ev);
+}
+
+void Bench::close_client(Client& c) {
+    if (c.closed) return;
+    c.closed = true;
+    c.playing = false;
+    stats_.disconnects++;
+    if (c.fd >= 0) {
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        c.fd = -1;
+    }
+}
+
+void Bench::on_writable(Client& c) {
+    if (!c.connected) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            std::cerr << "[Bench] connect failed for client " << c.idx << ": " << strerror(err) << "\n";
+            close_client(c);
+            return;
+        }
+        c.connected = true;
+    }
+    flush(c);
+}
+
+void Bench::on_readable(Client& c) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n == 0) {
+            close_client(c);
+            return;
+        }
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) close_client(c);
+            break;
+        }
+        stats_.bytes_recv += n;
+        c.rbuf.append(buf, n);
+    }
+
+    size_t start = 0;
+    size_t nl;
+    while ((nl = c.rbuf.find('\n', start)) != std::string::npos) {
+        std::string line = c.rbuf.substr(start, nl - start);
+        start = nl + 1;
+        if (!line.empty()) on_line(c, line);
+        if (c.closed) return;
+    }
+    c.rbuf.erase(0, start);
+}
+
+// ===============================
+// Protocol flow
+// ===============================
+void Bench::on_line(Client& c, const std::string& line) {
+    stats_.msgs_recv++;
+
+    Json::Value msg;
+    std::string errs;
+    if (!reader_->parse(line.data(), line.data() + line.size(), &msg, &errs)) {
+        stats_.errors++;
+        return;
+    }
+    std::string type = msg["type"].asString();
+
+    if (c.spectator) {
+        if (type == "game_state") stats_.spectator_states++;
+        else if (type == "error") stats_.errors++;
+        else if (type == "hello") c.client_id = msg["client_id"].asInt();
+        return;
+    }
+
+    if (type == "hello") {
+        c.client_id = msg["client_id"].asInt();
+        if (c.leader) {
+            Json::Value m;
+            m["type"] = "create_room";
+            send_msg(c, m);
+        }
+    } else if (type == "room_state") {
+        on_room_state(c, msg);
+    } else if (type == "game_init") {
+        on_game_init(c, msg);
+    } else if (type == "game_state") {
+        on_game_state(c, msg);
+    } else if (type == "game_end") {
+        c.playing = false;
+        c.ready_sent = false;
+        c.start_sent = false;
+        c.probes.clear();
+        if (c.leader) stats_.games_ended++;
+    } else if (type == "error") {
+        stats_.errors++;
+    }
+}
+
+void Bench::on_room_state(Client& c, const Json::Value& msg) {
+    Group& g = groups_[c.group];
+    c.joined = true;
+
+    int occupied = 0;
+    for (const auto& slot : msg["slots"]) {
+        if (!slot["occupied"].asBool()) continue;
+        occupied++;
+        if (slot["client_id"].asInt() == c.client_id) {
+            c.self_slot = slot["slot_idx"].asInt();
+        }
+    }
+
+    if (c.leader && g.room_id.empty()) {
+        g.room_id = msg["room_id"].asString();
+
+        // Let the rest of the group in
+        for (int i = 1; i < g.members; i++) {
+            Client& f = clients_[c.idx + i];
+            if (f.client_id == 0 || f.closed) continue;
+            Json::Value m;
+            m["type"] = "join_room";
+            m["room_id"] = g.room_id;
+            send_msg(f, m);
+        }
+        for (int w : g.watchers) {
+            Client& s = clients_[w];
+            if (s.client_id == 0 || s.closed) continue;
+            Json::Value m;
+            m["type"] = "spectate";
+            m["room_id"] = g.room_id;
+            send_msg(s, m);
+        }
+    }
+
+    if (!c.ready_sent && !c.playing) {
+        Json::Value m;
+        m["type"] = "ready";
+        send_msg(c, m);
+        c.ready_sent = true;
+    }
+
+    if (c.leader && !c.start_sent && !c.playing && msg["can_start"].asBool() &&
+        occupied >= std::min(g.members, 8)) {
+        Json::Value m;
+        m["type"] = "start_game";
+        m["duration_ms"] = cfg_.game_ms;
+        send_msg(c, m);
+        c.start_sent = true;
+        stats_.games_started++;
+    }
+}
+
+void Bench::on_game_init(Client& c, const Json::Value& msg) {
+    c.words.clear();
+    std::istringstream iss(msg["paragraph"].asString());
+    std::string w;
+    while (iss >> w) c.words.push_back(w);
+
+    // server_start_ms is "now" on the server when game_init was sent
+    int64_t local_ms = now_us() / 1000;
+    c.server_offset_ms = msg["server_start_ms"].asInt64() - local_ms;
+
+    c.word = 0;
+    c.pos = 0;
+    c.typo_pending = false;
+    c.events = Json::Value(Json::arrayValue);
+    c.batch_commits.clear();
+    c.probes.clear();
+    c.playing = !c.words.empty();
+
+    if (c.playing) {
+        timers_.push({now_us() + next_key_delay_us(c), c.idx * 2});
+    }
+}
+
+void Bench::on_game_state(Client& c, const Json::Value& msg) {
+    if (c.probes.empty() || c.self_slot < 0) return;
+
+    const Json::Value& players = msg["players"];
+    if (!players.isArray() || (int)players.size() <= c.self_slot) return;
+
+    int committed = players[c.self_slot]["word_idx"].asInt();
+    int64_t now = now_us();
+    while (!c.probes.empty() && c.probes.front().first <= committed) {
+        stats_.latencies_us.push_back(now - c.probes.front().second);
+        c.probes.pop_front();
+    }
+}
+
+int64_t Bench::next_key_delay_us(Client& c) {
+    if (!replay_delays_ms_.empty()) {
+        int64_t d = replay_delays_ms_[c.replay_cursor++ % replay_delays_ms_.size()];
+        return d * 1000;
+    }
+    // wpm words of 5 chars per minute, +-30% jitter
+    double base_ms = 60000.0 / (cfg_.wpm * 5.0);
+    std::uniform_real_distribution<double> jitter(0.7, 1.3);
+    return (int64_t)(base_ms * jitter(c.rng) * 1000.0);
+}
+
+void Bench::type_next(Client& c, int64_t now) {
+    if (!c.playing || c.closed) return;
+
+    const std::string& target = c.words[c.word];
+    Json::Value e;
+    e["time_ms"] = (Json::Int64)(now / 1000 + c.server_offset_ms);
+
+    if (c.typo_pending) {
+        e["type"] = "backspace";
+        c.typo_pending = false;
+    } else {
+        std::uniform_real_distribution<double> roll(0.0, 1.0);
+        char ch = target[c.pos];
+        if (roll(c.rng) < cfg_.error_rate) {
+            ch = (ch == 'x') ? 'y' : 'x';
+            c.typo_pending = true;
+        } else {
+            c.pos++;
+        }
+        e["type"] = "char";
+        e["char"] = std::string(1, ch);
+    }
+    c.events.append(e);
+
+    if (cfg_.stream) {
+        if (c.batch_deadline_us == 0) {
+            c.batch_deadline_us = now + (int64_t)cfg_.flush_ms * 1000;
+            timers_.push({c.batch_deadline_us, c.idx * 2 + 1});
+        }
+        if (!c.typo_pending && c.pos >= target.size()) {
+            Json::Value commit;
+            commit["type"] = "commit";
+            commit["word_idx"] = (int)c.word;
+            commit["time_ms"] = e["time_ms"];
+            c.events.append(commit);
+            c.batch_commits.push_back((int)c.word + 1);
+
+            c.word++;
+            c.pos = 0;
+            if (c.word >= c.words.size()) {
+                c.playing = false;
+                return;
+            }
+        }
+    } else if (!c.typo_pending && c.pos >= target.size()) {
+        // Word committed
+        Json::Value m;
+        m["type"] = "input";
+        m["room_id"] = groups_[c.group].room_id;
+        m["word_idx"] = (int)c.word;
+        m["char_events"] = c.events;
+        c.probes.push_back({(int)c.word + 1, now_us()});
+        send_msg(c, m);
+        stats_.inputs_sent++;
+
+        c.events = Json::Value(Json::arrayValue);
+        c.word++;
+        c.pos = 0;
+        if (c.word >= c.words.size()) {
+            c.playing = false;
+            return;
+        }
+    }
+
+    timers_.push({now + next_key_delay_us(c), c.idx * 2});
+}
+
+void Bench::flush_batch(Client& c) {
+    c.batch_deadline_us = 0;
+    if (c.closed || c.events.empty()) return;
+
+    Json::Value m;
+    m["type"] = "input_batch";
+    m["room_id"] = groups_[c.group].room_id;
+    m["events"] = c.events;
+    int64_t sent = now_us();
+    for (int word : c.batch_commits) {
+        c.probes.push_back({word, sent});
+    }
+    send_msg(c, m);
+    stats_.inputs_sent++;
+
+    c.events = Json::Value(Json::arrayValue);
+    c.batch_commits.clear();
+}
+
+// ===============================
+// Main loop
+// ===============================
+int Bench::run() {
+    if (!load_replay()) return 1;
+
+    Json::CharReaderBuilder rb;
+    reader_.reset(rb.newCharReader());
+    writer_["indentation"] = "";
+
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+
+    int group_count = (cfg_.clients + cfg_.room_size - 1) / cfg_.room_size;
+    groups_.resize(group_count);
+    clients_.resize(cfg_.clients + cfg_.spectators);
+    for (int i = 0; i < (int)clients_.size(); i++) {
+        Client& c = clients_[i];
+        c.idx = i;
+        c.rng.seed(cfg_.seed + i);
+        if (i < cfg_.clients) {
+            c.group = i / cfg_.room_size;
+            c.leader = (i % cfg_.room_size) == 0;
+            groups_[c.group].members++;
+        } else {
+            c.spectator = true;
+            c.group = (i - cfg_.clients) % group_count;
+            groups_[c.group].watchers.push_back(i);
+        }
+    }
+
+    std::cout << "[Bench] " << cfg_.clients << " clients in " << group_count << " rooms";
+    if (cfg_.spectators > 0) std::cout << " + " << cfg_.spectators << " spectators";
+    std::cout << " -> " << cfg_.host << ":" << cfg_.port << " for " << cfg_.duration_s << "s\n";
+
+    double cpu_start = read_server_cpu_s();
+    int64_t t_start = now_us();
+    int64_t t_end = t_start + (int64_t)cfg_.duration_s * 1000000;
+    int64_t connect_interval_us = cfg_.connect_rate > 0 ? 1000000 / cfg_.connect_rate : 0;
+    int next_connect = 0;
+    int64_t next_connect_at = t_start;
+
+    std::vector<epoll_event> events(1024);
+
+    while (true) {
+        int64_t now = now_us();
+        if (now >= t_end) break;
+
+        int total = (int)clients_.size();
+        while (next_connect < total && now >= next_connect_at) {
+            open_connection(clients_[next_connect++]);
+            next_connect_at += connect_interval_us;
+        }
+
+        int64_t timeout_us = 10000;
+        if (!timers_.empty()) {
+            timeout_us = std::min<int64_t>(timeout_us, std::max<int64_t>(0, timers_.top().first - now));
+        }
+        if (next_connect < total) {
+            timeout_us = std::min<int64_t>(timeout_us, std::max<int64_t>(0, next_connect_at - now));
+        }
+
+        int n = epoll_wait(epfd_, events.data(), (int)events.size(), (int)(timeout_us / 1000));
+        for (int i = 0; i < n; i++) {
+            Client& c = clients_[events[i].data.u32];
+            if (c.closed) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                if (!c.connected) {
+                    std::cerr << "[Bench] connect failed for client " << c.idx << "\n";
+                }
+                close_client(c);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) on_writable(c);
+            if (!c.closed && (events[i].events & EPOLLIN)) {
+                bool had_hello = c.client_id != 0;
+                on_readable(c);
+                // A follower / spectator that said hello after its leader
+                // created the room
+                Group& g = groups_[c.group];
+                if (!had_hello && c.client_id != 0 && !c.leader && !g.room_id.empty() && !c.joined) {
+                    Json::Value m;
+                    m["type"] = c.spectator ? "spectate" : "join_room";
+                    m["room_id"] = g.room_id;
+                    send_msg(c, m);
+                    c.joined = c.spectator;
+                }
+            }
+        }
+
+        now = now_us();
+        while (!timers_.empty() && timers_.top().first <= now) {
+            int id = timers_.top().second;
+            timers_.pop();
+            if (id & 1) {
+                flush_batch(clients_[id / 2]);
+            } else {
+                type_next(clients_[id / 2], now);
+            }
+        }
+    }
+
+    double wall_s = (now_us() - t_start) / 1e6;
+    double cpu_s = read_server_cpu_s() - cpu_start;
+
+    for (auto& c : clients_) {
+        if (c.fd >= 0) ::close(c.fd);
+    }
+    ::close(epfd_);
+
+    report(wall_s, cpu_s);
+    return 0;
+}
+
+// ===============================
+// Reporting
+// ===============================
+double Bench::read_server_cpu_s() const {
+    if (cfg_.server_pid <= 0) return 0.0;
+
+    std::ifstream f("/proc/" + std::to_string(cfg_.server_pid) + "/stat");
+    std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    // Fields after the parenthesised comm; utime/stime are fields 14/15
+    size_t p = content.rfind(')');
+    if (p == std::string::npos) return 0.0;
+    std::istringstream iss(content.substr(p + 2));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && iss >> field; i++) {
+        if (i == 14) utime = std::stoull(field);
+        if (i == 15) stime = std::stoull(field);
+    }
+    return (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static double percentile_ms(const std::vector<int64_t>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)std::ceil(q * sorted.size());
+    if (i > 0) i--;
+    return sorted[std::min(i, sorted.size() - 1)] / 1000.0;
+}
+
+void Bench::report(double wall_s, double cpu_s) {
+    auto& lat = stats_.latencies_us;
+    std::sort(lat.begin(), lat.end());
+
+    int connected = 0;
+    int watching = 0;
+    for (const auto& c : clients_) {
+        if (c.client_id == 0) continue;
+        if (c.spectator) watching++;
+        else connected++;
+    }
+
+    double p50 = percentile_ms(lat, 0.50);
+    double p99 = percentile_ms(lat, 0.99);
+    double p999 = percentile_ms(lat, 0.999);
+    double max = lat.empty() ? 0.0 : lat.back() / 1000.0;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "\n=== kbh_bench results ===\n"
+              << "Clients connected : " << connected << "/" << cfg_.clients
+              << "  (disconnects: " << stats_.disconnects << ")\n"
+              << "Games started/ended: " << stats_.games_started << "/" << stats_.games_ended << "\n"
+              << "Inputs sent       : " << stats_.inputs_sent << "\n"
+              << "Latency samples   : " << lat.size() << "\n"
+              << "input->game_state : p50 " << p50 << "ms  p99 " << p99
+              << "ms  p999 " << p999 << "ms  max " << max << "ms\n"
+              << "Messages/sec      : sent " << stats_.msgs_sent / wall_s
+              << "  recv " << stats_.msgs_recv / wall_s << "\n"
+              << "Bytes/sec         : sent " << stats_.bytes_sent / wall_s
+              << "  recv " << stats_.bytes_recv / wall_s << "\n"
+              << "Errors            : " << stats_.errors << "\n";
+    if (cfg_.spectators > 0) {
+        std::cout << "Spectators        : " << watching << "/" << cfg_.spectators
+                  << " connected, " << stats_.spectator_states / wall_s << " game_states/sec total ("
+                  << (watching ? stats_.spectator_states / wall_s / watching : 0.0) << " per watcher)\n";
+    }
+    if (cfg_.server_pid > 0) {
+        std::cout << "Server CPU        : " << cpu_s << "s over " << wall_s << "s ("
+                  << std::setprecision(1) << 100.0 * cpu_s / wall_s << "% of one core)\n";
+    }
+
+    if (!cfg_.json_out.empty()) {
+        Json::Value out;
+        out["clients"] = cfg_.clients;
+        out["connected"] = connected;
+        out["room_size"] = cfg_.room_size;
+        out["wpm"] = cfg_.wpm;
+        out["seed"] = cfg_.seed;
+        out["stream"] = cfg_.stream;
+        out["wall_s"] = wall_s;
+        out["inputs_sent"] = (Json::UInt64)stats_.inputs_sent;
+        out["latency_samples"] = (Json::UInt64)lat.size();
+        out["latency_ms"]["p50"] = p50;
+        out["latency_ms"]["p99"] = p99;
+        out["latency_ms"]["p999"] = p999;
+        out["latency_ms"]["max"] = max;
+        out["msgs_sent_per_s"] = stats_.msgs_sent / wall_s;
+        out["msgs_recv_per_s"] = stats_.msgs_recv / wall_s;
+        out["errors"] = (Json::UInt64)stats_.errors;
+        out["spectators"] = watching;
+        out["spectator_states_per_s"] = stats_.spectator_states / wall_s;
+        out["disconnects"] = (Json::UInt64)stats_.disconnects;
+        if (cfg_.server_pid > 0) {
+            out["server_cpu_s"] = cpu_s;
+            out["server_cpu_pct"] = 100.0 * cpu_s / wall_s;
+        }
+        Json::StreamWriterBuilder b;
+        std::ofstream(cfg_.json_out) << Json::writeString(b, out) << "\n";
+        std::cout << "Wrote " << cfg_.json_out << "\n";
+    }
+}
+
+// ===============================
+// main
+// ===============================
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&](void) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << a << "\n";
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--host") cfg.host = next();
+        else if (a == "--port") cfg.port = std::stoi(next());
+        else if (a == "--clients") cfg.clients = std::stoi(next());
+        else if (a == "--room-size") cfg.room_size = std::max(2, std::min(8, std::stoi(next())));
+        else if (a == "--wpm") cfg.wpm = std::stod(next());
+        else if (a == "--error-rate") cfg.error_rate = std::stod(next());
+        else if (a == "--duration") cfg.duration_s = std::stoi(next());
+        else if (a == "--game-ms") cfg.game_ms = std::stoi(next());
+        else if (a == "--connect-rate") cfg.connect_rate = std::stoi(next());
+        else if (a == "--seed") cfg.seed = (uint32_t)std::stoul(next());
+        else if (a == "--replay") cfg.replay_path = next();
+        else if (a == "--server-pid") cfg.server_pid = std::stoi(next());
+        else if (a == "--json") cfg.json_out = next();
+        else if (a == "--stream") cfg.stream = true;
+        else if (a == "--flush-ms") cfg.flush_ms = std::max(1, std::stoi(next()));
+        else if (a == "--spectators") cfg.spectators = std::max(0, std::stoi(next()));
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+
+    Bench bench(cfg);
+    return bench.run();
+}
@@ -0,0 +1,521 @@
+// Microbenchmarks for the server's hot paths.
+//
+//   kbh_microbench [--filter substring] [--runs 5] [--min-ms 50]
+//                  [--out results.json] [--label name]
+//                  [--compare baseline.json [--threshold 10]]
+//
+// Each benchmark is calibrated to run for at least --min-ms, then timed
+// --runs times; the median (and fastest) time per operation is reported.
+// Covers NDJSON framing, parse and serialize of every message type,
+// Room::process_input, Room::get_rankings, Server::broadcast_room_state
+// (to socketpair peers) and RoomManager::join_random at several room
+// counts. Everything runs in this process: no server, no database.
+//
+// --out writes the results as JSON; --compare reads such a file (from an
+// earlier commit) and prints the change per benchmark, exiting 1 if any got
+// slower than --threshold percent. `make bench` runs it with --label set to
+// the current commit.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <jsoncpp/json/json.h>
+#include "server.h"
+#include "memory_database.h"
+#include "log.h"
+
+// ===============================
+// Harness
+// ===============================
+struct Options {
+    std::string filter;
+    int runs = 5;
+    int min_ms = 50;
+    std::string out;
+    std::string label;
+    std::string compare;
+    double threshold_pct = 10.0;
+};
+
+// Accumulates time between resume() and pause(), so per-iteration setup
+// can be left out of the measurement
+class Timer {
+public:
+    void resume() { started_ = Clock::now(); }
+    void pause() { elapsed_ += Clock::now() - started_; }
+    double ns() const { return std::chrono::duration<double, std::nano>(elapsed_).count(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point started_;
+    Clock::duration elapsed_{0};
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;   // per run
+    double ns_per_op = 0.0;    // median of the runs
+    double min_ns_per_op = 0.0;
+};
+
+// body(n, timer) does n operations; the timer is running when it is called
+using Body = std::function<void(uint64_t, Timer&)>;
+
+class Suite {
+public:
+    explicit Suite(const Options& opts) : opts_(opts) {}
+
+    void run(const std::string& name, const Body& body) {
+        if (!opts_.filter.empty() && name.find(opts_.filter) == std::string::npos) return;
+
+        // Grow n until one run takes --min-ms
+        uint64_t n = 1;
+        while (true) {
+            double ns = time(body, n);
+            if (ns >= opts_.min_ms * 1e6 || n >= (1ull << 32)) break;
+            double scale = ns > 0 ? opts_.min_ms * 1e6 / ns * 1.2 : 10.0;
+            n = std::max<uint64_t>(n + 1, (uint64_t)(n * std::min(scale, 10.0)));
+        }
+
+        std::vector<double> per_op;
+        for (int i = 0; i < opts_.runs; i++) {
+            per_op.push_back(time(body, n) / n);
+        }
+        std::sort(per_op.begin(), per_op.end());
+
+        Result r{name, n, per_op[per_op.size() / 2], per_op.front()};
+        std::cout << std::left << std::setw(52) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.ns_per_op << " ns/op"
+                  << std::setw(12) << r.min_ns_per_op << " min" << std::endl;
+        results_.push_back(r);
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    static double time(const Body& body, uint64_t n) {
+        Timer timer;
+        timer.resume();
+        body(n, timer);
+        timer.pause();
+        return timer.ns();
+    }
+
+    const Options& opts_;
+    std::vector<Result> results_;
+};
+
+// Keeps the compiler from dropping a computed value
+template <typename T>
+static void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// ===============================
+// Fixtures
+// ===============================
+static const char* kParagraph =
+    "the quick brown fox jumps over the lazy dog while seven knights guard the old "
+    "castle gate and a small band of travelers waits for the morning bell to ring "
+    "across the quiet valley before the long march north begins under a pale sky "
+    "with banners raised and drums beating a slow steady rhythm for every step";
+
+// One sample per client -> server message type, as the client sends them
+static const std::vector<std::pair<std::string, std::string>> kClientMessages = {
+    {"time_sync", R"({"type":"time_sync","client_time_ms":1712345678901})"},
+    {"set_username", R"({"type":"set_username","username":"Player123"})"},
+    {"sign_in", R"({"type":"sign_in","username":"knight_rider","password":"correct horse battery"})"},
+    {"create_account", R"({"type":"create_account","username":"knight_rider","password":"correct horse battery"})"},
+    {"change_password", R"({"type":"change_password","username":"knight_rider","old_password":"correct horse battery","new_password":"staple"})"},
+    {"sign_out", R"({"type":"sign_out"})"},
+    {"create_room", R"({"type":"create_room"})"},
+    {"join_room", R"({"type":"join_room","room_id":"K7Q2MX"})"},
+    {"join_random", R"({"type":"join_random"})"},
+    {"queue_leave", R"({"type":"queue_leave"})"},
+    {"tournament_join", R"({"type":"tournament_join"})"},
+    {"tournament_leave", R"({"type":"tournament_leave"})"},
+    {"spectate", R"({"type":"spectate","room_id":"K7Q2MX"})"},
+    {"resume", R"({"type":"resume","session_token":"9f2c61d0a4b7e83c5d1f0a6b2e9c7d48","has_paragraph":true})"},
+    {"exit_room", R"({"type":"exit_room"})"},
+    {"ready", R"({"type":"ready"})"},
+    {"unready", R"({"type":"unready"})"},
+    {"set_private", R"({"type":"set_private","is_private":true})"},
+    {"start_game", R"({"type":"start_game","duration_ms":50000,"mode":"arena"})"},
+    {"start_training", R"({"type":"start_training"})"},
+    {"save_training_result", R"({"type":"save_training_result","paragraph":"the quick brown fox jumps over the lazy dog","wpm":85.5,"accuracy":94.2,"duration_ms":48000,"word_idx":42})"},
+    {"leaderboard", R"({"type":"leaderboard"})"},
+    {"profile", R"({"type":"profile"})"},
+    {"input", R"({"type":"input","room_id":"K7Q2MX","word_idx":12,"char_events":[{"type":"char","char":"k","time_ms":1000},{"type":"char","char":"n","time_ms":1090},{"type":"char","char":"i","time_ms":1170},{"type":"char","char":"g","time_ms":1260},{"type":"char","char":"h","time_ms":1340},{"type":"char","char":"t","time_ms":1430},{"type":"char","char":"s","time_ms":1510}]})"},
+    {"input_batch", R"({"type":"input_batch","room_id":"K7Q2MX","events":[{"type":"char","char":"h","time_ms":1000},{"type":"backspace","time_ms":1150},{"type":"char","char":"e","time_ms":1300},{"type":"commit","word_idx":10,"time_ms":1450}]})"},
+};
+
+// The keystrokes of one word, as an `input` message carries them
+static Json::Value word_events(const std::string_view& word, int64_t start_ms) {
+    Json::Value events(Json::arrayValue);
+    for (size_t i = 0; i < word.size(); i++) {
+        Json::Value e;
+        e["type"] = "char";
+        e["char"] = std::string(1, word[i]);
+        e["time_ms"] = (Json::Int64)(start_ms + 80 * (int64_t)i);
+        events.append(e);
+    }
+    return events;
+}
+
+// A Server with players on socketpairs. Nothing listens and no tick runs,
+// so private handlers can be called straight from here.
+class ServerBench {
+public:
+    ServerBench() : server_("127.0.0.1", 0, &db_) {}
+
+    ~ServerBench() {
+        for (int fd : fds_) close(fd);
+        for (int fd : peers_) close(fd);
+    }
+
+    // A connected client; its peer end is drained by drain()
+    int connect() {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return -1;
+        fcntl(sv[1], F_SETFL, O_NONBLOCK);
+        Server::ClientInfo info;
+        info.client_id = (int)fds_.size() + 1;
+        info.display_name = "Knight " + std::to_string(info.client_id);
+        server_.clients_[sv[0]] = info;
+        fds_.push_back(sv[0]);
+        peers_.push_back(sv[1]);
+        return sv[0];
+    }
+
+    Room* room_with(int players) {
+        int host = connect();
+        Room* room = server_.room_manager_.create_room(host, server_.clients_[host].client_id,
+                                                       server_.clients_[host].display_name,
+                                                       Paragraph::make(kParagraph));
+        for (int i = 1; i < players; i++) {
+            int fd = connect();
+            std::string err;
+            server_.room_manager_.join_room(room->id(), fd, server_.clients_[fd].client_id,
+                                            server_.clients_[fd].display_name, err);
+        }
+        return room;
+    }
+
+    // Reads and discards everything sent to the clients so far
+    void drain() {
+        char buffer[65536];
+        for (int fd : peers_) {
+            while (read(fd, buffer, sizeof(buffer)) > 0) {}
+        }
+    }
+
+    void broadcast_room_state(Room* room) { server_.broadcast_room_state(room); }
+    Json::Value room_state_json(Room* room) { return server_.room_state_json(room); }
+    Json::Value game_state_json(Room* room) { return server_.game_state_json(room); }
+
+    static bool next_line(std::string& buffer, std::string& line) { return Server::next_line(buffer, line); }
+    static bool parse_message(const std::string& line, Json::Value& msg, std::string& errs) {
+        return Server::parse_message(line, msg, errs);
+    }
+    static std::string json_line(const Json::Value& obj) { return Server::json_line(obj); }
+
+private:
+    MemoryDatabase db_;
+    Server server_;
+    std::vector<int> fds_;
+    std::vector<int> peers_;
+};
+
+// ===============================
+// Benchmarks
+// ===============================
+static void bench_framing(Suite& suite) {
+    // What one recv() typically brings in under load: a mix of messages
+    std::string chunk;
+    for (int i = 0; i < 4; i++) {
+        for (const auto& [type, line] : kClientMessages) chunk += line + "\n";
+    }
+    suite.run("ndjson/frame_lines", [&](uint64_t n, Timer& timer) {
+        std::string buffer, line;
+        for (uint64_t done = 0; done < n; ) {
+            timer.pause();
+            buffer = chunk;
+            timer.resume();
+            while (done < n && ServerBench::next_line(buffer, line)) {
+                keep(line);
+                done++;
+            }
+        }
+    });
+
+    // A message split across recv() calls: the leftover waits for the rest
+    suite.run("ndjson/frame_split_line", [&](uint64_t n, Timer&) {
+        const std::string& line = kClientMessages.back().second;
+        std::string buffer, out;
+        for (uint64_t i = 0; i < n; i++) {
+            buffer.append(line, 0, line.size() / 2);
+            keep(ServerBench::next_line(buffer, out));
+            buffer.append(line, line.size() / 2, std::string::npos);
+            buffer += '\n';
+            keep(ServerBench::next_line(buffer, out));
+        }
+    });
+}
+
+static void bench_json(Suite& suite, ServerBench& fixture) {
+    std::vector<std::pair<std::string, std::string>> messages = kClientMessages;
+
+    // Server -> client: the big ones and a typical small one
+    Room* room = fixture.room_with(8);
+    room->start_game(0, 50000);
+    messages.push_back({"room_state", ServerBench::json_line(fixture.room_state_json(room))});
+    messages.push_back({"game_state", ServerBench::json_line(fixture.game_state_json(room))});
+    messages.push_back({"error", R"({"type":"error","code":"ROOM_FULL","message":"Room is full"})"});
+
+    for (const auto& [type, line] : messages) {
+        suite.run("json/parse/" + type, [&](uint64_t n, Timer&) {
+            for (uint64_t i = 0; i < n; i++) {
+                Json::Value msg;
+                std::string errs;
+                keep(ServerBench::parse_message(line, msg, errs));
+                keep(msg);
+            }
+        });
+
+        Json::Value msg;
+        std::string errs;
+        ServerBench::parse_message(line, msg, errs);
+        suite.run("json/serialize/" + type, [&](uint64_t n, Timer&) {
+            for (uint64_t i = 0; i < n; i++) {
+                std::string out = ServerBench::json_line(msg);
+                keep(out);
+            }
+        });
+    }
+}
+
+static void bench_room(Suite& suite) {
+    Room room("BENCH1", kParagraph);
+    for (int i = 0; i < 8; i++) {
+        room.add_player(100 + i, i + 1, "Knight " + std::to_string(i + 1));
+    }
+    const auto& words = room.paragraph().words();
+    std::vector<Json::Value> events;
+    for (size_t w = 0; w < words.size(); w++) {
+        events.push_back(word_events(words[w], 1000 + 600 * (int64_t)w));
+    }
+
+    // One `input` per committed word, players taking turns; the game starts
+    // over (untimed) when everyone is through the paragraph
+    suite.run("room/process_input", [&](uint64_t n, Timer& timer) {
+        int word = (int)words.size();
+        int player = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            if (word >= (int)words.size()) {
+                timer.pause();
+                room.start_game(0, 50000);
+                word = 0;
+                player = 0;
+                timer.resume();
+            }
+            room.process_input(100 + player, word, events[word]);
+            if (++player == 8) {
+                player = 0;
+                word++;
+            }
+        }
+    });
+
+    for (int players : {2, 8}) {
+        Room ranked("BENCH2", kParagraph);
+        for (int i = 0; i < players; i++) {
+            ranked.add_player(200 + i, i + 1, "Knight " + std::to_string(i + 1));
+        }
+        ranked.start_game(0, 50000);
+        // Spread the field out so the ordering has work to do
+        for (int i = 0; i < players; i++) {
+            for (int w = 0; w < 3 + (i * 5) % 11; w++) {
+                ranked.process_input(200 + i, w, events[w]);
+            }
+        }
+        suite.run("room/get_rankings/players=" + std::to_string(players), [&](uint64_t n, Timer&) {
+            for (uint64_t i = 0; i < n; i++) {
+                auto rankings = ranked.get_rankings();
+                keep(rankings);
+            }
+        });
+    }
+}
+
+static void bench_broadcast(Suite& suite) {
+    for (int players : {2, 8}) {
+        ServerBench fixture;
+        Room* room = fixture.room_with(players);
+        suite.run("server/broadcast_room_state/players=" + std::to_string(players),
+                  [&](uint64_t n, Timer& timer) {
+            for (uint64_t i = 0; i < n; i++) {
+                fixture.broadcast_room_state(room);
+                // Keep the socket buffers from filling (a full one is a slow reader)
+                if (i % 32 == 31) {
+                    timer.pause();
+                    fixture.drain();
+                    timer.resume();
+                }
+            }
+            timer.pause();
+            fixture.drain();
+            timer.resume();
+        });
+    }
+}
+
+static void bench_join_random(Suite& suite) {
+    for (int rooms : {1, 100, 10000}) {
+        RoomManager manager(nullptr);
+        for (int i = 0; i < rooms; i++) {
+            manager.create_room(1000 + i, i + 1, "Host");
+        }
+        // Every join lands in a room with free seats; leaving restores it
+        suite.run("room_manager/join_random/rooms=" + std::to_string(rooms), [&](uint64_t n, Timer& timer) {
+            for (uint64_t i = 0; i < n; i++) {
+                Room* room = manager.join_random(1, 1, "Joiner");
+                keep(room);
+                timer.pause();
+                manager.remove_fd(1);
+                timer.resume();
+            }
+        });
+    }
+}
+
+// ===============================
+// Results
+// ===============================
+static std::string utc_now() {
+    char buf[32];
+    std::time_t t = std::time(nullptr);
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&t));
+    return buf;
+}
+
+static bool write_results(const Options& opts, const std::vector<Result>& results) {
+    Json::Value out;
+    out["suite"] = "kbh_microbench";
+    out["label"] = opts.label;
+    out["timestamp"] = utc_now();
+    out["runs"] = opts.runs;
+    out["min_ms"] = opts.min_ms;
+    Json::Value list(Json::arrayValue);
+    for (const auto& r : results) {
+        Json::Value b;
+        b["name"] = r.name;
+        b["iterations"] = (Json::UInt64)r.iterations;
+        b["ns_per_op"] = r.ns_per_op;
+        b["min_ns_per_op"] = r.min_ns_per_op;
+        b["ops_per_sec"] = r.ns_per_op > 0 ? 1e9 / r.ns_per_op : 0.0;
+        list.append(b);
+    }
+    out["benchmarks"] = list;
+
+    std::ofstream file(opts.out);
+    if (!file) {
+        std::cerr << "cannot write " << opts.out << "\n";
+        return false;
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "  ";
+    file << Json::writeString(builder, out) << "\n";
+    std::cout << "Results written to " << opts.out << std::endl;
+    return true;
+}
+
+// false if any benchmark got slower than the threshold
+static bool compare(const Options& opts, const std::vector<Result>& results) {
+    std::ifstream file(opts.compare);
+    Json::Value baseline;
+    Json::CharReaderBuilder builder;
+    std::string errs;
+    if (!file || !Json::parseFromStream(builder, file, &baseline, &errs)) {
+        std::cerr << "cannot read baseline " << opts.compare << "\n";
+        return false;
+    }
+    std::map<std::string, double> before;
+    for (const auto& b : baseline["benchmarks"]) {
+        before[b["name"].asString()] = b["ns_per_op"].asDouble();
+    }
+
+    std::cout << "\n=== vs " << opts.compare;
+    if (!baseline["label"].asString().empty()) std::cout << " (" << baseline["label"].asString() << ")";
+    std::cout << " ===\n";
+
+    int regressions = 0;
+    for (const auto& r : results) {
+        auto it = before.find(r.name);
+        if (it == before.end() || it->second <= 0) continue;
+        double change = (r.ns_per_op - it->second) / it->second * 100.0;
+        bool slower = change > opts.threshold_pct;
+        regressions += slower;
+        std::cout << std::left << std::setw(52) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << it->second << " -> "
+                  << std::setw(10) << r.ns_per_op << " ns/op  " << std::showpos
+                  << std::setw(7) << change << "%" << std::noshowpos
+                  << (slower ? "  SLOWER" : "") << "\n";
+    }
+    std::cout << regressions << " regression(s) over " << opts.threshold_pct << "%" << std::endl;
+    return regressions == 0;
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&](void) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << a << "\n";
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--filter") opts.filter = next();
+        else if (a == "--runs") opts.runs = std::max(1, std::stoi(next()));
+        else if (a == "--min-ms") opts.min_ms = std::max(1, std::stoi(next()));
+        else if (a == "--out") opts.out = next();
+        else if (a == "--label") opts.label = next();
+        else if (a == "--compare") opts.compare = next();
+        else if (a == "--threshold") opts.threshold_pct = std::stod(next());
+        else {
+            std::cerr << "unknown option " << a << "\n";
+            return 2;
+        }
+    }
+
+    // Room and server chatter would only time the logger
+    logging::set_level(logging::Level::Error);
+
+    Suite suite(opts);
+    {
+        ServerBench fixture;
+        bench_framing(suite);
+        bench_json(suite, fixture);
+    }
+    bench_room(suite);
+    bench_broadcast(suite);
+    bench_join_random(suite);
+
+    if (!opts.out.empty() && !write_results(opts, suite.results())) return 2;
+    if (!opts.compare.empty() && !compare(opts, suite.results())) return 1;
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Replays a stored .kbr game through the scoring engine.
+//
+//   kbh_replay <file.kbr> [--speed N] [--dump]
+//
+// --speed N  play at N times real time (default 0 = as fast as possible)
+// --dump     print every record instead of scoring
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include "replay_reader.h"
+
+static void dump(ReplayReader& reader) {
+    const auto& h = reader.header();
+    ReplayEvent ev;
+    while (reader.next(ev)) {
+        std::cout << std::setw(8) << (ev.time_ms - h.server_start_ms) << "ms  slot " << ev.slot_idx << "  ";
+        if (ev.code == replay::kCodeCommit) {
+            std::cout << "commit word " << ev.word_idx;
+        } else if (ev.code == replay::kCodeWord) {
+            std::cout << "word";
+        } else if (ev.code == replay::kCodeBackspace) {
+            std::cout << "backspace";
+        } else {
+            std::cout << "char '" << static_cast<char>(ev.code) << "'";
+        }
+        std::cout << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <file.kbr> [--speed N] [--dump]\n";
+        return 2;
+    }
+
+    std::string path = argv[1];
+    double speed = 0.0;
+    bool dump_only = false;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            speed = std::stod(argv[++i]);
+        } else if (!strcmp(argv[i], "--dump")) {
+            dump_only = true;
+        }
+    }
+
+    ReplayReader reader;
+    std::string err;
+    if (!reader.open(path, err)) {
+        std::cerr << "[Replay] " << err << "\n";
+        return 1;
+    }
+
+    const auto& h = reader.header();
+    std::cout << "=== Replay " << h.room_id << " ===\n"
+              << "Players: " << h.players.size()
+              << "  Duration: " << h.duration_ms << "ms"
+              << "  File: " << reader.file_size() << " bytes\n";
+
+    if (dump_only) {
+        dump(reader);
+        return 0;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    ReplayResult result = replay_game(reader, speed);
+    double wall_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Events: " << result.events << "  Inputs: " << result.inputs
+              << "  Complete: " << (result.complete ? "yes" : "no (truncated)")
+              << "  Replayed in " << std::fixed << std::setprecision(2) << wall_ms << "ms\n\n";
+
+    for (const auto& r : result.rankings) {
+        std::cout << r.rank << ". " << r.display_name
+                  << " | Words: " << r.word_idx
+                  << " | WPM: " << std::setprecision(1) << r.wpm
+                  << " | Acc: " << r.accuracy << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#!/bin/sh
+# Training workload for the profile-guided release build (make release).
+#
+#   sh tools/pgo_train.sh build/pgo
+#
+# Runs the instrumented binaries in the given directory: a server on the
+# in-memory database under kbh_bench load (word-by-word input, then
+# input_batch streaming with spectators), and the microbenchmarks. The
+# server is stopped with SIGTERM so it drains and exits normally, which is
+# when the profile counters are written.
+set -e
+
+BIN_DIR=$(cd "${1:?usage: pgo_train.sh <build dir>}" && pwd)
+PORT=${PGO_TRAIN_PORT:-5590}
+WORK_DIR=$(mktemp -d)
+trap 'kill "$SERVER_PID" 2>/dev/null || true; rm -rf "$WORK_DIR"' EXIT
+
+# Short games so every mode cycles through its phases a few times
+mkdir -p "$WORK_DIR/config"
+cat > "$WORK_DIR/config/server_config.json" <<EOF
+{
+    "server_ip": "127.0.0.1",
+    "server_port": $PORT,
+    "socket_path": "",
+    "db_backend": "memory",
+    "memory_corpus": "",
+    "replay_dir": "replays",
+    "metrics_port": 0,
+    "log_level": "warn",
+    "tournament_enabled": true,
+    "tournament_lobby_ms": 1500,
+    "tournament_round_ms": 3000,
+    "tournament_break_ms": 1000,
+    "drain_timeout_ms": 2000
+}
+EOF
+
+cd "$WORK_DIR"
+"$BIN_DIR/kbh_server" &
+SERVER_PID=$!
+sleep 1
+
+"$BIN_DIR/kbh_bench" --port "$PORT" --clients 200 --duration 20 --game-ms 8000
+"$BIN_DIR/kbh_bench" --port "$PORT" --clients 96 --duration 10 --game-ms 8000 \
+    --stream --spectators 16
+
+kill -TERM "$SERVER_PID"
+wait "$SERVER_PID" || true
+SERVER_PID=
+
+"$BIN_DIR/kbh_microbench" --runs 1 --min-ms 20 --out "$WORK_DIR/bench.json"
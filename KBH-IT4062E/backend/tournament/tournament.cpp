@@ -0,0 +1,179 @@
+#include "tournament.h"
+#include <algorithm>
+#include <queue>
+
+static bool ranks_before(const TournamentStanding& a, const TournamentStanding& b) {
+    if (a.word_idx != b.word_idx) return a.word_idx > b.word_idx;
+    return a.latest_time_ms < b.latest_time_ms;
+}
+
+bool Tournament::enter(int fd, double seed_wpm, int64_t now_ms) {
+    if (phase_ == Phase::Running || phase_ == Phase::Break || entrants_.count(fd)) return false;
+    
+    if (phase_ == Phase::Idle) {
+        phase_ = Phase::Registration;
+        starts_at_ms_ = now_ms + cfg_.lobby_ms;
+    }
+    entrants_[fd] = seed_wpm;
+    return true;
+}
+
+bool Tournament::leave(int fd) {
+    if (!entrants_.erase(fd)) return false;
+    if (phase_ == Phase::Registration && entrants_.empty()) {
+        reset();
+    }
+    return true;
+}
+
+std::vector<int> Tournament::cancel() {
+    std::vector<int> fds;
+    fds.reserve(entrants_.size());
+    for (const auto& kv : entrants_) {
+        fds.push_back(kv.first);
+    }
+    reset();
+    return fds;
+}
+
+void Tournament::rebind(int from_fd, int to_fd) {
+    auto it = entrants_.find(from_fd);
+    if (it == entrants_.end()) return;
+    
+    double seed = it->second;
+    entrants_.erase(it);
+    entrants_[to_fd] = seed;
+}
+
+bool Tournament::ready_to_start(int64_t now_ms) {
+    if (phase_ == Phase::Break) return now_ms >= starts_at_ms_;
+    if (phase_ != Phase::Registration || now_ms < starts_at_ms_) return false;
+    if ((int)entrants_.size() < std::max(2, cfg_.min_players)) {
+        starts_at_ms_ = now_ms + cfg_.lobby_ms;
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::vector<int>> Tournament::seed_round() {
+    phase_ = Phase::Running;
+    round_++;
+    room_ids_.clear();
+    room_index_.clear();
+    results_.clear();
+    finished_.clear();
+    rooms_left_ = 0;
+    
+    std::vector<std::pair<double, int>> field;
+    field.reserve(entrants_.size());
+    for (const auto& kv : entrants_) {
+        field.push_back({kv.second, kv.first});
+    }
+    std::sort(field.begin(), field.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) return a.first > b.first;
+        return a.second < b.second;
+    });
+    
+    // Snake order: seeds 1..R go to rooms 0..R-1, seeds R+1..2R back again
+    size_t room_count = (field.size() + 7) / 8;
+    std::vector<std::vector<int>> rooms(room_count);
+    for (size_t i = 0; i < field.size(); i++) {
+        size_t row = i / room_count;
+        size_t col = i % room_count;
+        size_t room = (row % 2 == 0) ? col : room_count - 1 - col;
+        rooms[room].push_back(field[i].second);
+    }
+    return rooms;
+}
+
+void Tournament::add_room(const std::string& room_id) {
+    room_index_[room_id] = room_ids_.size();
+    room_ids_.push_back(room_id);
+    results_.emplace_back();
+    finished_.push_back(false);
+    rooms_left_++;
+}
+
+bool Tournament::room_finished(const std::string& room_id) const {
+    auto it = room_index_.find(room_id);
+    return it == room_index_.end() || finished_[it->second];
+}
+
+void Tournament::finish_room(const std::string& room_id, std::vector<TournamentStanding> ranking) {
+    auto it = room_index_.find(room_id);
+    if (it == room_index_.end() || finished_[it->second]) return;
+    
+    results_[it->second] = std::move(ranking);
+    finished_[it->second] = true;
+    rooms_left_--;
+}
+
+std::vector<TournamentStanding> Tournament::close_round(int64_t now_ms, size_t& advancing) {
+    // Merge the per-room lists (each already sorted) through a heap of
+    // their heads: O(N log R) for N players in R rooms
+    using Head = std::pair<size_t, size_t>;  // (room, position)
+    auto worse = [this](const Head& a, const Head& b) {
+        return ranks_before(results_[b.first][b.second], results_[a.first][a.second]);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(worse)> heads(worse);
+    
+    size_t total = 0;
+    for (size_t r = 0; r < results_.size(); r++) {
+        // Entrants who left (or disconnected) since their room finished
+        auto& list = results_[r];
+        list.erase(std::remove_if(list.begin(), list.end(), [this](const TournamentStanding& s) {
+            return !entrants_.count(s.fd);
+        }), list.end());
+        
+        total += results_[r].size();
+        if (!results_[r].empty()) heads.push({r, 0});
+    }
+    
+    std::vector<TournamentStanding> standings;
+    standings.reserve(total);
+    while (!heads.empty()) {
+        Head h = heads.top();
+        heads.pop();
+        standings.push_back(std::move(results_[h.first][h.second]));
+        standings.back().rank = (int)standings.size();
+        if (h.second + 1 < results_[h.first].size()) {
+            heads.push({h.first, h.second + 1});
+        }
+    }
+    
+    // A single room was the final; otherwise the top share goes through
+    advancing = 0;
+    if (results_.size() > 1 && standings.size() > 1) {
+        advancing = (standings.size() * cfg_.advance_pct + 99) / 100;
+        advancing = std::max<size_t>(2, std::min(advancing, standings.size() - 1));
+    }
+    
+    entrants_.clear();
+    for (size_t i = 0; i < advancing; i++) {
+        entrants_[standings[i].fd] = -(double)standings[i].rank;
+    }
+    room_ids_.clear();
+    room_index_.clear();
+    results_.clear();
+    finished_.clear();
+    
+    if (advancing == 0) {
+        reset();
+    } else {
+        phase_ = Phase::Break;
+        starts_at_ms_ = now_ms + cfg_.break_ms;
+    }
+    return standings;
+}
+
+void Tournament::reset() {
+    phase_ = Phase::Idle;
+    round_ = 0;
+    starts_at_ms_ = 0;
+    entrants_.clear();
+    room_ids_.clear();
+    room_index_.clear();
+    results_.clear();
+    finished_.clear();
+    rooms_left_ = 0;
+}
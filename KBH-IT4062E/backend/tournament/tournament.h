@@ -0,0 +1,98 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TournamentConfig {
+    bool enabled = false;
+    int lobby_ms = 60000;      // registration window, opened by the first entrant
+    int min_players = 4;       // window restarts if fewer have entered
+    int round_ms = 60000;      // game length of every round
+    int advance_pct = 50;      // share of a round's field that goes through
+    int break_ms = 10000;      // standings on screen before the next round
+};
+
+// One player's result in a round. Rooms report theirs in room order
+// (word_idx desc, latest_time_ms asc), which is also the global order:
+// every room of a round starts at the same server_start_ms.
+struct TournamentStanding {
+    int fd = -1;
+    int client_id = 0;
+    std::string display_name;
+    int word_idx = 0;
+    int64_t latest_time_ms = 0;
+    double wpm = 0.0;
+    double accuracy = 0.0;
+    int rank = 0;              // global, set by close_round
+};
+
+// Bracket state for one event at a time: registration, then rounds of
+// 8-player rooms that start together. Owns no rooms or sockets; Server
+// creates the rooms it seeds and reports each room's ranking back.
+class Tournament {
+public:
+    enum class Phase { Idle, Registration, Running, Break };
+
+    void set_config(const TournamentConfig& cfg) { cfg_ = cfg; }
+    const TournamentConfig& config() const { return cfg_; }
+
+    Phase phase() const { return phase_; }
+    int round() const { return round_; }
+    int64_t starts_at_ms() const { return starts_at_ms_; }
+    size_t entrant_count() const { return entrants_.size(); }
+
+    // Registration; false once the event has started (or fd is entered)
+    bool enter(int fd, double seed_wpm, int64_t now_ms);
+    // Drops an entrant; mid-event this is a forfeit
+    bool leave(int fd);
+    bool is_entrant(int fd) const { return entrants_.count(fd) > 0; }
+    void rebind(int from_fd, int to_fd);  // parked / resumed session
+
+    // Time to seed a round: registration window over with enough players
+    // (the window restarts otherwise), or the break between rounds is over
+    bool ready_to_start(int64_t now_ms);
+
+    // Splits the field into rooms of up to 8, snake-seeded so every room
+    // gets a similar spread of strong and weak players
+    std::vector<std::vector<int>> seed_round();
+    void add_room(const std::string& room_id);
+    bool owns_room(const std::string& room_id) const { return room_index_.count(room_id) > 0; }
+    const std::vector<std::string>& round_rooms() const { return room_ids_; }
+    bool room_finished(const std::string& room_id) const;
+
+    // ranking must be in room order; entries of players who are no longer
+    // entrants when the round closes are dropped
+    void finish_room(const std::string& room_id, std::vector<TournamentStanding> ranking);
+    bool round_complete() const { return phase_ == Phase::Running && rooms_left_ == 0; }
+
+    // k-way merge of the room rankings into the round's standings. The
+    // first `advancing` go through to a round seeded after break_ms (0 =
+    // that was the final and the event resets to Idle); the rest are out.
+    std::vector<TournamentStanding> close_round(int64_t now_ms, size_t& advancing);
+
+    // Server shutdown: ends the event between rounds; returns who was entered
+    std::vector<int> cancel();
+
+private:
+    void reset();
+
+    TournamentConfig cfg_;
+    Phase phase_ = Phase::Idle;
+    int round_ = 0;
+    int64_t starts_at_ms_ = 0;
+
+    // fd -> seed (higher = stronger): WPM at entry, then -(global rank)
+    std::unordered_map<int, double> entrants_;
+
+    std::vector<std::string> room_ids_;
+    std::unordered_map<std::string, size_t> room_index_;
+    std::vector<std::vector<TournamentStanding>> results_;
+    std::vector<bool> finished_;
+    size_t rooms_left_ = 0;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "tracer.h"
+#include "log.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+namespace tracing {
+
+thread_local MessageSpan* MessageSpan::current_ = nullptr;
+
+Tracer& Tracer::global() {
+    // Never destroyed: client threads may still finish a span during exit
+    static Tracer* tracer = [] {
+        Tracer* t = new Tracer();
+        std::atexit([] { Tracer::global().stop(); });
+        return t;
+    }();
+    return *tracer;
+}
+
+bool Tracer::start(const std::string& path, int sample_every) {
+    if (sample_every <= 0 || file_) return false;
+
+    file_ = fopen(path.c_str(), "w");
+    if (!file_) {
+        LOG_ERROR("trace", "Cannot open trace file").field("path", path).field("error", strerror(errno));
+        return false;
+    }
+
+    // JSON array format; the closing bracket is optional for trace viewers,
+    // so a file cut short by a crash still opens
+    fputs("[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+          "\"args\":{\"name\":\"kbh_server\"}}", file_);
+    fflush(file_);
+
+    thread_ = std::thread(&Tracer::write_loop, this);
+    sample_every_.store(sample_every, std::memory_order_relaxed);
+    LOG_INFO("trace", "Tracing messages").field("path", path).field("sample_every", sample_every);
+    return true;
+}
+
+void Tracer::stop() {
+    sample_every_.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) return;
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+bool Tracer::sample() {
+    int every = sample_every_.load(std::memory_order_relaxed);
+    if (every == 0) return false;
+
+    // xorshift64, seeded per thread
+    thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state % (uint64_t)every == 0;
+}
+
+void Tracer::write_loop() {
+    std::string batch;
+    while (true) {
+        bool stopping;
+        uint64_t dropped;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs), [&] { return stop_; });
+            batch.swap(pending_);
+            dropped = dropped_;
+            dropped_ = 0;
+            stopping = stop_;
+        }
+
+        if (!batch.empty()) {
+            fwrite(batch.data(), 1, batch.size(), file_);
+            batch.clear();
+        }
+        if (dropped > 0) {
+            LOG_WARN("trace", "Spans dropped (buffer full)").field("count", dropped);
+        }
+        if (stopping) {
+            fputs("\n]\n", file_);
+            fclose(file_);
+            file_ = nullptr;
+            return;
+        }
+        fflush(file_);
+    }
+}
+
+double Tracer::micros(Clock::time_point t) const {
+    return std::chrono::duration<double, std::micro>(t - epoch_).count();
+}
+
+void Tracer::append_event(const char* name, const std::string& detail, int tid,
+                          Clock::time_point begin, Clock::time_point end, const std::string& args) {
+    char head[160];
+    snprintf(head, sizeof(head), ",\n{\"name\":\"%s%s%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+             "\"ts\":%.3f,\"dur\":%.3f",
+             name, detail.empty() ? "" : " ", detail.c_str(), tid,
+             micros(begin), std::chrono::duration<double, std::micro>(end - begin).count());
+    pending_ += head;
+    if (!args.empty()) {
+        pending_ += ",\"args\":{";
+        pending_ += args;
+        pending_ += '}';
+    }
+    pending_ += '}';
+}
+
+void Tracer::submit(const MessageSpan& span) {
+    // A message that failed to parse never reached a handler
+    bool handled = span.handled_at_ != Clock::time_point();
+    Clock::time_point end = handled ? span.handled_at_ : span.parsed_at_;
+    if (end == Clock::time_point()) end = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) return;
+    if (pending_.size() > kMaxPendingBytes) {
+        dropped_++;
+        return;
+    }
+
+    // The type is client-controlled; keep only what is safe in a JSON string
+    std::string type;
+    for (char c : span.type_.substr(0, 32)) {
+        if (isalnum((unsigned char)c) || c == '_') type += c;
+    }
+    if (type.empty()) type = handled ? "unknown" : "unparsed";
+
+    std::string args = "\"fd\":" + std::to_string(span.fd_);
+    if (span.children_dropped_ > 0) {
+        args += ",\"children_dropped\":" + std::to_string(span.children_dropped_);
+    }
+
+    append_event("message", type, span.fd_, span.received_at_, end, args);
+    // Between lock_wait and parse: earlier lines from the same recv()
+    append_event("lock_wait", "", span.fd_, span.received_at_, span.locked_at_, "");
+    if (span.parsed_at_ != Clock::time_point()) {
+        append_event("parse", "", span.fd_, span.parse_at_, span.parsed_at_, "");
+    }
+    if (handled) {
+        append_event("dispatch", "", span.fd_, span.parsed_at_, span.dispatched_at_, "");
+        append_event("handler", type, span.fd_, span.dispatched_at_, span.handled_at_, "");
+    }
+    for (const auto& child : span.children_) {
+        std::string child_args;
+        if (child.bytes > 0) child_args = "\"bytes\":" + std::to_string(child.bytes);
+        append_event(child.name, "", span.fd_, child.begin, child.end, child_args);
+    }
+}
+
+MessageSpan::MessageSpan(int fd, Clock::time_point received_at, Clock::time_point locked_at)
+    : sampled_(Tracer::global().sample()),
+      fd_(fd) {
+    if (!sampled_) return;
+    received_at_ = received_at;
+    locked_at_ = locked_at;
+    parse_at_ = Clock::now();
+    current_ = this;
+}
+
+MessageSpan::~MessageSpan() {
+    if (!sampled_) return;
+    current_ = nullptr;
+    Tracer::global().submit(*this);
+}
+
+void MessageSpan::dispatched(const std::string& type) {
+    if (!sampled_) return;
+    type_ = type;
+    dispatched_at_ = Clock::now();
+}
+
+void MessageSpan::add_child(const char* name, Clock::time_point begin, Clock::time_point end,
+                            size_t bytes) {
+    if ((int)children_.size() >= kMaxChildren) {
+        children_dropped_++;
+        return;
+    }
+    children_.push_back({name, begin, end, bytes});
+}
+
+} // namespace tracing
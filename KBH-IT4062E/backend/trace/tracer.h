@@ -0,0 +1,139 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sampled per-message tracing in Chrome trace-event format.
+//
+// One in `sample_every` client messages gets a MessageSpan that records
+// monotonic timestamps from the recv() that brought it in, through lock
+// wait, parse and dispatch, to the end of its handler, plus every
+// serialize and send the handler did on the way. Finished spans become
+// "X" (complete) events, one row per client fd, streamed to a JSON file
+// that chrome://tracing or ui.perfetto.dev opens directly.
+//
+// A message that is not sampled costs one relaxed load and a branch (plus
+// a thread-local PRNG step while tracing is on); serialize/send scopes
+// cost a thread-local load when no span is active.
+namespace tracing {
+
+using Clock = std::chrono::steady_clock;
+
+class MessageSpan;
+
+class Tracer {
+public:
+    static Tracer& global();
+
+    // Open `path` and trace one message in `sample_every` (0 = off)
+    bool start(const std::string& path, int sample_every);
+    void stop();
+
+    // Should the next message be traced?
+    bool sample();
+
+    void submit(const MessageSpan& span);
+
+private:
+    Tracer() = default;
+
+    void write_loop();
+    double micros(Clock::time_point t) const;
+    void append_event(const char* name, const std::string& detail, int tid,
+                      Clock::time_point begin, Clock::time_point end, const std::string& args);
+
+    static constexpr int kFlushIntervalMs = 1000;
+    static constexpr size_t kMaxPendingBytes = 4 << 20;  // beyond this spans are dropped
+
+    std::atomic<int> sample_every_{0};
+    Clock::time_point epoch_ = Clock::now();
+    FILE* file_ = nullptr;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;      // formatted events not yet written
+    uint64_t dropped_ = 0;     // spans lost to a full buffer
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// One client message from recv to the end of its handler. Constructed for
+// every message; does nothing unless the Tracer sampled it.
+class MessageSpan {
+public:
+    MessageSpan(int fd, Clock::time_point received_at, Clock::time_point locked_at);
+    ~MessageSpan();
+
+    MessageSpan(const MessageSpan&) = delete;
+    MessageSpan& operator=(const MessageSpan&) = delete;
+
+    bool sampled() const { return sampled_; }
+    void parsed() { if (sampled_) parsed_at_ = Clock::now(); }
+    void dispatched(const std::string& type);
+    void handled() { if (sampled_) handled_at_ = Clock::now(); }
+
+    // Sampled span being handled on this thread, or nullptr
+    static MessageSpan* current() { return current_; }
+
+    void add_child(const char* name, Clock::time_point begin, Clock::time_point end, size_t bytes);
+
+private:
+    friend class Tracer;
+
+    struct Child {
+        const char* name;
+        Clock::time_point begin;
+        Clock::time_point end;
+        size_t bytes;
+    };
+    static constexpr int kMaxChildren = 64;
+
+    static thread_local MessageSpan* current_;
+
+    bool sampled_;
+    int fd_;
+    std::string type_;
+    Clock::time_point received_at_;
+    Clock::time_point locked_at_;
+    Clock::time_point parse_at_;
+    Clock::time_point parsed_at_;
+    Clock::time_point dispatched_at_;
+    Clock::time_point handled_at_;
+    std::vector<Child> children_;  // allocated only once sampled
+    int children_dropped_ = 0;
+};
+
+// Times a phase ("serialize", "send") of the message being traced on this
+// thread; free when there is none
+class Scope {
+public:
+    explicit Scope(const char* name) : span_(MessageSpan::current()), name_(name) {
+        if (span_) begin_ = Clock::now();
+    }
+    ~Scope() {
+        if (span_) span_->add_child(name_, begin_, Clock::now(), bytes_);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void set_bytes(size_t bytes) { bytes_ = bytes; }
+
+private:
+    MessageSpan* span_;
+    const char* name_;
+    Clock::time_point begin_;
+    size_t bytes_ = 0;
+};
+
+} // namespace tracing
+
+#endif
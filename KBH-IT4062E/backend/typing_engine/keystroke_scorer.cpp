@@ -0,0 +1,93 @@
+#include "keystroke_scorer.h"
+#include <algorithm>
+#include <cctype>
+
+void split_words(std::string_view text, std::vector<std::string_view>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+        size_t start = i;
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i]))) i++;
+        if (i > start) out.push_back(text.substr(start, i - start));
+    }
+}
+
+void KeystrokeScorer::reset(const std::vector<std::string_view>* words, int64_t start_time_ms) {
+    words_ = words;
+    start_time_ms_ = start_time_ms;
+    latest_time_ms_ = 0;
+    committed_words_ = 0;
+    current_word_ = 0;
+    typed_.clear();
+    word_correct_ = 0;
+    total_correct_ = 0;
+    total_typed_ = 0;
+}
+
+std::string_view KeystrokeScorer::target() const {
+    if (!words_ || current_word_ < 0 || current_word_ >= (int)words_->size()) {
+        return {};
+    }
+    return (*words_)[current_word_];
+}
+
+void KeystrokeScorer::begin_word(int word_idx) {
+    current_word_ = word_idx;
+    typed_.clear();
+    word_correct_ = 0;
+}
+
+void KeystrokeScorer::on_char(char c) {
+    std::string_view goal = target();
+    size_t pos = typed_.size();
+    if (pos < goal.size() && goal[pos] == c) {
+        word_correct_++;
+    }
+    typed_ += c;
+    total_typed_++;
+}
+
+void KeystrokeScorer::on_backspace() {
+    if (typed_.empty()) return;
+
+    std::string_view goal = target();
+    size_t pos = typed_.size() - 1;
+    if (pos < goal.size() && goal[pos] == typed_[pos]) {
+        word_correct_--;
+    }
+    typed_.pop_back();
+}
+
+void KeystrokeScorer::commit(int word_idx) {
+    total_correct_ += word_correct_;
+    if (word_idx >= committed_words_) {
+        committed_words_ = word_idx + 1;
+    }
+    begin_word(committed_words_);
+}
+
+double KeystrokeScorer::progress() const {
+    int total_words = words_ ? (int)words_->size() : 0;
+    if (total_words == 0) return 0.0;
+
+    // Fraction of the current word typed correctly so far
+    double partial = 0.0;
+    std::string_view goal = target();
+    if (!goal.empty()) {
+        partial = std::min(1.0, (double)word_correct_ / goal.size());
+    }
+    return std::min(1.0, (committed_words_ + partial) / total_words);
+}
+
+double KeystrokeScorer::wpm() const {
+    if (latest_time_ms_ <= start_time_ms_) return 0.0;
+    double elapsed_minutes = (latest_time_ms_ - start_time_ms_) / 60000.0;
+    // WPM = (correct chars / 5) / elapsed minutes
+    return (total_correct_chars() / 5.0) / elapsed_minutes;
+}
+
+double KeystrokeScorer::accuracy() const {
+    if (total_typed_ == 0) return 100.0;
+    return (total_correct_chars() * 100.0) / total_typed_;
+}
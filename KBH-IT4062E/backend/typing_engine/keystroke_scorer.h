@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Live scoring for one typist, updated in O(1) per keystroke.
+//
+// Only the word being typed is buffered. word_correct_ counts the buffered
+// positions that match the target, so a backspace undoes exactly its own
+// char and nothing is ever re-scanned. Totals match the per-word scoring:
+// correct = matching positions of each committed word, typed = every char
+// key pressed (backspaced ones included).
+class KeystrokeScorer {
+public:
+    // words (and the text they view) must outlive the scorer (owned by the
+    // Room / training session)
+    void reset(const std::vector<std::string_view>* words, int64_t start_time_ms);
+
+    // Discard the buffered word and start typing word_idx from scratch
+    void begin_word(int word_idx);
+
+    void set_time(int64_t time_ms) { latest_time_ms_ = time_ms; }
+    void on_char(char c);
+    void on_backspace();
+
+    // Fold the buffered word into the totals; typing continues after word_idx
+    void commit(int word_idx);
+
+    int word_idx() const { return committed_words_; }    // committed so far
+    int current_word() const { return current_word_; }
+    size_t typed_len() const { return typed_.size(); }
+    std::string_view target() const;                     // empty past the end
+    int64_t latest_time_ms() const { return latest_time_ms_; }
+
+    // Include the uncommitted word, so values move between commits
+    int total_correct_chars() const { return total_correct_ + word_correct_; }
+    int total_chars_typed() const { return total_typed_; }
+    double progress() const;
+    double wpm() const;
+    double accuracy() const;
+
+private:
+    const std::vector<std::string_view>* words_ = nullptr;
+    int64_t start_time_ms_ = 0;
+    int64_t latest_time_ms_ = 0;
+
+    int committed_words_ = 0;
+    int current_word_ = 0;
+    std::string typed_;
+    int word_correct_ = 0;
+
+    int total_correct_ = 0;
+    int total_typed_ = 0;
+};
+
+// Whitespace-split text into views of it (out is cleared first, keeping
+// its capacity)
+void split_words(std::string_view text, std::vector<std::string_view>& out);
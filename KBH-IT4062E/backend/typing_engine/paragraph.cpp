@@ -0,0 +1,50 @@
+#include "paragraph.h"
+#include <algorithm>
+#include <jsoncpp/json/json.h>
+#include "keystroke_scorer.h"
+
+std::shared_ptr<const Paragraph> Paragraph::make(std::string text) {
+    return std::shared_ptr<const Paragraph>(new Paragraph(std::move(text)));
+}
+
+Paragraph::Paragraph(std::string text)
+    : text_(std::move(text))
+{
+    split_words(text_, words_);
+    
+    // Same writer settings as Server::send_json, so the bytes match
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    json_fragment_ = "\"paragraph\":" + Json::writeString(builder, Json::Value(text_)) +
+                     ",\"total_words\":" + std::to_string(words_.size());
+}
+
+// -------------------------------------------
+// ParagraphCache
+// -------------------------------------------
+std::shared_ptr<const Paragraph> ParagraphCache::get(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto& entry = entries_[text];
+    auto paragraph = entry.lock();
+    if (!paragraph) {
+        paragraph = Paragraph::make(text);
+        entry = paragraph;
+        if (entries_.size() >= sweep_at_) {
+            sweep();
+        }
+    }
+    return paragraph;
+}
+
+void ParagraphCache::sweep() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.expired()) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Next sweep once the live set has doubled
+    sweep_at_ = std::max<size_t>(64, entries_.size() * 2);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Immutable paragraph shared by every room / training session typing it.
+// Words are views into text(); the game_init members are serialized once.
+class Paragraph {
+public:
+    static std::shared_ptr<const Paragraph> make(std::string text);
+
+    const std::string& text() const { return text_; }
+    const std::vector<std::string_view>& words() const { return words_; }
+    int total_words() const { return (int)words_.size(); }
+
+    // `"paragraph":"...","total_words":N` for splicing into game_init
+    const std::string& json_fragment() const { return json_fragment_; }
+
+    Paragraph(const Paragraph&) = delete;
+    Paragraph& operator=(const Paragraph&) = delete;
+
+private:
+    explicit Paragraph(std::string text);
+
+    std::string text_;
+    std::vector<std::string_view> words_;
+    std::string json_fragment_;
+};
+
+// Interns paragraphs by text so rooms drawing the same corpus entry share
+// one object. Entries are weak: a paragraph dies with its last room.
+class ParagraphCache {
+public:
+    std::shared_ptr<const Paragraph> get(const std::string& text);
+
+private:
+    void sweep();
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::weak_ptr<const Paragraph>> entries_;
+    size_t sweep_at_ = 64;
+};
@@ -0,0 +1,288 @@
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logging {
+
+std::atomic<int> g_level{(int)Level::Info};
+
+void set_level(Level level) {
+    g_level.store((int)level, std::memory_order_relaxed);
+}
+
+bool parse_level(const std::string& name, Level& level) {
+    static const char* kNames[] = {"debug", "info", "warn", "error", "off"};
+    for (int i = 0; i <= (int)Level::Off; i++) {
+        if (name == kNames[i]) {
+            level = (Level)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// One slot: header plus the formatted "message key=value ..." text
+struct Record {
+    static constexpr size_t kTextSize = 232;
+
+    int64_t time_us;
+    const char* component;
+    Level level;
+    uint16_t length;
+    char text[kTextSize];
+};
+
+namespace {
+
+// Written by its thread only (head), read by the drain thread only (tail)
+struct Ring {
+    static constexpr uint64_t kSlots = 128;
+
+    Record slots[kSlots];
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<bool> orphaned{false};   // its thread exited
+    std::atomic<uint64_t> dropped{0};
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        // Never destroyed: threads may log during static destruction
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    Ring* acquire_ring() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Ring* ring;
+        if (!free_.empty()) {
+            ring = free_.back();
+            free_.pop_back();
+            ring->orphaned = false;
+        } else {
+            owned_.push_back(std::make_unique<Ring>());
+            ring = owned_.back().get();
+        }
+        active_.push_back(ring);
+        return ring;
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t target = ++flush_requested_;
+        cv_.notify_all();
+        flushed_cv_.wait(lock, [&] { return flushed_ >= target || stopped_; });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_) return;
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+private:
+    Logger() {
+        thread_ = std::thread(&Logger::drain_loop, this);
+        std::atexit([] { Logger::instance().stop(); });
+    }
+
+    void drain_loop() {
+        std::vector<Record> batch;
+        std::vector<Ring*> rings;
+
+        while (true) {
+            uint64_t serving;
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait_for(lock, std::chrono::milliseconds(kDrainIntervalMs),
+                             [&] { return stop_ || flush_requested_ > flushed_; });
+                serving = flush_requested_;
+                stopping = stop_;
+                rings = active_;
+            }
+
+            batch.clear();
+            uint64_t dropped = 0;
+            for (Ring* ring : rings) {
+                bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+                uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                uint64_t head = ring->head.load(std::memory_order_acquire);
+                for (; tail < head; tail++) {
+                    batch.push_back(ring->slots[tail % Ring::kSlots]);
+                }
+                ring->tail.store(tail, std::memory_order_release);
+                dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+
+                if (orphaned) recycle(ring);
+            }
+
+            // Rings are drained one after another; interleave them again
+            std::stable_sort(batch.begin(), batch.end(),
+                             [](const Record& a, const Record& b) { return a.time_us < b.time_us; });
+            for (const Record& record : batch) {
+                write(record);
+            }
+            if (dropped > 0) {
+                fprintf(stderr, "WARN  log: %llu records dropped (ring full)\n",
+                        (unsigned long long)dropped);
+            }
+            fflush(stdout);
+            fflush(stderr);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flushed_ = serving;
+                if (stopping) stopped_ = true;
+            }
+            flushed_cv_.notify_all();
+            if (stopping) return;
+        }
+    }
+
+    // The ring's thread is gone and everything it wrote is drained
+    void recycle(Ring* ring) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.erase(std::find(active_.begin(), active_.end(), ring));
+        ring->head = 0;
+        ring->tail = 0;
+        free_.push_back(ring);
+    }
+
+    static void write(const Record& record) {
+        static const char* kLevels[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+
+        time_t seconds = (time_t)(record.time_us / 1000000);
+        tm utc;
+        gmtime_r(&seconds, &utc);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+        // Keep the two streams in order when they end up in the same file
+        static FILE* last = stdout;
+        FILE* out = record.level >= Level::Warn ? stderr : stdout;
+        if (out != last) {
+            fflush(last);
+            last = out;
+        }
+        fprintf(out, "%s.%03dZ %s %s: %.*s\n", stamp, (int)(record.time_us / 1000 % 1000),
+                kLevels[(int)record.level], record.component, (int)record.length, record.text);
+    }
+
+    static constexpr int kDrainIntervalMs = 10;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable flushed_cv_;
+    std::vector<std::unique_ptr<Ring>> owned_;
+    std::vector<Ring*> active_;
+    std::vector<Ring*> free_;
+    uint64_t flush_requested_ = 0;
+    uint64_t flushed_ = 0;
+    bool stop_ = false;
+    bool stopped_ = false;
+    std::thread thread_;
+};
+
+// Hands the ring back when the thread exits
+struct ThreadRing {
+    Ring* ring = nullptr;
+    ~ThreadRing() {
+        if (ring) ring->orphaned.store(true, std::memory_order_release);
+        ring = nullptr;
+    }
+};
+
+thread_local ThreadRing t_ring;
+
+Ring& this_thread_ring() {
+    if (!t_ring.ring) t_ring.ring = Logger::instance().acquire_ring();
+    return *t_ring.ring;
+}
+
+} // namespace
+
+void flush() {
+    Logger::instance().flush();
+}
+
+Line::Line(Level level, const char* component, std::string_view message) {
+    Ring& ring = this_thread_ring();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= Ring::kSlots) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        record_ = nullptr;
+        return;
+    }
+
+    record_ = &ring.slots[head % Ring::kSlots];
+    record_->time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record_->component = component;
+    record_->level = level;
+    record_->length = 0;
+    append(message);
+}
+
+Line::~Line() {
+    if (!record_) return;
+    Ring& ring = *t_ring.ring;
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Line::append(std::string_view text) {
+    size_t room = Record::kTextSize - record_->length;
+    size_t n = std::min(room, text.size());
+    memcpy(record_->text + record_->length, text.data(), n);
+    record_->length += n;
+}
+
+Line& Line::raw(const char* key, std::string_view value) {
+    if (!record_) return *this;
+    append(" ");
+    append(key);
+    append("=");
+    append(value);
+    return *this;
+}
+
+Line& Line::field(const char* key, std::string_view value) {
+    if (!record_) return *this;
+
+    // Quote values a reader could not split on spaces otherwise
+    bool plain = !value.empty() &&
+                 value.find_first_of(" =\"\\\n") == std::string_view::npos;
+    if (plain) return raw(key, value);
+
+    append(" ");
+    append(key);
+    append("=\"");
+    for (char c : value) {
+        if (c == '"' || c == '\\') append("\\");
+        append(c == '\n' ? std::string_view("\\n") : std::string_view(&c, 1));
+    }
+    append("\"");
+    return *this;
+}
+
+Line& Line::field(const char* key, double value) {
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 2);
+    return raw(key, std::string_view(buf, res.ptr - buf));
+}
+
+} // namespace logging
@@ -0,0 +1,92 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Asynchronous structured logger.
+//
+//   LOG_INFO("server", "Client connected").field("fd", fd).field("id", id);
+//
+// A call formats straight into a slot of the calling thread's ring buffer
+// (single producer, single consumer, no lock) and returns; one background
+// thread drains every ring, orders the records by time and writes them
+// out as `time LEVEL component: message key=value ...`, warnings and
+// errors to stderr. If a thread's ring is full the record is dropped and
+// counted rather than making the caller wait.
+//
+// The level is set at runtime (set_level); LOG_DEBUG calls are compiled
+// out entirely unless built with -DKBH_LOG_MIN_LEVEL=0.
+namespace logging {
+
+enum class Level : int { Debug = 0, Info, Warn, Error, Off };
+
+#ifndef KBH_LOG_MIN_LEVEL
+#define KBH_LOG_MIN_LEVEL 1
+#endif
+
+extern std::atomic<int> g_level;
+
+inline bool enabled(Level level) {
+    return (int)level >= g_level.load(std::memory_order_relaxed);
+}
+void set_level(Level level);
+// "debug" / "info" / "warn" / "error" / "off"; false if unknown
+bool parse_level(const std::string& name, Level& level);
+
+// Blocks until everything logged before the call has been written
+void flush();
+
+struct Record;
+
+// One log line under construction; committed by the destructor.
+// component must be a string literal (only the pointer is kept).
+class Line {
+public:
+    Line(Level level, const char* component, std::string_view message);
+    ~Line();
+
+    Line(const Line&) = delete;
+    Line& operator=(const Line&) = delete;
+
+    Line& field(const char* key, std::string_view value);
+    Line& field(const char* key, const char* value) { return field(key, std::string_view(value)); }
+    Line& field(const char* key, const std::string& value) { return field(key, std::string_view(value)); }
+    Line& field(const char* key, bool value) { return raw(key, value ? "true" : "false"); }
+    Line& field(const char* key, double value);
+    Line& field(const char* key, float value) { return field(key, (double)value); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    Line& field(const char* key, T value) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        return raw(key, std::string_view(buf, res.ptr - buf));
+    }
+
+private:
+    Line& raw(const char* key, std::string_view value);
+    void append(std::string_view text);
+
+    Record* record_;   // slot in this thread's ring, nullptr when full
+};
+
+} // namespace logging
+
+#define KBH_LOG_AT(level, component, message) \
+    if (!::logging::enabled(level)) {} else ::logging::Line(level, component, message)
+
+#if KBH_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(component, message) KBH_LOG_AT(::logging::Level::Debug, component, message)
+#else
+#define LOG_DEBUG(component, message) \
+    if (true) {} else ::logging::Line(::logging::Level::Debug, component, message)
+#endif
+#define LOG_INFO(component, message)  KBH_LOG_AT(::logging::Level::Info, component, message)
+#define LOG_WARN(component, message)  KBH_LOG_AT(::logging::Level::Warn, component, message)
+#define LOG_ERROR(component, message) KBH_LOG_AT(::logging::Level::Error, component, message)
+
+#endif
@@ -11,6 +11,7 @@ CREATE EXTENSION IF NOT EXISTS pgcrypto;
 -- =========================
 -- 1) USERS
 -- =========================
+DROP TABLE IF EXISTS keystroke_stat CASCADE;
 DROP TABLE IF EXISTS game_result CASCADE;
 DROP TABLE IF EXISTS paragraph CASCADE;
 DROP TABLE IF EXISTS app_user CASCADE;
@@ -58,6 +59,20 @@ CREATE TABLE game_result (
 CREATE INDEX ix_game_result_user_time ON game_result (user_id, created_at DESC);
 CREATE INDEX ix_game_result_wpm ON game_result (wpm DESC, accuracy DESC, created_at ASC);
 
+-- =========================
+-- 3b) KEYSTROKE STATS (per-key / per-bigram typing diagnostics)
+-- =========================
+-- key_seq is a single letter ('a') for per-key rows or two letters ('th') for bigram rows.
+-- mean_latency_ms is a running mean over `samples`; the backend merges new batches in place.
+CREATE TABLE keystroke_stat (
+  user_id         BIGINT NOT NULL REFERENCES app_user(user_id) ON DELETE CASCADE,
+  key_seq         TEXT NOT NULL CHECK (length(key_seq) BETWEEN 1 AND 2),
+  samples         INT NOT NULL DEFAULT 0 CHECK (samples >= 0),
+  mean_latency_ms DOUBLE PRECISION NOT NULL DEFAULT 0,
+  errors          INT NOT NULL DEFAULT 0 CHECK (errors >= 0),
+  PRIMARY KEY (user_id, key_seq)
+);
+
 -- =========================
 -- 4) LEADERBOARD VIEW (best run per user)
 -- =========================
@@ -183,6 +198,11 @@ COMMIT;
 --   INSERT INTO game_result(user_id, paragraph_id, wpm, accuracy, duration_ms, words_committed)
 --   VALUES ($1, $2, $3, $4, $5, $6);
 --
+-- Merge a batch of keystroke stats (backend flushes these periodically):
+--   INSERT INTO keystroke_stat(user_id, key_seq, samples, mean_latency_ms, errors)
+--   VALUES (...), (...)
+--   ON CONFLICT (user_id, key_seq) DO UPDATE SET ...;
+--
 -- Top 15 leaderboard:
 --   SELECT *, dense_rank() OVER (ORDER BY wpm DESC, accuracy DESC, created_at ASC) AS rank
 --   FROM v_user_best
@@ -1,7 +1,6 @@
 #include "App.h"
 #include <SDL_image.h>
 #include <SDL_ttf.h>
-#include <iostream>
 
 #include "../ui/UiTheme.h"
 #include "../config/ClientConfig.h"
@@ -11,26 +10,27 @@
 #include "../overlays/ChangePasswordOverlay.h"
 #include "../overlays/GuestResultOverlay.h"
 #include "../core/Router.h"
+#include "log.h"
 
 bool App::init() {
-    std::cout << "[App] Initializing SDL...\n";
+    LOG_DEBUG("App", "Initializing SDL");
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "[App] SDL_Init failed: " << SDL_GetError() << "\n";
+        LOG_ERROR("App", "SDL_Init failed").field("error", SDL_GetError());
         return false;
     }
 
     // PNG support is enough for now
     if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0) {
-        std::cerr << "[App] IMG_Init failed: " << IMG_GetError() << "\n";
+        LOG_ERROR("App", "IMG_Init failed").field("error", IMG_GetError());
         return false;
     }
 
     if (TTF_Init() != 0) {
-        std::cerr << "[App] TTF_Init failed: " << TTF_GetError() << "\n";
+        LOG_ERROR("App", "TTF_Init failed").field("error", TTF_GetError());
         return false;
     }
 
-    std::cout << "[App] Creating window...\n";
+    LOG_DEBUG("App", "Creating window");
     win = SDL_CreateWindow(
         "Keyboard Hero",
         SDL_WINDOWPOS_CENTERED,
@@ -40,14 +40,14 @@ bool App::init() {
         SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
     );
     if (!win) {
-        std::cerr << "[App] SDL_CreateWindow failed: " << SDL_GetError() << "\n";
+        LOG_ERROR("App", "SDL_CreateWindow failed").field("error", SDL_GetError());
         return false;
     }
 
-    std::cout << "[App] Creating renderer...\n";
+    LOG_DEBUG("App", "Creating renderer");
     ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!ren) {
-        std::cerr << "[App] SDL_CreateRenderer failed: " << SDL_GetError() << "\n";
+        LOG_ERROR("App", "SDL_CreateRenderer failed").field("error", SDL_GetError());
         return false;
     }
 
@@ -56,25 +56,32 @@ bool App::init() {
     SDL_RenderSetLogicalSize(ren, UiTheme::DesignW, UiTheme::DesignH);
     SDL_RenderSetIntegerScale(ren, SDL_FALSE); // Allow non-integer scaling for smooth resize
     
-    std::cout << "[App] Initializing resources...\n";
+    LOG_DEBUG("App", "Initializing resources");
     res.init(ren);
     
     // Connect to server using config
-    std::cout << "[App] Loading config...\n";
-    ClientConfig cfg = ClientConfig::load();
-    std::cout << "[App] Connecting to server...\n";
+    LOG_DEBUG("App", "Loading config");
+    cfg = ClientConfig::load();
+    logging::Level level;
+    if (logging::parse_level(cfg.log_level, level)) {
+        logging::set_level(level);
+    } else {
+        LOG_WARN("App", "Unknown log_level, using info").field("log_level", cfg.log_level);
+    }
+    LOG_DEBUG("App", "Connecting to server");
     if (!net.connect(cfg.server_ip, cfg.server_port)) {
-        std::cerr << "[App] Warning: Failed to connect to server at " 
-                  << cfg.server_ip << ":" << cfg.server_port 
-                  << ". Game will run in offline mode.\n";
+        LOG_WARN("App", "Failed to connect to server, running offline")
+            .field("server_ip", cfg.server_ip)
+            .field("server_port", cfg.server_port);
         // Continue anyway - some features may require connection
     } else {
-        std::cout << "[App] Connected to server at " 
-                  << cfg.server_ip << ":" << cfg.server_port << "\n";
+        LOG_INFO("App", "Connected to server")
+            .field("server_ip", cfg.server_ip)
+            .field("server_port", cfg.server_port);
     }
     
-    std::cout << "[App] Initialization complete!\n";
-    std::cout << "[App] Returning from init()\n";
+    LOG_INFO("App", "Initialization complete");
+    LOG_DEBUG("App", "Returning from init()");
     return true;
 }
 
@@ -95,12 +102,14 @@ void App::processDeferred() {
 }
 
 void App::run() {
-    std::cout << "[App] Starting main loop...\n";
+    LOG_INFO("App", "Starting main loop");
     rt.change(RouteId::Title);
-    std::cout << "[App] Changed route to Title\n";
+    LOG_INFO("App", "Changed route to Title");
 
     Uint64 last = SDL_GetPerformanceCounter();
     const double freq = (double)SDL_GetPerformanceFrequency();
+    Uint64 lastReconnect = 0;
+    Uint64 lastKeepalive = 0;
 
     while (!quitRequested) {
         Uint64 now = SDL_GetPerformanceCounter();
@@ -144,6 +153,21 @@ void App::run() {
             break;
         }
         
+        // Lost the server with a session to go back to: retry once a second,
+        // checking every frame on an attempt in progress (never blocks)
+        if (!net.is_connected() && net.can_resume() &&
+            (net.reconnecting() || (now - lastReconnect) / freq >= 1.0)) {
+            lastReconnect = now;
+            net.reconnect();
+        }
+        
+        // The server drops connections silent for idle_timeout_ms; keep
+        // lobby and spectator screens (which send nothing) alive
+        if (net.is_connected() && (now - lastKeepalive) / freq >= 10.0) {
+            lastKeepalive = now;
+            net.send_time_sync((int64_t)SDL_GetTicks64());
+        }
+        
         // Poll network events (limit to 10 per frame to avoid blocking SDL events)
         int maxNetEvents = 10;
         while (net.has_events() && maxNetEvents-- > 0) {
@@ -157,14 +181,15 @@ void App::run() {
                 switch (event->type) {
                     case NetEventType::Hello:
                         // Connection established
-                        std::cout << "[App] Received Hello from server\n";
+                        LOG_INFO("App", "Received Hello from server");
                         break;
                     
                     case NetEventType::SignInResponse: {
                         auto* resp = static_cast<SignInResponseEvent*>(event.get());
                         if (resp->success) {
-                            std::cout << "[App] Sign in successful: user_id=" << resp->user_id 
-                                     << ", username=" << resp->username << "\n";
+                            LOG_INFO("App", "Sign in successful")
+                                .field("user_id", resp->user_id)
+                                .field("username", resp->username);
                             st.setUser(resp->user_id, resp->username);
                             
                             // Check if we're signing in from GuestResultOverlay (training result pending)
@@ -179,7 +204,7 @@ void App::run() {
                                     View* underView = viewStack.top();
                                     if (dynamic_cast<GuestResultOverlay*>(underView)) {
                                         // Replace GuestResultOverlay with UserResultOverlay
-                                        std::cout << "[App] Replacing GuestResultOverlay with UserResultOverlay\n";
+                                        LOG_INFO("App", "Replacing GuestResultOverlay with UserResultOverlay");
                                         
                                         // Update display_name in GameEnd rankings to show correct username
                                         if (st.hasGameEnd()) {
@@ -187,14 +212,15 @@ void App::run() {
                                             if (!ge.rankings.empty()) {
                                                 ge.rankings[0].display_name = username;
                                                 st.setGameEnd(ge);
-                                                std::cout << "[App] Updated display_name to: " << username << "\n";
+                                                LOG_INFO("App", "Updated display_name")
+                                                    .field("username", username);
                                                 
                                                 // Save training result to backend
                                                 const auto& ranking = ge.rankings[0];
                                                 // Get paragraph from GameInit
                                                 if (st.hasGameInit()) {
                                                     const auto& gi = st.getGameInit();
-                                                    std::cout << "[App] Sending save_training_result to backend\n";
+                                                    LOG_INFO("App", "Sending save_training_result to backend");
                                                     net.send_save_training_result(
                                                         gi.paragraph,
                                                         ranking.wpm,
@@ -216,7 +242,7 @@ void App::run() {
                                 });
                             }
                         } else {
-                            std::cerr << "[App] Sign in failed: " << resp->error_message << "\n";
+                            LOG_WARN("App", "Sign in failed").field("error", resp->error_message);
                             // Show error in SignInOverlay
                             View* topView = viewStack.top();
                             if (topView) {
@@ -232,8 +258,7 @@ void App::run() {
                     case NetEventType::CreateAccountResponse: {
                         auto* resp = static_cast<CreateAccountResponseEvent*>(event.get());
                         if (resp->success) {
-                            std::cout << "[App] Account created: " << resp->username 
-                                     << " - Please sign in\n";
+                            LOG_INFO("App", "Account created, please sign in").field("username", resp->username);
                             // Don't auto-login, user must sign in
                             
                             // Pop the CreateAccountOverlay
@@ -241,7 +266,7 @@ void App::run() {
                                 rt.pop();
                             });
                         } else {
-                            std::cerr << "[App] Create account failed: " << resp->error_message << "\n";
+                            LOG_WARN("App", "Create account failed").field("error", resp->error_message);
                             // Show error in CreateAccountOverlay
                             View* topView = viewStack.top();
                             if (topView) {
@@ -257,14 +282,14 @@ void App::run() {
                     case NetEventType::ChangePasswordResponse: {
                         auto* resp = static_cast<ChangePasswordResponseEvent*>(event.get());
                         if (resp->success) {
-                            std::cout << "[App] Password changed successfully\n";
+                            LOG_INFO("App", "Password changed successfully");
                             
                             // Pop the ChangePasswordOverlay
                             defer([this]() {
                                 rt.pop();
                             });
                         } else {
-                            std::cerr << "[App] Change password failed: " << resp->error_message << "\n";
+                            LOG_WARN("App", "Change password failed").field("error", resp->error_message);
                             
                             // Show error in ChangePasswordOverlay
                             View* topView = viewStack.top();
@@ -283,7 +308,7 @@ void App::run() {
                         // If we're in JoinRoomOverlay, navigate to LobbyScreen
                         View* topView = viewStack.top();
                         if (topView && dynamic_cast<JoinRoomOverlay*>(topView)) {
-                            std::cout << "[App] Join successful, navigating to Lobby\n";
+                            LOG_INFO("App", "Join successful, navigating to Lobby");
                             defer([this]() {
                                 rt.change(RouteId::Lobby);
                             });
@@ -295,12 +320,13 @@ void App::run() {
                         // Game starting - navigate to GameScreen
                         auto* gi = static_cast<GameInitEvent*>(event.get());
                         st.setGameInit(*gi);
-                        std::cout << "[App] Game init received, paragraph: " << gi->paragraph.substr(0, 50) << "...\n";
+                        LOG_INFO("App", "Game init received")
+                            .field("paragraph", gi->paragraph.substr(0, 50));
                         
                         // Check if training mode or arena mode
                         if (gi->room_id == "training") {
                             // Training: Navigate directly to GameScreen from TitleScreen
-                            std::cout << "[App] Training mode - navigating to Game\n";
+                            LOG_INFO("App", "Training mode - navigating to Game");
                             defer([this]() {
                                 rt.change(RouteId::Game);
                             });
@@ -320,7 +346,7 @@ void App::run() {
                         
                         // If game ended, navigate to result screen
                         if (gs->ended) {
-                            std::cout << "[App] Game ended\n";
+                            LOG_INFO("App", "Game ended");
                             // TODO: Navigate to result screen
                         }
                         break;
@@ -329,15 +355,18 @@ void App::run() {
                     case NetEventType::GameEnd: {
                         // Game finished with rankings
                         auto* ge = static_cast<GameEndEvent*>(event.get());
-                        std::cout << "[App] Game ended: " << ge->reason << "\n";
+                        LOG_INFO("App", "Game ended").field("reason", ge->reason);
                         
                         // Debug: print rankings data
-                        std::cout << "[App] Rankings count: " << ge->rankings.size() << "\n";
+                        LOG_DEBUG("App", "Rankings").field("count", ge->rankings.size());
                         for (size_t i = 0; i < ge->rankings.size(); i++) {
                             const auto& r = ge->rankings[i];
-                            std::cout << "[App] Ranking[" << i << "]: " << r.display_name 
-                                      << " WPM=" << r.wpm << " ACC=" << (r.accuracy * 100) << "%"
-                                      << " word_idx=" << r.word_idx << "\n";
+                            LOG_DEBUG("App", "Ranking")
+                                .field("index", i)
+                                .field("display_name", r.display_name)
+                                .field("wpm", r.wpm)
+                                .field("acc", (r.accuracy * 100))
+                                .field("word_idx", r.word_idx);
                         }
                         
                         // Store game end event in state
@@ -346,18 +375,18 @@ void App::run() {
                         // Check if this is training mode
                         if (ge->room_id == "training") {
                             // Training mode: check if user is logged in
-                            std::cout << "[App] Training mode ended, showing result\n";
+                            LOG_INFO("App", "Training mode ended, showing result");
                             
                             if (st.isUserAuthenticated()) {
                                 // Logged in: show UserResultOverlay
-                                std::cout << "[App] User logged in, showing UserResultOverlay\n";
+                                LOG_INFO("App", "User logged in, showing UserResultOverlay");
                                 // TODO: Send save_training_result to backend
                                 defer([this]() {
                                     rt.push(RouteId::UserResultOverlay);
                                 });
                             } else {
                                 // Not logged in: show GuestResultOverlay
-                                std::cout << "[App] Guest user, showing GuestResultOverlay\n";
+                                LOG_INFO("App", "Guest user, showing GuestResultOverlay");
                                 defer([this]() {
                                     rt.push(RouteId::GuestResultOverlay);
                                 });
@@ -373,7 +402,7 @@ void App::run() {
                     
                     case NetEventType::LeaderboardResponse: {
                         auto* lb = static_cast<LeaderboardResponseEvent*>(event.get());
-                        std::cout << "[App] Received leaderboard with " << lb->top8.size() << " entries\n";
+                        LOG_INFO("App", "Received leaderboard").field("entries", lb->top8.size());
                         
                         // Store in session state
                         st.setLeaderboard(*lb);
@@ -385,9 +414,30 @@ void App::run() {
                         break;
                     }
                     
+                    case NetEventType::Resumed: {
+                        // Seat, game and name are as before the drop; the next
+                        // room_state / game_state refreshes the screens
+                        auto* rs = static_cast<ResumedEvent*>(event.get());
+                        LOG_INFO("App", "Session resumed")
+                            .field("room", rs->room_id)
+                            .field("in_game", rs->in_game)
+                            .field("word_idx", rs->word_idx);
+                        break;
+                    }
+                    
                     case NetEventType::Error: {
                         auto* err = static_cast<ErrorEvent*>(event.get());
-                        std::cerr << "[App] Server error: " << err->code << " - " << err->message << "\n";
+                        LOG_ERROR("App", "Server error")
+                            .field("code", err->code)
+                            .field("message", err->message);
+                        
+                        // The room / game we were in is gone for us
+                        if (err->code == "SESSION_EXPIRED") {
+                            defer([this]() {
+                                rt.change(RouteId::Title);
+                            });
+                            break;
+                        }
                         
                         // If we're in JoinRoomOverlay, show error
                         View* topView = viewStack.top();
@@ -419,22 +469,22 @@ void App::run() {
 }
 
 void App::shutdown() {
-    std::cout << "[App] shutdown() - Disconnecting from server...\n";
+    LOG_DEBUG("App", "Shutdown: disconnecting from server");
     // Disconnect from server
     net.disconnect();
     
-    std::cout << "[App] shutdown() - Cleaning up resources...\n";
+    LOG_DEBUG("App", "Shutdown: cleaning up resources");
     // Clean up resources safely
     res.shutdown();
 
-    std::cout << "[App] shutdown() - Destroying renderer and window...\n";
+    LOG_DEBUG("App", "Shutdown: destroying renderer and window");
     if (ren) SDL_DestroyRenderer(ren);
     if (win) SDL_DestroyWindow(win);
 
-    std::cout << "[App] shutdown() - Quitting SDL subsystems...\n";
+    LOG_DEBUG("App", "Shutdown: quitting SDL subsystems");
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
     
-    std::cout << "[App] shutdown() - Complete\n";
+    LOG_INFO("App", "Shutdown complete");
 }
@@ -9,6 +9,7 @@
 #include "../state/Session.h"
 #include "../state/AppState.h"
 #include "../net/NetClient.h"
+#include "../config/ClientConfig.h"
 
 class App {
 public:
@@ -26,6 +27,7 @@ public:
     ViewStack& views() { return viewStack; }
     Router& router() { return rt; }
     NetClient& network() { return net; }
+    const ClientConfig& config() const { return cfg; }
 
     // Defer navigation/actions to run AFTER event processing (prevents use-after-free)
     void defer(std::function<void()> fn);
@@ -41,6 +43,7 @@ private:
     Session sess;
     AppState st;
     NetClient net;
+    ClientConfig cfg;
 
     ViewStack viewStack{this};
     Router rt{this};
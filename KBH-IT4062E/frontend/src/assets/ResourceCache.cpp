@@ -1,38 +1,39 @@
 #include "ResourceCache.h"
+#include "log.h"
 #include <SDL_image.h>
-#include <iostream>
 
 SDL_Texture* ResourceCache::texture(const std::string& path) {
-    std::cout << "[ResourceCache] Requesting texture: " << path << "\n";
+    LOG_DEBUG("ResourceCache", "Requesting texture").field("path", path);
     
     if (!ren) {
-        std::cerr << "[ResourceCache] Error: renderer is nullptr!\n";
+        LOG_ERROR("ResourceCache", "Renderer is null").field("path", path);
         return nullptr;
     }
     
     auto it = textures.find(path);
     if (it != textures.end()) {
-        std::cout << "[ResourceCache] Texture found in cache\n";
+        LOG_DEBUG("ResourceCache", "Texture found in cache");
         return it->second;
     }
 
-    std::cout << "[ResourceCache] Loading image from disk...\n";
+    LOG_DEBUG("ResourceCache", "Loading image from disk");
     SDL_Surface* s = IMG_Load(path.c_str());
     if (!s) {
-        std::cerr << "[ResourceCache] IMG_Load failed: " << IMG_GetError() << "\n";
+        LOG_ERROR("ResourceCache", "IMG_Load failed").field("path", path).field("error", IMG_GetError());
         return nullptr;
     }
 
-    std::cout << "[ResourceCache] Creating texture from surface...\n";
+    LOG_DEBUG("ResourceCache", "Creating texture from surface");
     SDL_Texture* t = SDL_CreateTextureFromSurface(ren, s);
     SDL_FreeSurface(s);
 
     if (!t) {
-        std::cerr << "[ResourceCache] SDL_CreateTextureFromSurface failed: " << SDL_GetError() << "\n";
+        LOG_ERROR("ResourceCache", "SDL_CreateTextureFromSurface failed").field("path", path)
+            .field("error", SDL_GetError());
         return nullptr;
     }
     
-    std::cout << "[ResourceCache] Texture created successfully\n";
+    LOG_DEBUG("ResourceCache", "Texture created successfully");
     textures[path] = t;
     return t;
 }
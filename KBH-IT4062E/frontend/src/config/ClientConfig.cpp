@@ -1,15 +1,15 @@
 #include "ClientConfig.h"
+#include "log.h"
 #include <jsoncpp/json/json.h>
 #include <fstream>
-#include <iostream>
 
 ClientConfig ClientConfig::load(const std::string& config_path) {
     ClientConfig cfg;
     
     std::ifstream file(config_path);
     if (!file.is_open()) {
-        std::cerr << "[ClientConfig] Warning: Could not open " << config_path 
-                  << ", using defaults (127.0.0.1:5000)\n";
+        LOG_WARN("ClientConfig", "Could not open config, using defaults (127.0.0.1:5000)")
+            .field("path", config_path);
         return cfg;
     }
     
@@ -18,7 +18,7 @@ ClientConfig ClientConfig::load(const std::string& config_path) {
     std::string errs;
     
     if (!Json::parseFromStream(builder, file, &root, &errs)) {
-        std::cerr << "[ClientConfig] JSON parse error: " << errs << "\n";
+        LOG_ERROR("ClientConfig", "JSON parse error").field("error", errs);
         return cfg;
     }
     
@@ -30,7 +30,21 @@ ClientConfig ClientConfig::load(const std::string& config_path) {
         cfg.server_port = root["server_port"].asInt();
     }
     
-    std::cout << "[ClientConfig] Loaded config: " << cfg.server_ip << ":" << cfg.server_port << "\n";
+    if (root.isMember("streaming_input") && root["streaming_input"].isBool()) {
+        cfg.streaming_input = root["streaming_input"].asBool();
+    }
+    
+    if (root.isMember("input_flush_ms") && root["input_flush_ms"].isInt()) {
+        cfg.input_flush_ms = root["input_flush_ms"].asInt();
+    }
+    
+    if (root.isMember("log_level") && root["log_level"].isString()) {
+        cfg.log_level = root["log_level"].asString();
+    }
+    
+    LOG_INFO("ClientConfig", "Loaded config")
+        .field("server_ip", cfg.server_ip)
+        .field("server_port", cfg.server_port);
     
     return cfg;
 }
@@ -5,6 +5,14 @@ struct ClientConfig {
     std::string server_ip = "127.0.0.1";
     int server_port = 5000;
     
+    // Stream keystrokes in small batches (input_batch) instead of one
+    // input message per committed word; batches go out every input_flush_ms
+    bool streaming_input = false;
+    int input_flush_ms = 100;
+    
+    // "debug" / "info" / "warn" / "error" / "off"
+    std::string log_level = "info";
+    
     // Load from config file
     static ClientConfig load(const std::string& config_path = "client_config.json");
 };
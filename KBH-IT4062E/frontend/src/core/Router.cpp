@@ -1,6 +1,5 @@
 #include "Router.h"
 #include "../app/App.h"
-#include <iostream>
 
 #include "../screens/TitleScreen.h"
 #include "../screens/LobbyScreen.h"
@@ -16,14 +15,15 @@
 #include "../overlays/GuestResultOverlay.h"
 #include "../overlays/UserResultOverlay.h"
 #include "../overlays/MatchResultOverlay.h"
+#include "log.h"
 
 void Router::change(RouteId id) {
-    std::cout << "[Router] Changing to route " << (int)id << "\n";
+    LOG_DEBUG("Router", "Changing route").field("route", (int)id);
     app->views().clearAndPush(make(id));
 }
 
 void Router::push(RouteId id) {
-    std::cout << "[Router] Pushing route " << (int)id << "\n";
+    LOG_DEBUG("Router", "Pushing route").field("route", (int)id);
     app->views().push(make(id));
 }
 
@@ -45,7 +45,7 @@ std::unique_ptr<View> Router::make(RouteId id) {
         case RouteId::EnterRoomOverlay:    return std::make_unique<EnterRoomOverlay>();
         case RouteId::JoinRoomOverlay:     return std::make_unique<JoinRoomOverlay>();
         case RouteId::LeaderboardOverlay:  
-            std::cout << "[Router] Creating LeaderboardOverlay\n";
+            LOG_DEBUG("Router", "Creating LeaderboardOverlay");
             return std::make_unique<LeaderboardOverlay>();
         case RouteId::SignInOverlay:       return std::make_unique<SignInOverlay>();
         case RouteId::CreateAccountOverlay:return std::make_unique<CreateAccountOverlay>();
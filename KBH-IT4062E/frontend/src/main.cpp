@@ -1,24 +1,25 @@
 #include "app/App.h"
-#include <iostream>
+#include "log.h"
 
 int main() {
-    std::cout << "=== Keyboard Hero Client Starting ===\n";
+    LOG_INFO("Main", "Keyboard Hero Client starting");
     
     App app;
-    std::cout << "[Main] Calling app.init()...\n";
+    LOG_DEBUG("Main", "Calling app.init()");
     if (!app.init()) {
-        std::cerr << "[Main] app.init() failed!\n";
+        LOG_ERROR("Main", "app.init() failed");
         return 1;
     }
-    std::cout << "[Main] app.init() returned successfully\n";
+    LOG_DEBUG("Main", "app.init() returned successfully");
     
-    std::cout << "[Main] Starting main loop...\n";
+    LOG_INFO("Main", "Starting main loop");
     app.run();
-    std::cout << "[Main] Main loop exited\n";
+    LOG_INFO("Main", "Main loop exited");
     
-    std::cout << "[Main] Shutting down...\n";
+    LOG_INFO("Main", "Shutting down");
     app.shutdown();
     
-    std::cout << "[Main] Exit.\n";
+    LOG_INFO("Main", "Exit");
+    logging::flush();
     return 0;
 }
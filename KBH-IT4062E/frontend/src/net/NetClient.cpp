@@ -1,10 +1,12 @@
 #include "NetClient.h"
+#include "log.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <cstring>
 #include <cerrno>
-#include <iostream>
 
 NetClient::NetClient() {}
 
@@ -17,14 +19,14 @@ bool NetClient::connect(const std::string& ip, int port) {
     
     // Make sure no thread is running from a previous connection attempt
     if (recv_thread_.joinable()) {
-        std::cerr << "[NetClient] Warning: receiver thread still running, joining first\n";
+        LOG_WARN("NetClient", "Receiver thread still running, joining first");
         should_stop_ = true;
         recv_thread_.join();
     }
     
     sockfd_ = socket(AF_INET, SOCK_STREAM, 0);
     if (sockfd_ < 0) {
-        std::cerr << "[NetClient] Failed to create socket: " << strerror(errno) << "\n";
+        LOG_ERROR("NetClient", "Failed to create socket").field("error", strerror(errno));
         return false;
     }
     
@@ -33,34 +35,45 @@ bool NetClient::connect(const std::string& ip, int port) {
     addr.sin_port = htons(port);
     
     if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) <= 0) {
-        std::cerr << "[NetClient] Invalid address: " << ip << "\n";
+        LOG_WARN("NetClient", "Invalid address").field("ip", ip);
         close(sockfd_);
         sockfd_ = -1;
         return false;
     }
     
-    std::cout << "[NetClient] Attempting to connect to " << ip << ":" << port << "...\n";
+    LOG_DEBUG("NetClient", "Connecting").field("ip", ip).field("port", port);
     
     if (::connect(sockfd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
-        std::cerr << "[NetClient] Failed to connect to " << ip << ":" << port 
-                  << " - " << strerror(errno) << "\n";
+        LOG_ERROR("NetClient", "Connect failed")
+            .field("ip", ip)
+            .field("port", port)
+            .field("error", strerror(errno));
         close(sockfd_);
         sockfd_ = -1;
         return false;
     }
     
+    return start_receiving(ip, port);
+}
+
+bool NetClient::start_receiving(const std::string& ip, int port) {
     connected_ = true;
     should_stop_ = false;
     recv_buffer_.clear();
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        ip_ = ip;
+        port_ = port;
+    }
     
-    std::cout << "[NetClient] Connected to " << ip << ":" << port << "\n";
+    LOG_INFO("NetClient", "Connected").field("ip", ip).field("port", port);
     
     // Start receive thread
     try {
         recv_thread_ = std::thread(&NetClient::receive_thread, this);
-        std::cout << "[NetClient] Receiver thread created successfully\n";
+        LOG_DEBUG("NetClient", "Receiver thread created successfully");
     } catch (const std::exception& e) {
-        std::cerr << "[NetClient] Failed to create receiver thread: " << e.what() << "\n";
+        LOG_ERROR("NetClient", "Failed to create receiver thread").field("error", e.what());
         connected_ = false;
         close(sockfd_);
         sockfd_ = -1;
@@ -71,12 +84,21 @@ bool NetClient::connect(const std::string& ip, int port) {
 }
 
 void NetClient::disconnect() {
-    if (!connected_) return;
+    if (!connected_) {
+        abandon_reconnect();
+        return;
+    }
     
-    std::cout << "[NetClient] Disconnecting...\n";
+    LOG_DEBUG("NetClient", "Disconnecting");
     
     should_stop_ = true;
     connected_ = false;
+    {
+        // Leaving on purpose: nothing to resume
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        session_token_.clear();
+    }
+    abandon_reconnect();
     
     // Close socket first to unblock recv()
     if (sockfd_ >= 0) {
@@ -90,20 +112,153 @@ void NetClient::disconnect() {
         recv_thread_.join();
     }
     
-    std::cout << "[NetClient] Disconnected\n";
+    LOG_INFO("NetClient", "Disconnected");
+}
+
+bool NetClient::can_resume() const {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    return !session_token_.empty() && port_ > 0;
+}
+
+void NetClient::abandon_reconnect() {
+    if (reconnect_fd_ < 0) return;
+    close(reconnect_fd_);
+    reconnect_fd_ = -1;
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    resuming_ = false;
+}
+
+bool NetClient::reconnect() {
+    if (connected_) return true;
+    
+    // Never waits on the network: the first call starts a non-blocking
+    // connect, later calls check on it without blocking
+    if (reconnect_fd_ < 0) {
+        std::string ip;
+        int port;
+        {
+            // Set before the new hello can arrive, so it keeps the old token
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            if (session_token_.empty()) return false;
+            ip = ip_;
+            port = port_;
+            resuming_ = true;
+        }
+        
+        // The receiver already stopped on the dead socket; release it
+        if (recv_thread_.joinable()) {
+            recv_thread_.join();
+        }
+        if (sockfd_ >= 0) {
+            close(sockfd_);
+            sockfd_ = -1;
+        }
+        
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        reconnect_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (reconnect_fd_ < 0 || inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) <= 0) {
+            abandon_reconnect();
+            return false;
+        }
+        fcntl(reconnect_fd_, F_SETFL, fcntl(reconnect_fd_, F_GETFL) | O_NONBLOCK);
+        
+        LOG_DEBUG("NetClient", "Reconnecting").field("ip", ip).field("port", port);
+        if (::connect(reconnect_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+            LOG_WARN("NetClient", "Reconnect failed").field("error", strerror(errno));
+            abandon_reconnect();
+            return false;
+        }
+        reconnect_started_ = std::chrono::steady_clock::now();
+    }
+    
+    pollfd pfd{reconnect_fd_, POLLOUT, 0};
+    if (poll(&pfd, 1, 0) == 0) {
+        // Still in the handshake; an unreachable server is given up on
+        // here instead of after the kernel's SYN retries
+        if (std::chrono::steady_clock::now() - reconnect_started_ >
+            std::chrono::milliseconds(kReconnectTimeoutMs)) {
+            LOG_WARN("NetClient", "Reconnect timed out");
+            abandon_reconnect();
+        }
+        return false;
+    }
+    
+    int error = 0;
+    socklen_t len = sizeof(error);
+    getsockopt(reconnect_fd_, SOL_SOCKET, SO_ERROR, &error, &len);
+    if (error != 0) {
+        LOG_WARN("NetClient", "Reconnect failed").field("error", strerror(error));
+        abandon_reconnect();
+        return false;
+    }
+    
+    // The receiver thread reads with blocking recv()
+    fcntl(reconnect_fd_, F_SETFL, fcntl(reconnect_fd_, F_GETFL) & ~O_NONBLOCK);
+    sockfd_ = reconnect_fd_;
+    reconnect_fd_ = -1;
+    std::string ip;
+    int port;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        ip = ip_;
+        port = port_;
+    }
+    if (!start_receiving(ip, port)) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        resuming_ = false;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    Json::Value msg;
+    msg["type"] = "resume";
+    msg["session_token"] = session_token_;
+    msg["has_paragraph"] = true;  // still on screen
+    send_json_internal(msg);
+    
+    LOG_INFO("NetClient", "Reconnected, resuming session");
+    return true;
+}
+
+void NetClient::resend_inputs(const Json::Value& self) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    
+    // Streamed events: the server counts how many it applied
+    int applied = self.get("events_applied", 0).asInt();
+    if (applied < (int)sent_events_.size()) {
+        Json::Value rest(Json::arrayValue);
+        for (Json::ArrayIndex i = applied; i < sent_events_.size(); i++) {
+            rest.append(sent_events_[i]);
+        }
+        Json::Value msg;
+        msg["type"] = "input_batch";
+        msg["room_id"] = input_room_id_;
+        msg["events"] = rest;
+        send_json_internal(msg);
+    }
+    
+    // Whole words: everything from the first word it has not committed
+    int word_idx = self.get("word_idx", 0).asInt();
+    for (const auto& msg : sent_inputs_) {
+        if (msg["word_idx"].asInt() >= word_idx) {
+            send_json_internal(msg);
+        }
+    }
 }
 
 void NetClient::receive_thread() {
     char buffer[4096];
     
-    // std::cout << "[NetClient] Receiver thread started\n";
+    LOG_DEBUG("NetClient", "Receiver thread started");
     
     try {
         while (!should_stop_ && connected_) {
             int n = recv(sockfd_, buffer, sizeof(buffer) - 1, 0);
             
             if (n <= 0) {
-                std::cerr << "[NetClient] Connection closed by server (recv=" << n << ")\n";
+                LOG_WARN("NetClient", "Connection closed by server").field("recv", n);
                 connected_ = false;
                 break;
             }
@@ -124,7 +279,7 @@ void NetClient::receive_thread() {
                 
                 if (line.empty()) continue;
                 
-                // std::cout << "[NetClient] Received: " << line << "\n";
+                LOG_DEBUG("NetClient", "Received").field("line", line);
                 
                 // Parse JSON
                 Json::Value msg;
@@ -133,48 +288,74 @@ void NetClient::receive_thread() {
                 std::string errs;
                 
                 if (!Json::parseFromStream(builder, ss, &msg, &errs)) {
-                    std::cerr << "[NetClient] JSON parse error: " << errs << "\n";
+                    LOG_ERROR("NetClient", "JSON parse error").field("error", errs);
                     continue;
                 }
                 
                 // Parse event and push to queue
                 auto event = parse_event(msg);
                 if (event) {
-                    // std::cout << "[NetClient] Parsed event type: " << (int)event->type << "\n";
+                    LOG_DEBUG("NetClient", "Parsed event type").field("type", (int)event->type);
                     std::lock_guard<std::mutex> lock(queue_mutex_);
                     event_queue_.push(std::move(event));
                 } else {
-                    std::cerr << "[NetClient] Failed to parse event from JSON\n";
+                    LOG_ERROR("NetClient", "Failed to parse event from JSON");
                 }
             }
         }
     } catch (const std::exception& e) {
-        std::cerr << "[NetClient] Exception in receiver thread: " << e.what() << "\n";
+        LOG_ERROR("NetClient", "Exception in receiver thread").field("error", e.what());
         connected_ = false;
     } catch (...) {
-        std::cerr << "[NetClient] Unknown exception in receiver thread\n";
+        LOG_ERROR("NetClient", "Unknown exception in receiver thread");
         connected_ = false;
     }
     
-    std::cout << "[NetClient] Receiver thread stopped\n";
+    LOG_DEBUG("NetClient", "Receiver thread stopped");
 }
 
 std::unique_ptr<NetEvent> NetClient::parse_event(const Json::Value& json) {
     try {
         if (!json.isMember("type") || !json["type"].isString()) {
-            std::cerr << "[NetClient] Event missing 'type' field or type is not a string\n";
-            std::cerr << "[NetClient] JSON: " << json.toStyledString() << "\n";
+            LOG_WARN("NetClient", "Event missing 'type' field or type is not a string")
+                .field("json", Json::writeString(Json::StreamWriterBuilder(), json));
             return nullptr;
         }
         
         std::string type = json["type"].asString();
-        // std::cout << "[NetClient] Parsing event type: " << type << "\n";
+        LOG_DEBUG("NetClient", "Parsing event type").field("type", type);
         
         if (type == "hello") {
             auto evt = std::make_unique<HelloEvent>();
             if (json.isMember("client_id")) evt->client_id = json["client_id"].asInt();
             if (json.isMember("server_time_ms")) evt->server_time_ms = json["server_time_ms"].asInt64();
-            // std::cout << "[NetClient] Parsed hello: client_id=" << evt->client_id << "\n";
+            if (json.isMember("session_token")) evt->session_token = json["session_token"].asString();
+            {
+                // While resuming, keep the old token until the server answers
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                hello_token_ = evt->session_token;
+                if (!resuming_) session_token_ = evt->session_token;
+            }
+            LOG_DEBUG("NetClient", "Parsed hello").field("client_id", evt->client_id);
+            return evt;
+        }
+        
+        if (type == "resume_ok") {
+            auto evt = std::make_unique<ResumedEvent>();
+            if (json.isMember("client_id")) evt->client_id = json["client_id"].asInt();
+            if (json.isMember("display_name")) evt->display_name = json["display_name"].asString();
+            if (json.isMember("room_id")) evt->room_id = json["room_id"].asString();
+            {
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                resuming_ = false;
+                if (json.isMember("session_token")) session_token_ = json["session_token"].asString();
+            }
+            if (json.isMember("game")) {
+                const auto& self = json["game"]["self"];
+                evt->in_game = true;
+                evt->word_idx = self.get("word_idx", 0).asInt();
+                resend_inputs(self);
+            }
             return evt;
         }
         
@@ -247,6 +428,12 @@ std::unique_ptr<NetEvent> NetClient::parse_event(const Json::Value& json) {
     }
     
     if (type == "game_init") {
+        {
+            // A new game: earlier input can never need re-sending
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            sent_inputs_.clear();
+            sent_events_.clear();
+        }
         auto evt = std::make_unique<GameInitEvent>();
         if (json.isMember("room_id")) evt->room_id = json["room_id"].asString();
         if (json.isMember("server_start_ms")) evt->server_start_ms = json["server_start_ms"].asInt64();
@@ -292,6 +479,11 @@ std::unique_ptr<NetEvent> NetClient::parse_event(const Json::Value& json) {
     }
     
     if (type == "game_end") {
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            sent_inputs_.clear();
+            sent_events_.clear();
+        }
         auto evt = std::make_unique<GameEndEvent>();
         if (json.isMember("room_id")) evt->room_id = json["room_id"].asString();
         if (json.isMember("reason")) evt->reason = json["reason"].asString();
@@ -344,6 +536,14 @@ std::unique_ptr<NetEvent> NetClient::parse_event(const Json::Value& json) {
         auto evt = std::make_unique<ErrorEvent>();
         if (json.isMember("code")) evt->code = json["code"].asString();
         if (json.isMember("message")) evt->message = json["message"].asString();
+        if (evt->code == "SESSION_EXPIRED") {
+            // Too late to resume: carry on as the fresh connection
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            resuming_ = false;
+            session_token_ = hello_token_;
+            sent_inputs_.clear();
+            sent_events_.clear();
+        }
         return evt;
     }
     
@@ -354,14 +554,14 @@ std::unique_ptr<NetEvent> NetClient::parse_event(const Json::Value& json) {
         return evt;
     }
     
-    std::cerr << "[NetClient] Unknown event type: " << type << "\n";
+    LOG_WARN("NetClient", "Unknown event type").field("type", type);
     return nullptr;
     
     } catch (const std::exception& e) {
-        std::cerr << "[NetClient] Exception in parse_event: " << e.what() << "\n";
+        LOG_ERROR("NetClient", "Exception in parse_event").field("error", e.what());
         return nullptr;
     } catch (...) {
-        std::cerr << "[NetClient] Unknown exception in parse_event\n";
+        LOG_ERROR("NetClient", "Unknown exception in parse_event");
         return nullptr;
     }
 }
@@ -389,7 +589,7 @@ void NetClient::send_json_internal(const Json::Value& obj) {
 
 void NetClient::send_time_sync(int64_t client_time_ms) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send time_sync.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "time_sync");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -402,7 +602,7 @@ void NetClient::send_time_sync(int64_t client_time_ms) {
 
 void NetClient::send_set_username(const std::string& username) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send set_username.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "set_username");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -415,7 +615,7 @@ void NetClient::send_set_username(const std::string& username) {
 
 void NetClient::send_sign_in(const std::string& username, const std::string& password) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send sign_in.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "sign_in");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -429,7 +629,7 @@ void NetClient::send_sign_in(const std::string& username, const std::string& pas
 
 void NetClient::send_create_account(const std::string& username, const std::string& password) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send create_account.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "create_account");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -443,7 +643,7 @@ void NetClient::send_create_account(const std::string& username, const std::stri
 
 void NetClient::send_change_password(const std::string& username, const std::string& old_password, const std::string& new_password) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send change_password.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "change_password");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -458,7 +658,7 @@ void NetClient::send_change_password(const std::string& username, const std::str
 
 void NetClient::send_sign_out() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send sign_out.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "sign_out");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -467,12 +667,12 @@ void NetClient::send_sign_out() {
     msg["type"] = "sign_out";
     send_json_internal(msg);
     
-    std::cout << "[NetClient] Sent sign_out request\n";
+    LOG_INFO("NetClient", "Sent sign_out request");
 }
 
 void NetClient::send_create_room() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send create_room.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "create_room");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -484,7 +684,7 @@ void NetClient::send_create_room() {
 
 void NetClient::send_join_room(const std::string& room_id) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send join_room.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "join_room");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -497,7 +697,7 @@ void NetClient::send_join_room(const std::string& room_id) {
 
 void NetClient::send_join_random() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send join_random.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "join_random");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -507,9 +707,20 @@ void NetClient::send_join_random() {
     send_json_internal(msg);
 }
 
+void NetClient::send_queue_leave() {
+    if (!connected_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    
+    Json::Value msg;
+    msg["type"] = "queue_leave";
+    send_json_internal(msg);
+}
+
 void NetClient::send_exit_room() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send exit_room.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "exit_room");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -521,7 +732,7 @@ void NetClient::send_exit_room() {
 
 void NetClient::send_ready() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send ready.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "ready");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -533,7 +744,7 @@ void NetClient::send_ready() {
 
 void NetClient::send_unready() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send unready.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "unready");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -545,7 +756,7 @@ void NetClient::send_unready() {
 
 void NetClient::send_set_private(bool is_private) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send set_private.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "set_private");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -558,7 +769,7 @@ void NetClient::send_set_private(bool is_private) {
 
 void NetClient::send_start_game(int duration_ms) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send start_game.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "start_game");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -571,7 +782,7 @@ void NetClient::send_start_game(int duration_ms) {
 
 void NetClient::send_start_training() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send start_training.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "start_training");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -584,7 +795,7 @@ void NetClient::send_start_training() {
 void NetClient::send_save_training_result(const std::string& paragraph, double wpm, double accuracy,
                                            int duration_ms, int words_committed) {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send save_training_result.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "save_training_result");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -600,10 +811,6 @@ void NetClient::send_save_training_result(const std::string& paragraph, double w
 }
 
 void NetClient::send_input(const std::string& room_id, int word_idx, const Json::Value& char_events) {
-    if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send input.\n";
-        return;
-    }
     std::lock_guard<std::mutex> lock(send_mutex_);
     
     Json::Value msg;
@@ -611,12 +818,32 @@ void NetClient::send_input(const std::string& room_id, int word_idx, const Json:
     msg["room_id"] = room_id;
     msg["word_idx"] = word_idx;
     msg["char_events"] = char_events;
+    
+    // Kept even while disconnected: a resumed session sends it then
+    sent_inputs_.append(msg);
+    if (!connected_ || resuming_) return;
+    send_json_internal(msg);
+}
+
+void NetClient::send_input_batch(const std::string& room_id, const Json::Value& events) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    
+    input_room_id_ = room_id;
+    for (const auto& event : events) {
+        sent_events_.append(event);
+    }
+    if (!connected_ || resuming_) return;
+    
+    Json::Value msg;
+    msg["type"] = "input_batch";
+    msg["room_id"] = room_id;
+    msg["events"] = events;
     send_json_internal(msg);
 }
 
 void NetClient::send_leaderboard() {
     if (!connected_) {
-        std::cerr << "[NetClient] Error: Not connected to server. Cannot send leaderboard.\n";
+        LOG_WARN("NetClient", "Not connected to server, cannot send").field("type", "leaderboard");
         return;
     }
     std::lock_guard<std::mutex> lock(send_mutex_);
@@ -5,6 +5,7 @@
 #include <thread>
 #include <memory>
 #include <atomic>
+#include <chrono>
 #include <jsoncpp/json/json.h>
 #include "NetEvents.h"
 
@@ -23,6 +24,14 @@ public:
     // Disconnect
     void disconnect();
     
+    // After a dropped connection: connect again and resume the old session
+    // (room seat, running game). Inputs the server missed are re-sent once
+    // it answers. Never blocks: call again while reconnecting() until it
+    // returns true (connected) or reconnecting() turns false (failed).
+    bool reconnect();
+    bool reconnecting() const { return reconnect_fd_ >= 0; }
+    bool can_resume() const;
+    
     // Check if connected
     bool is_connected() const { return connected_; }
     
@@ -36,6 +45,7 @@ public:
     void send_create_room();
     void send_join_room(const std::string& room_id);
     void send_join_random();
+    void send_queue_leave();
     void send_exit_room();
     void send_ready();
     void send_unready();
@@ -45,6 +55,7 @@ public:
     void send_save_training_result(const std::string& paragraph, double wpm, double accuracy, 
                                     int duration_ms, int words_committed);
     void send_input(const std::string& room_id, int word_idx, const Json::Value& char_events);
+    void send_input_batch(const std::string& room_id, const Json::Value& events);
     void send_leaderboard();
     
     // Poll events from queue (call from UI thread)
@@ -55,13 +66,25 @@ private:
     // Thread function
     void receive_thread();
     
+    // Marks sockfd_ connected and starts the receiver thread
+    bool start_receiving(const std::string& ip, int port);
+    void abandon_reconnect();  // closes a connect in progress
+    
     // Send JSON (internal, assumes mutex is locked)
     void send_json_internal(const Json::Value& obj);
     
     // Parse incoming JSON and create events
     std::unique_ptr<NetEvent> parse_event(const Json::Value& json);
     
+    // Sends again what the server had not applied when the link dropped
+    void resend_inputs(const Json::Value& self);
+    
     int sockfd_ = -1;
+    
+    // Non-blocking connect in progress (reconnect), UI thread only
+    static constexpr int kReconnectTimeoutMs = 3000;
+    int reconnect_fd_ = -1;
+    std::chrono::steady_clock::time_point reconnect_started_;
     std::atomic<bool> connected_{false};
     std::atomic<bool> should_stop_{false};
     
@@ -76,5 +99,15 @@ private:
     mutable std::mutex queue_mutex_;
     
     // Send mutex
-    std::mutex send_mutex_;
+    mutable std::mutex send_mutex_;
+    
+    // Session resume (guarded by send_mutex_)
+    std::string ip_;
+    int port_ = 0;
+    std::string session_token_;
+    std::string hello_token_;      // this connection's own, used if resume fails
+    bool resuming_ = false;
+    std::string input_room_id_;
+    Json::Value sent_inputs_{Json::arrayValue};  // `input` messages this game
+    Json::Value sent_events_{Json::arrayValue};  // `input_batch` events this game, in order
 };
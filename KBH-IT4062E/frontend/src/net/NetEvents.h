@@ -16,7 +16,8 @@ enum class NetEventType {
     GameEnd,
     LeaderboardResponse,
     Error,
-    Info
+    Info,
+    Resumed
 };
 
 struct NetEvent {
@@ -29,6 +30,7 @@ struct HelloEvent : NetEvent {
     HelloEvent() { type = NetEventType::Hello; }
     int client_id = 0;
     int64_t server_time_ms = 0;
+    std::string session_token;
 };
 
 // time_sync reply
@@ -169,3 +171,13 @@ struct InfoEvent : NetEvent {
     std::string code;
     std::string message;
 };
+
+// resume_ok (inputs the server missed have already been re-sent)
+struct ResumedEvent : NetEvent {
+    ResumedEvent() { type = NetEventType::Resumed; }
+    int client_id = 0;
+    std::string display_name;
+    std::string room_id;      // empty when not in a room or training
+    bool in_game = false;
+    int word_idx = 0;         // own progress as the server has it
+};
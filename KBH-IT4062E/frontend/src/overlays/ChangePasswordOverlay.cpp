@@ -2,28 +2,25 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
+#include "log.h"
 #include <SDL_image.h>
-#include <iostream>
 
 void ChangePasswordOverlay::onEnter() {
-    std::cout << "[ChangePasswordOverlay] onEnter() called\n";
-    std::cout << "[ChangePasswordOverlay] this = " << this << "\n";
-    std::cout << "[ChangePasswordOverlay] app = " << app << "\n";
+    LOG_DEBUG("ChangePasswordOverlay", "onEnter() called");
     
-    std::cout << "[ChangePasswordOverlay] Clearing fields...\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Clearing fields");
     currentPassword_ = "";
     newPassword_ = "";
     confirmPassword_ = "";
     errorMessage_ = "";
     activeField_ = 0;
-    std::cout << "[ChangePasswordOverlay] Fields cleared\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Fields cleared");
     
-    std::cout << "[ChangePasswordOverlay] Calculating frame position...\n";
     int frameX = (UiTheme::DesignW - 1163) / 2;
     int frameY = (UiTheme::DesignH - 652) / 2;
-    std::cout << "[ChangePasswordOverlay] Frame: " << frameX << ", " << frameY << "\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Frame").field("x", frameX).field("y", frameY);
     
-    std::cout << "[ChangePasswordOverlay] Setting rects...\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Setting rects");
     // Current password field (same position as username in CreateAccount)
     currentPasswordField_ = {frameX + 437, frameY + 178, 607, 64};
     
@@ -38,19 +35,20 @@ void ChangePasswordOverlay::onEnter() {
     
     // Exit button
     exitButton_ = {frameX + 1023, frameY + 26, 85, 85};
-    std::cout << "[ChangePasswordOverlay] Rects set\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Rects set");
     
-    std::cout << "[ChangePasswordOverlay] Loading exit button texture...\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Loading exit button texture");
     exitButtonTexture_ = IMG_LoadTexture(app->renderer(), UiTheme::ExitButtonPath);
     if (!exitButtonTexture_) {
-        std::cerr << "[ChangePasswordOverlay] Failed to load exit button texture: " << IMG_GetError() << "\n";
+        LOG_ERROR("ChangePasswordOverlay", "Failed to load exit button texture")
+            .field("error", IMG_GetError());
     } else {
-        std::cout << "[ChangePasswordOverlay] Exit button texture loaded\n";
+        LOG_DEBUG("ChangePasswordOverlay", "Exit button texture loaded");
     }
     
-    std::cout << "[ChangePasswordOverlay] Starting text input...\n";
+    LOG_DEBUG("ChangePasswordOverlay", "Starting text input");
     SDL_StartTextInput();
-    std::cout << "[ChangePasswordOverlay] onEnter() complete\n";
+    LOG_DEBUG("ChangePasswordOverlay", "onEnter() complete");
 }
 
 void ChangePasswordOverlay::onExit() {
@@ -1,7 +1,7 @@
 #pragma once
 #include "../core/View.h"
+#include "log.h"
 #include <string>
-#include <iostream>
 
 class ChangePasswordOverlay : public View {
 public:
@@ -12,7 +12,7 @@ public:
           errorMessage_(""),
           activeField_(0), 
           exitButtonTexture_(nullptr) {
-        std::cout << "[ChangePasswordOverlay] Constructor called\n";
+        LOG_DEBUG("ChangePasswordOverlay", "Constructor called");
     }
     
     void onEnter() override;
@@ -2,21 +2,21 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
+#include "log.h"
 #include <SDL_image.h>
-#include <iostream>
 
 void CreateAccountOverlay::onEnter() {
-    std::cout << "[CreateAccountOverlay] onEnter() called\n";
+    LOG_DEBUG("CreateAccountOverlay", "onEnter() called");
     username_.clear();
     password_.clear();
     confirmPassword_.clear();
     errorMessage_.clear();
     activeField_ = 0;
-    std::cout << "[CreateAccountOverlay] Fields cleared\n";
+    LOG_DEBUG("CreateAccountOverlay", "Fields cleared");
     
     int frameX = (UiTheme::DesignW - 1163) / 2;
     int frameY = (UiTheme::DesignH - 652) / 2;
-    std::cout << "[CreateAccountOverlay] Frame position: " << frameX << ", " << frameY << "\n";
+    LOG_DEBUG("CreateAccountOverlay", "Frame position").field("x", frameX).field("y", frameY);
     
     // Username field (offset from frame)
     usernameField_ = {frameX + 437, frameY + 178, 607, 64};
@@ -32,19 +32,21 @@ void CreateAccountOverlay::onEnter() {
     
     // Exit button
     exitButton_ = {frameX + 1023, frameY + 26, 85, 85};
-    std::cout << "[CreateAccountOverlay] Rects initialized\n";
+    LOG_DEBUG("CreateAccountOverlay", "Rects initialized");
     
-    std::cout << "[CreateAccountOverlay] Loading exit button texture from: " << UiTheme::ExitButtonPath << "\n";
+    LOG_DEBUG("CreateAccountOverlay", "Loading exit button texture")
+        .field("path", UiTheme::ExitButtonPath);
     exitButtonTexture_ = IMG_LoadTexture(app->renderer(), UiTheme::ExitButtonPath);
     if (!exitButtonTexture_) {
-        std::cerr << "[CreateAccountOverlay] Failed to load exit button texture: " << IMG_GetError() << "\n";
+        LOG_ERROR("CreateAccountOverlay", "Failed to load exit button texture")
+            .field("error", IMG_GetError());
     } else {
-        std::cout << "[CreateAccountOverlay] Exit button texture loaded\n";
+        LOG_DEBUG("CreateAccountOverlay", "Exit button texture loaded");
     }
     
-    std::cout << "[CreateAccountOverlay] Starting text input\n";
+    LOG_DEBUG("CreateAccountOverlay", "Starting text input");
     SDL_StartTextInput();
-    std::cout << "[CreateAccountOverlay] onEnter() complete\n";
+    LOG_DEBUG("CreateAccountOverlay", "onEnter() complete");
 }
 
 void CreateAccountOverlay::onExit() {
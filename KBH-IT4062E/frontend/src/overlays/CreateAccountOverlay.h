@@ -1,13 +1,13 @@
 #pragma once
 #include "../core/View.h"
+#include "log.h"
 #include <string>
-#include <iostream>
 
 class CreateAccountOverlay : public View {
 public:
     CreateAccountOverlay() 
         : activeField_(0), exitButtonTexture_(nullptr) {
-        std::cout << "[CreateAccountOverlay] Constructor called\n";
+        LOG_DEBUG("CreateAccountOverlay", "Constructor called");
     }
     
     void onEnter() override;
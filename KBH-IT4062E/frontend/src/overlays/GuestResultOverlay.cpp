@@ -2,26 +2,28 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <sstream>
 #include <iomanip>
 
 void GuestResultOverlay::onEnter() {
-    std::cout << "[GuestResultOverlay] onEnter()\n";
+    LOG_DEBUG("GuestResultOverlay", "onEnter()");
     
     // Load player result from GameEnd
     if (app->state().hasGameEnd()) {
         const auto& rankings = app->state().getGameEnd().rankings;
         if (!rankings.empty()) {
             playerResult = rankings[0];  // Training mode has only 1 player
-            std::cout << "[GuestResultOverlay] Loaded result: " << playerResult.display_name
-                      << " WPM=" << playerResult.wpm << " ACC=" << playerResult.accuracy << "%"
-                      << " word_idx=" << playerResult.word_idx << "\n";
+            LOG_DEBUG("GuestResultOverlay", "Loaded result")
+                .field("name", playerResult.display_name)
+                .field("wpm", playerResult.wpm)
+                .field("acc", playerResult.accuracy)
+                .field("word_idx", playerResult.word_idx);
         } else {
-            std::cout << "[GuestResultOverlay] No rankings data!\n";
+            LOG_WARN("GuestResultOverlay", "No rankings data");
         }
     } else {
-        std::cout << "[GuestResultOverlay] No GameEnd event!\n";
+        LOG_WARN("GuestResultOverlay", "No GameEnd event");
     }
     
     // Define button hit rects relative to content frame position
@@ -46,12 +48,12 @@ void GuestResultOverlay::windowToLogical(int wx, int wy, int& lx, int& ly) const
 }
 
 void GuestResultOverlay::handleExitMenu() {
-    std::cout << "[GuestResultOverlay] Exit menu clicked\n";
+    LOG_INFO("GuestResultOverlay", "Exit menu clicked");
     app->router().change(RouteId::Title);
 }
 
 void GuestResultOverlay::handleLoginToSave() {
-    std::cout << "[GuestResultOverlay] Login to Save clicked\n";
+    LOG_INFO("GuestResultOverlay", "Login to Save clicked");
     app->router().push(RouteId::SignInOverlay);
 }
 
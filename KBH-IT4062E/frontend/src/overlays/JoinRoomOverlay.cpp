@@ -2,7 +2,7 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <cctype>
 #include <cmath>
 
@@ -248,14 +248,14 @@ void JoinRoomOverlay::drawRoundedRect(SDL_Renderer* r, int x, int y, int w, int
 }
 
 bool JoinRoomOverlay::isJoinEnabled() const {
-    return room_code.length() >= 4; // Minimum 4 chars, adjust as needed
+    return room_code.length() == 6; // Room codes are always 6 chars
 }
 
 void JoinRoomOverlay::set_join_result(bool ok, const std::string& msg) {
     if (ok) {
         clear_error();
         // Success - let external code handle navigation to LobbyScreen
-        std::cout << "[JoinRoomOverlay] Join successful\n";
+        LOG_INFO("JoinRoomOverlay", "Join successful");
     } else {
         set_error(msg);
     }
@@ -273,19 +273,21 @@ void JoinRoomOverlay::clear_error() {
 
 // Placeholder callbacks
 void JoinRoomOverlay::btn_back_to_menu_pressed() {
-    std::cout << "[JoinRoomOverlay] Back to menu pressed\n";
+    LOG_INFO("JoinRoomOverlay", "Back to menu pressed");
+    // Leave the matchmaking queue if join_random put us in it (no-op otherwise)
+    app->network().send_queue_leave();
     app->router().pop();
 }
 
 void JoinRoomOverlay::btn_join_pressed() {
-    std::cout << "[JoinRoomOverlay] Join pressed with code: " << room_code << "\n";
+    LOG_INFO("JoinRoomOverlay", "Join pressed with code").field("room_code", room_code);
     // Send join room request
     app->network().send_join_room(room_code);
     // Wait for server response via set_join_result()
 }
 
 void JoinRoomOverlay::btn_random_room_pressed() {
-    std::cout << "[JoinRoomOverlay] Random room pressed\n";
+    LOG_INFO("JoinRoomOverlay", "Random room pressed");
     // Send join random request
     app->network().send_join_random();
     // Wait for server response
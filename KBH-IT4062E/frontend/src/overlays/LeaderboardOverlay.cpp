@@ -2,7 +2,7 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -14,7 +14,7 @@ LeaderboardOverlay::LeaderboardOverlay()
 }
 
 void LeaderboardOverlay::onEnter() {
-    std::cout << "[LeaderboardOverlay] onEnter()\n";
+    LOG_DEBUG("LeaderboardOverlay", "onEnter()");
     scrollOffset = 0;
     
     // Calculate max scroll based on number of entries
@@ -23,10 +23,12 @@ void LeaderboardOverlay::onEnter() {
         int numEntries = (int)lb.top8.size();
         int visibleRows = 426 / 57;  // Container height / row height
         maxScroll = (numEntries > visibleRows) ? (numEntries - visibleRows) : 0;
-        std::cout << "[LeaderboardOverlay] Loaded " << numEntries << " entries, maxScroll=" << maxScroll << "\n";
+        LOG_DEBUG("LeaderboardOverlay", "Loaded")
+            .field("entries", numEntries)
+            .field("max_scroll", maxScroll);
     } else {
         maxScroll = 0;
-        std::cout << "[LeaderboardOverlay] No leaderboard data available\n";
+        LOG_INFO("LeaderboardOverlay", "No leaderboard data available");
     }
 }
 
@@ -2,20 +2,23 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <iomanip>
 #include <sstream>
 
 void MatchResultOverlay::onEnter() {
-    std::cout << "[MatchResultOverlay] onEnter()\n";
+    LOG_DEBUG("MatchResultOverlay", "onEnter()");
     
     // Load rankings from AppState
     if (app->state().hasGameEnd()) {
         rankings = app->state().getGameEnd().rankings;
-        std::cout << "[MatchResultOverlay] Loaded " << rankings.size() << " rankings\n";
+        LOG_DEBUG("MatchResultOverlay", "Loaded rankings").field("count", rankings.size());
         for (const auto& r : rankings) {
-            std::cout << "  Rank " << r.rank << ": " << r.display_name 
-                      << " WPM=" << r.wpm << " ACC=" << r.accuracy << "%\n";
+            LOG_DEBUG("MatchResultOverlay", "Rank")
+                .field("rank", r.rank)
+                .field("display_name", r.display_name)
+                .field("wpm", r.wpm)
+                .field("acc", r.accuracy);
         }
     }
     
@@ -204,7 +207,7 @@ void MatchResultOverlay::windowToLogical(int wx, int wy, int& lx, int& ly) const
 }
 
 void MatchResultOverlay::handleExitMenu() {
-    std::cout << "[MatchResultOverlay] Exit menu pressed\n";
+    LOG_INFO("MatchResultOverlay", "Exit menu pressed");
     
     // Exit to menu: close overlay, close GameScreen, close LobbyScreen
     // Send exit_room to server
@@ -226,7 +229,7 @@ void MatchResultOverlay::handleExitMenu() {
 }
 
 void MatchResultOverlay::handleReturnLobby() {
-    std::cout << "[MatchResultOverlay] Return lobby pressed\n";
+    LOG_INFO("MatchResultOverlay", "Return lobby pressed");
     
     // Return to lobby: close overlay and GameScreen
     // Keep room, server will send updated room_state
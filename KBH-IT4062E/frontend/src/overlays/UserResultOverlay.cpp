@@ -2,26 +2,28 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <sstream>
 #include <iomanip>
 
 void UserResultOverlay::onEnter() {
-    std::cout << "[UserResultOverlay] onEnter()\n";
+    LOG_DEBUG("UserResultOverlay", "onEnter()");
     
     // Load player result from GameEnd
     if (app->state().hasGameEnd()) {
         const auto& rankings = app->state().getGameEnd().rankings;
         if (!rankings.empty()) {
             playerResult = rankings[0];  // Training mode has only 1 player
-            std::cout << "[UserResultOverlay] Loaded result: " << playerResult.display_name
-                      << " WPM=" << playerResult.wpm << " ACC=" << playerResult.accuracy << "%"
-                      << " word_idx=" << playerResult.word_idx << "\n";
+            LOG_DEBUG("UserResultOverlay", "Loaded result")
+                .field("name", playerResult.display_name)
+                .field("wpm", playerResult.wpm)
+                .field("acc", playerResult.accuracy)
+                .field("word_idx", playerResult.word_idx);
         } else {
-            std::cout << "[UserResultOverlay] No rankings data!\n";
+            LOG_WARN("UserResultOverlay", "No rankings data");
         }
     } else {
-        std::cout << "[UserResultOverlay] No GameEnd event!\n";
+        LOG_WARN("UserResultOverlay", "No GameEnd event");
     }
     
     // Define button hit rects relative to content frame position
@@ -46,12 +48,12 @@ void UserResultOverlay::windowToLogical(int wx, int wy, int& lx, int& ly) const
 }
 
 void UserResultOverlay::handleExitMenu() {
-    std::cout << "[UserResultOverlay] Exit menu clicked\n";
+    LOG_INFO("UserResultOverlay", "Exit menu clicked");
     app->router().change(RouteId::Title);
 }
 
 void UserResultOverlay::handleTryAgain() {
-    std::cout << "[UserResultOverlay] Try Again clicked\n";
+    LOG_INFO("UserResultOverlay", "Try Again clicked");
     // Set flag to auto-start training, then go to title
     app->state().setAutoStartTraining(true);
     app->router().change(RouteId::Title);
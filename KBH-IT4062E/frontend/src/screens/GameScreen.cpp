@@ -2,54 +2,58 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 #include <sstream>
 #include <algorithm>
 
 void GameScreen::onEnter() {
-    std::cout << "[GameScreen] onEnter()\n";
+    LOG_DEBUG("GameScreen", "onEnter()");
     
     try {
         // Load background
         bgTexture = app->resources().texture(UiTheme::GameScreenBackground);
         if (!bgTexture) {
-            std::cerr << "[GameScreen] Failed to load background\n";
+            LOG_ERROR("GameScreen", "Failed to load background");
         }
         
         // Load knight textures
         for (int i = 0; i < 8; ++i) {
             knightTextures[i] = app->resources().texture(UiTheme::LobbyKnightPaths[i]);
             if (!knightTextures[i]) {
-                std::cerr << "[GameScreen] Failed to load knight " << i << "\n";
+                LOG_ERROR("GameScreen", "Failed to load knight").field("index", i);
             }
         }
         
-        std::cout << "[GameScreen] About to load game state\n";
+        LOG_DEBUG("GameScreen", "About to load game state");
         // Load game state from server (AppState)
         loadGameStateFromServer();
         
-        std::cout << "[GameScreen] About to set local game start\n";
+        LOG_DEBUG("GameScreen", "About to set local game start");
         // Store local game start time for timestamp conversion
         local_game_start = SDL_GetTicks64();
         
-        std::cout << "[GameScreen] About to split paragraph\n";
+        streamingInput = app->config().streaming_input;
+        pendingBatch.clear();
+        lastBatchFlush = local_game_start;
+        
+        LOG_DEBUG("GameScreen", "About to split paragraph");
         splitParagraphIntoWords();
         
-        std::cout << "[GameScreen] About to start text input\n";
+        LOG_DEBUG("GameScreen", "About to start text input");
         // Only start text input if not already started
         if (!SDL_IsTextInputActive()) {
             SDL_StartTextInput();
         }
         
-        std::cout << "[GameScreen] onEnter() completed successfully\n";
+        LOG_DEBUG("GameScreen", "onEnter() completed successfully");
     } catch (const std::exception& e) {
-        std::cerr << "[GameScreen] Exception in onEnter(): " << e.what() << "\n";
+        LOG_ERROR("GameScreen", "Exception in onEnter()").field("error", e.what());
         throw;
     }
 }
 
 void GameScreen::onExit() {
-    std::cout << "[GameScreen] onExit()\n";
+    LOG_DEBUG("GameScreen", "onExit()");
     bgTexture = nullptr;
     for (int i = 0; i < 8; ++i) {
         knightTextures[i] = nullptr;
@@ -69,7 +73,7 @@ void GameScreen::handleEvent(const SDL_Event& e) {
             // Convert local time to server time
             int64_t local_elapsed = SDL_GetTicks64() - local_game_start;
             ce.time_ms = game_start_time + local_elapsed;
-            currentWordCharEvents.push_back(ce);
+            recordCharEvent(ce);
         }
         else if (e.key.keysym.sym == SDLK_SPACE) {
             // Check if current word is complete
@@ -77,18 +81,29 @@ void GameScreen::handleEvent(const SDL_Event& e) {
                 const std::string& targetWord = paragraphWords[currentWordIndex];
                 if (playerInput == targetWord) {
                     // Correct! Send to server and move to next word
-                    sendInputToServer();
+                    if (streamingInput) {
+                        CharEvent ce;
+                        ce.ch = ' ';
+                        ce.backspace = false;
+                        ce.commit_word = currentWordIndex;
+                        ce.time_ms = game_start_time + (SDL_GetTicks64() - local_game_start);
+                        pendingBatch.push_back(ce);
+                    } else {
+                        sendInputToServer();
+                    }
                     currentWordIndex++;
                     playerInput.clear();
                     currentWordCharEvents.clear();
                     scrollIfNeeded();
                     
-                    std::cout << "[GameScreen] Completed word " << currentWordIndex 
-                              << "/" << paragraphWords.size() << "\n";
+                    LOG_DEBUG("GameScreen", "Completed word")
+                        .field("word_idx", currentWordIndex)
+                        .field("words", paragraphWords.size());
                 } else {
                     // Wrong word, don't advance
-                    std::cout << "[GameScreen] Wrong word: '" << playerInput 
-                              << "' != '" << targetWord << "'\n";
+                    LOG_DEBUG("GameScreen", "Wrong word")
+                        .field("input", playerInput)
+                        .field("target", targetWord);
                 }
             }
         }
@@ -110,14 +125,27 @@ void GameScreen::handleEvent(const SDL_Event& e) {
             // Convert local time to server time
             int64_t local_elapsed = SDL_GetTicks64() - local_game_start;
             ce.time_ms = game_start_time + local_elapsed;
-            currentWordCharEvents.push_back(ce);
+            recordCharEvent(ce);
         }
     }
 }
 
+void GameScreen::recordCharEvent(const CharEvent& ce) {
+    currentWordCharEvents.push_back(ce);
+    if (streamingInput) {
+        pendingBatch.push_back(ce);
+    }
+}
+
 void GameScreen::update(float dt) {
     (void)dt;
     
+    // Streaming input: send what was typed since the last flush
+    if (streamingInput && !pendingBatch.empty() &&
+        SDL_GetTicks64() - lastBatchFlush >= (Uint64)app->config().input_flush_ms) {
+        flushInputBatch();
+    }
+    
     // Update player progress from game_state events
     if (app->state().hasGameState()) {
         const auto& gs = app->state().getGameState();
@@ -130,7 +158,7 @@ void GameScreen::update(float dt) {
         
         // Check if game ended
         if (gs.ended) {
-            std::cout << "[GameScreen] Game ended detected in game_state\n";
+            LOG_INFO("GameScreen", "Game ended detected in game_state");
             // App.cpp will handle navigation
         }
     } else {
@@ -254,19 +282,20 @@ void GameScreen::renderTextField(SDL_Renderer* r) {
 }
 
 void GameScreen::splitParagraphIntoWords() {
-    std::cout << "[GameScreen] splitParagraphIntoWords() called\n";
+    LOG_DEBUG("GameScreen", "splitParagraphIntoWords() called");
     
     try {
         paragraphWords.clear();
         paragraphWords.reserve(100); // Pre-allocate to avoid reallocs
         
         if (paragraph.empty()) {
-            std::cerr << "[GameScreen] Warning: paragraph is empty!\n";
+            LOG_WARN("GameScreen", "Paragraph is empty");
             return;
         }
         
-        std::cout << "[GameScreen] Paragraph length: " << paragraph.length() << "\n";
-        std::cout << "[GameScreen] First 50 chars: " << paragraph.substr(0, std::min<size_t>(50, paragraph.length())) << "\n";
+        LOG_DEBUG("GameScreen", "Paragraph length").field("length", paragraph.length());
+        LOG_DEBUG("GameScreen", "First 50 chars")
+            .field("text", paragraph.substr(0, std::min<size_t>(50, paragraph.length())));
         
         std::istringstream iss(paragraph);
         std::string word;
@@ -275,12 +304,12 @@ void GameScreen::splitParagraphIntoWords() {
             paragraphWords.push_back(word);
             count++;
             if (count % 10 == 0) {
-                std::cout << "[GameScreen] Split " << count << " words so far...\n";
+                LOG_DEBUG("GameScreen", "Splitting").field("words", count);
             }
         }
-        std::cout << "[GameScreen] Split paragraph into " << paragraphWords.size() << " words\n";
+        LOG_DEBUG("GameScreen", "Split paragraph").field("words", paragraphWords.size());
     } catch (const std::exception& e) {
-        std::cerr << "[GameScreen] Exception in splitParagraphIntoWords(): " << e.what() << "\n";
+        LOG_ERROR("GameScreen", "Exception in splitParagraphIntoWords()").field("error", e.what());
         throw;
     }
 }
@@ -463,10 +492,10 @@ void GameScreen::loadGameStateFromServer() {
         game_start_time = gi.server_start_ms;
         game_duration_ms = gi.duration_ms;
         
-        std::cout << "[GameScreen] Loaded from game_init:\n";
-        std::cout << "  Paragraph: " << paragraph.substr(0, 60) << "...\n";
-        std::cout << "  Duration: " << game_duration_ms << "ms\n";
-        std::cout << "  Players: " << gi.players.size() << "\n";
+        LOG_DEBUG("GameScreen", "Loaded from game_init")
+            .field("paragraph", paragraph.substr(0, 60))
+            .field("duration_ms", game_duration_ms)
+            .field("players", gi.players.size());
         
         // Load players from game_init
         for (const auto& p : gi.players) {
@@ -482,14 +511,14 @@ void GameScreen::loadGameStateFromServer() {
                     
                     if (p.client_id == room.self_client_id) {
                         self_slot_idx = p.slot_idx;
-                        std::cout << "  Self slot: " << self_slot_idx << "\n";
+                        LOG_DEBUG("GameScreen", "Self slot").field("slot", self_slot_idx);
                     }
                 }
             }
         }
     } else {
         // Fallback: test data
-        std::cout << "[GameScreen] No game_init, using test data\n";
+        LOG_INFO("GameScreen", "No game_init, using test data");
         paragraph = "The quick brown fox jumps over the lazy dog";
         players[0].active = true;
         players[0].name = "Player 1";
@@ -504,7 +533,7 @@ void GameScreen::sendInputToServer() {
     // Format: {"type": "input", "room_id": "...", "word_idx": 5, "char_events": [...]}
     
     if (!app->state().hasGameInit()) {
-        std::cout << "[GameScreen] No game_init, cannot send input\n";
+        LOG_WARN("GameScreen", "No game_init, cannot send input");
         return;
     }
     
@@ -524,12 +553,45 @@ void GameScreen::sendInputToServer() {
         charEventsArray.append(event);
     }
     
-    std::cout << "[GameScreen] Sending word " << currentWordIndex 
-              << " with " << currentWordCharEvents.size() << " char events\n";
+    LOG_DEBUG("GameScreen", "Sending word")
+        .field("word_idx", currentWordIndex)
+        .field("char_events", currentWordCharEvents.size());
     
     app->network().send_input(gi.room_id, currentWordIndex, charEventsArray);
 }
 
+void GameScreen::flushInputBatch() {
+    // Format: {"type": "input_batch", "room_id": "...", "events": [...]}
+    // where events are char / backspace / commit (with word_idx)
+    lastBatchFlush = SDL_GetTicks64();
+    
+    if (!app->state().hasGameInit()) {
+        pendingBatch.clear();
+        return;
+    }
+    
+    const auto& gi = app->state().getGameInit();
+    
+    Json::Value events(Json::arrayValue);
+    for (const auto& ce : pendingBatch) {
+        Json::Value event;
+        if (ce.commit_word >= 0) {
+            event["type"] = "commit";
+            event["word_idx"] = ce.commit_word;
+        } else if (ce.backspace) {
+            event["type"] = "backspace";
+        } else {
+            event["type"] = "char";
+            event["char"] = std::string(1, ce.ch);
+        }
+        event["time_ms"] = (Json::Int64)ce.time_ms;
+        events.append(event);
+    }
+    pendingBatch.clear();
+    
+    app->network().send_input_batch(gi.room_id, events);
+}
+
 int GameScreen::getKnightY(int slotIndex) const {
     // Linear interpolation from slot 0 at y=279 to slot 7 at y=590
     const int startY = 279;
@@ -40,9 +40,15 @@ private:
         char ch;
         int64_t time_ms;
         bool backspace;
+        int commit_word = -1; // >= 0: word commit marker (streaming only)
     };
     std::vector<CharEvent> currentWordCharEvents;
     
+    // Streaming input: events not yet sent, flushed every input_flush_ms
+    bool streamingInput = false;
+    std::vector<CharEvent> pendingBatch;
+    Uint64 lastBatchFlush = 0;
+    
     // Game timing
     int64_t game_start_time = 0;  // Server time when game started
     int64_t local_game_start = 0; // Local SDL_GetTicks64() when game started
@@ -68,6 +74,8 @@ private:
     // Server integration
     void loadGameStateFromServer();
     void sendInputToServer();
+    void recordCharEvent(const CharEvent& ce);
+    void flushInputBatch();
     
     // Position helpers
     int getKnightY(int slotIndex) const;
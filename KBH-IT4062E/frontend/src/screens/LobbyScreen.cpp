@@ -2,39 +2,48 @@
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
 #include "../ui/TextDraw.h"
-#include <iostream>
+#include "log.h"
 
 static bool pointInRect(int x, int y, const SDL_Rect& r) {
     return (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h);
 }
 
 void LobbyScreen::onEnter() {
-    std::cout << "[LobbyScreen] onEnter() called\n";
+    LOG_DEBUG("LobbyScreen", "onEnter() called");
     
     // Load assets with null checks
     logoKnight = app->resources().texture(UiTheme::LobbyBgKnightPath);
-    if (!logoKnight) std::cerr << "[LobbyScreen] Failed to load logoKnight\n";
+    if (!logoKnight) {
+        LOG_ERROR("LobbyScreen", "Failed to load logoKnight");
+    }
     
     privateIcon = app->resources().texture(UiTheme::LobbyLockPath);
-    if (!privateIcon) std::cerr << "[LobbyScreen] Failed to load privateIcon\n";
+    if (!privateIcon) {
+        LOG_ERROR("LobbyScreen", "Failed to load privateIcon");
+    }
     
     readyCheck = app->resources().texture(UiTheme::LobbyReadyTickPath);
-    if (!readyCheck) std::cerr << "[LobbyScreen] Failed to load readyCheck\n";
+    if (!readyCheck) {
+        LOG_ERROR("LobbyScreen", "Failed to load readyCheck");
+    }
     
     copyIcon = app->resources().texture(UiTheme::LobbyCopyIconPath);
-    if (!copyIcon) std::cerr << "[LobbyScreen] Failed to load copyIcon\n";
+    if (!copyIcon) {
+        LOG_ERROR("LobbyScreen", "Failed to load copyIcon");
+    }
     
     // Load all knight textures
-    std::cout << "[LobbyScreen] Loading knight textures...\n";
+    LOG_DEBUG("LobbyScreen", "Loading knight textures");
     for (int i = 0; i < 8; ++i) {
         knightTextures[i] = app->resources().texture(UiTheme::LobbyKnightPaths[i]);
         if (!knightTextures[i]) {
-            std::cerr << "[LobbyScreen] Failed to load knight texture " << i << ": " 
-                      << UiTheme::LobbyKnightPaths[i] << "\n";
+            LOG_ERROR("LobbyScreen", "Failed to load knight texture")
+                .field("index", i)
+                .field("path", UiTheme::LobbyKnightPaths[i]);
         }
     }
     
-    std::cout << "[LobbyScreen] Setting up button rects...\n";
+    LOG_DEBUG("LobbyScreen", "Setting up button rects");
     // Setup button rects (footer y = 1024 - 150 = 874)
     const int footerY = 874;
     exitRect = {27, footerY + 46, 250, 60};
@@ -49,16 +58,16 @@ void LobbyScreen::onEnter() {
     
     hoveredBtn = -1;
     
-    std::cout << "[LobbyScreen] onEnter() complete\n";
+    LOG_DEBUG("LobbyScreen", "onEnter() complete");
 }
 
 void LobbyScreen::onExit() {
-    std::cout << "[LobbyScreen] onExit() called\n";
+    LOG_DEBUG("LobbyScreen", "onExit() called");
     logoKnight = privateIcon = readyCheck = copyIcon = nullptr;
     for (int i = 0; i < 8; ++i) {
         knightTextures[i] = nullptr;
     }
-    std::cout << "[LobbyScreen] onExit() complete\n";
+    LOG_DEBUG("LobbyScreen", "onExit() complete");
 }
 
 void LobbyScreen::windowToLogical(int wx, int wy, int& lx, int& ly) const {
@@ -391,14 +400,14 @@ void LobbyScreen::renderPrivateState(SDL_Renderer* r) {
 
 // Button callbacks (placeholder)
 void LobbyScreen::btn_exit_pressed() {
-    std::cout << "[LobbyScreen] Exit button pressed\n";
+    LOG_INFO("LobbyScreen", "Exit button pressed");
     app->network().send_exit_room();
     app->state().clearRoomState();
     app->router().change(RouteId::Title);
 }
 
 void LobbyScreen::btn_ready_pressed() {
-    std::cout << "[LobbyScreen] Ready button pressed\n";
+    LOG_INFO("LobbyScreen", "Ready button pressed");
     
     if (isSelfReady()) {
         app->network().send_unready();
@@ -408,7 +417,7 @@ void LobbyScreen::btn_ready_pressed() {
 }
 
 void LobbyScreen::btn_start_pressed() {
-    std::cout << "[LobbyScreen] Start button pressed\n";
+    LOG_INFO("LobbyScreen", "Start button pressed");
     app->network().send_start_game(60000); // 60 seconds
 }
 
@@ -442,7 +451,7 @@ void LobbyScreen::btn_copy_room_id_pressed() {
     const auto& room = app->state().getRoomState();
     if (room.room_id.empty()) return;
     
-    std::cout << "[LobbyScreen] Copy room ID: " << room.room_id << "\n";
+    LOG_INFO("LobbyScreen", "Copy room ID").field("room_id", room.room_id);
     
     // Copy to clipboard using SDL - make safe copy first
     std::string safeId = room.room_id;
@@ -456,8 +465,8 @@ void LobbyScreen::btn_toggle_private_pressed() {
     const auto& room = app->state().getRoomState();
     bool newPrivateState = !room.is_private;
     
-    std::cout << "[LobbyScreen] Toggle private/public pressed - setting to: " 
-              << (newPrivateState ? "private" : "public") << "\n";
+    LOG_INFO("LobbyScreen", "Toggle private/public pressed")
+        .field("private", newPrivateState);
     
     // Send message to server
     app->network().send_set_private(newPrivateState);
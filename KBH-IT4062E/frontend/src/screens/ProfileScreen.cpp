@@ -1,10 +1,10 @@
 #include "ProfileScreen.h"
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
+#include "log.h"
 #include <SDL_ttf.h>
 #include <cmath>
 #include <algorithm>
-#include <iostream>
 
 static bool pointInRect(int x, int y, const SDL_Rect& r) {
     return (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h);
@@ -240,25 +240,23 @@ void ProfileScreen::drawHoverButton(SDL_Renderer* r, const SDL_Rect& outer, bool
 }
 
 void ProfileScreen::onEnter() {
-    std::cout << "[ProfileScreen] onEnter() start\n";
-    std::cout << "[ProfileScreen] this = " << this << "\n";
-    std::cout << "[ProfileScreen] app = " << app << "\n";
+    LOG_DEBUG("ProfileScreen", "onEnter() start");
     
-    std::cout << "[ProfileScreen] Loading bg texture...\n";
+    LOG_DEBUG("ProfileScreen", "Loading bg texture");
     bg = app->resources().texture(UiTheme::TitleBgPath);
-    std::cout << "[ProfileScreen] bg loaded: " << (bg ? "OK" : "NULL") << "\n";
+    LOG_DEBUG("ProfileScreen", "bg loaded").field("ok", bg != nullptr);
     
-    std::cout << "[ProfileScreen] Loading logo texture...\n";
+    LOG_DEBUG("ProfileScreen", "Loading logo texture");
     logo = app->resources().texture(UiTheme::TitleLogoPath);
-    std::cout << "[ProfileScreen] logo loaded: " << (logo ? "OK" : "NULL") << "\n";
+    LOG_DEBUG("ProfileScreen", "logo loaded").field("ok", logo != nullptr);
 
-    std::cout << "[ProfileScreen] About to clear vectors...\n";
-    std::cout << "[ProfileScreen] menuText.size() before clear: " << menuText.size() << "\n";
+    LOG_DEBUG("ProfileScreen", "About to clear vectors");
+    LOG_DEBUG("ProfileScreen", "Clearing menuText").field("size", menuText.size());
     
     // Don't clear, just resize to 0
     menuText.resize(0);
     menuRect.resize(0);
-    std::cout << "[ProfileScreen] Vectors resized to 0\n";
+    LOG_DEBUG("ProfileScreen", "Vectors resized to 0");
 
     // Only 2 menu items for ProfileScreen
     std::vector<std::string> labels {
@@ -266,21 +264,21 @@ void ProfileScreen::onEnter() {
         "Change Password"
     };
     
-    std::cout << "[ProfileScreen] Created labels vector with " << labels.size() << " items\n";
+    LOG_DEBUG("ProfileScreen", "Created labels vector").field("items", labels.size());
 
     for (size_t i = 0; i < labels.size(); ++i) {
-        std::cout << "[ProfileScreen] Creating text for item " << i << ": " << labels[i] << "\n";
+        LOG_DEBUG("ProfileScreen", "Creating text for item").field("index", i).field("label", labels[i]);
         TextTex t = makeText(labels[i], 64);
-        std::cout << "[ProfileScreen] Text created, pushing to menuText...\n";
+        LOG_DEBUG("ProfileScreen", "Text created, pushing to menuText");
         menuText.push_back(t);
-        std::cout << "[ProfileScreen] Pushed to menuText, pushing rect...\n";
+        LOG_DEBUG("ProfileScreen", "Pushed to menuText, pushing rect");
         menuRect.push_back(SDL_Rect{0,0,0,0});
-        std::cout << "[ProfileScreen] Rect pushed\n";
+        LOG_DEBUG("ProfileScreen", "Rect pushed");
     }
     
-    std::cout << "[ProfileScreen] Creating signOutText...\n";
+    LOG_DEBUG("ProfileScreen", "Creating signOutText");
     signOutText = makeText("Sign Out", 58);
-    std::cout << "[ProfileScreen] signOutText created\n";
+    LOG_DEBUG("ProfileScreen", "signOutText created");
 
     // Layout - same as TitleScreen
     const int menuX = 77;
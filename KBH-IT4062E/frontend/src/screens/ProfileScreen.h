@@ -1,9 +1,9 @@
 #pragma once
 #include "../core/View.h"
+#include "log.h"
 #include <SDL.h>
 #include <string>
 #include <vector>
-#include <iostream>
 
 class ProfileScreen : public View {
 public:
@@ -13,7 +13,7 @@ public:
           btnW(612), btnH(74), btnRadius(20), btnBorder(4),
           hoveredMenu(-1), hoveredSignOut(false) 
     {
-        std::cout << "[ProfileScreen] Constructor called\n";
+        LOG_DEBUG("ProfileScreen", "Constructor called");
         signOutRect = SDL_Rect{0,0,0,0};
         signOutText.tex = nullptr;
         signOutText.w = 0;
@@ -1,10 +1,10 @@
 #include "TitleScreen.h"
 #include "../app/App.h"
 #include "../ui/UiTheme.h"
+#include "log.h"
 #include <SDL_ttf.h>
 #include <cmath>
 #include <algorithm>
-#include <iostream>
 
 static bool pointInRect(int x, int y, const SDL_Rect& r) {
     return (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h);
@@ -217,21 +217,21 @@ void TitleScreen::drawHoverButton(SDL_Renderer* r, const SDL_Rect& outer) {
 }
 
 void TitleScreen::onEnter() {
-    std::cout << "[TitleScreen] onEnter() called\n";
-    std::cout << "[TitleScreen] Loading textures...\n";
+    LOG_DEBUG("TitleScreen", "onEnter() called");
+    LOG_DEBUG("TitleScreen", "Loading textures");
     bg   = app->resources().texture(UiTheme::TitleBgPath);
     logo = app->resources().texture(UiTheme::TitleLogoPath);
-    std::cout << "[TitleScreen] Textures loaded\n";
+    LOG_DEBUG("TitleScreen", "Textures loaded");
 
     menuText.clear();
     menuRect.clear();
 
-    std::cout << "[TitleScreen] Creating menu text...\n";
+    LOG_DEBUG("TitleScreen", "Creating menu text");
     for (auto& s : labels) {
         menuText.push_back(makeText(s, 64));
         menuRect.push_back(SDL_Rect{0,0,0,0});
     }
-    std::cout << "[TitleScreen] Menu text created\n";
+    LOG_DEBUG("TitleScreen", "Menu text created");
     
     // Update sign text based on login state
     if (app->state().isUserAuthenticated()) {
@@ -260,7 +260,7 @@ void TitleScreen::onEnter() {
     
     // Check if we should auto-start training (from Try Again)
     if (app->state().shouldAutoStartTraining()) {
-        std::cout << "[TitleScreen] Auto-starting training...\n";
+        LOG_INFO("TitleScreen", "Auto-starting training");
         app->state().setAutoStartTraining(false);  // Reset flag
         app->network().send_start_training();
     }
@@ -296,7 +296,7 @@ void TitleScreen::handleEvent(const SDL_Event& e) {
             }
             // Training: send start_training và đợi game_init
             else if (hoveredMenu == 2) {
-                std::cout << "[TitleScreen] Training clicked - sending start_training\n";
+                LOG_INFO("TitleScreen", "Training clicked - sending start_training");
                 app->network().send_start_training();
                 // Server will send game_init with room_id="training"
                 // App will handle it and push GameScreen